@@ -1,9 +1,9 @@
 #include "aifr3d/analyzer.hpp"
+#include "aifr3d/io/wav_reader.hpp"
 
 #include <cmath>
 #include <cctype>
-#include <cstdint>
-#include <cstring>
+#include <cstddef>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
@@ -11,16 +11,9 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
-#include <vector>
 
 namespace {
 
-struct WavData {
-  double sampleRateHz{0.0};
-  std::size_t frameCount{0};
-  std::vector<float> interleavedStereo;
-};
-
 std::string readTextFile(const std::string& path) {
   std::ifstream in(path);
   if (!in) {
@@ -82,100 +75,6 @@ std::optional<std::string> findStringByKey(const std::string& text, const std::s
   return text.substr(pos, end - pos);
 }
 
-std::uint16_t readU16Le(const std::vector<std::uint8_t>& d, std::size_t off) {
-  return static_cast<std::uint16_t>(d[off] | (static_cast<std::uint16_t>(d[off + 1]) << 8));
-}
-
-std::uint32_t readU32Le(const std::vector<std::uint8_t>& d, std::size_t off) {
-  return static_cast<std::uint32_t>(d[off] | (static_cast<std::uint32_t>(d[off + 1]) << 8) |
-                                    (static_cast<std::uint32_t>(d[off + 2]) << 16) |
-                                    (static_cast<std::uint32_t>(d[off + 3]) << 24));
-}
-
-float decodePcm(const std::uint8_t* p, int bps) {
-  if (bps == 16) {
-    const std::int16_t v = static_cast<std::int16_t>(p[0] | (static_cast<std::int16_t>(p[1]) << 8));
-    return static_cast<float>(static_cast<double>(v) / 32768.0);
-  }
-  if (bps == 24) {
-    std::int32_t v = (static_cast<std::int32_t>(p[2]) << 24) | (static_cast<std::int32_t>(p[1]) << 16) |
-                     (static_cast<std::int32_t>(p[0]) << 8);
-    v >>= 8;
-    return static_cast<float>(static_cast<double>(v) / 8388608.0);
-  }
-  if (bps == 32) {
-    const std::int32_t v = static_cast<std::int32_t>(p[0] | (static_cast<std::int32_t>(p[1]) << 8) |
-                                                     (static_cast<std::int32_t>(p[2]) << 16) |
-                                                     (static_cast<std::int32_t>(p[3]) << 24));
-    return static_cast<float>(static_cast<double>(v) / 2147483648.0);
-  }
-  throw std::invalid_argument("Unsupported PCM depth in WAV");
-}
-
-WavData loadWavStereo(const std::string& path) {
-  std::ifstream in(path, std::ios::binary);
-  if (!in) {
-    throw std::invalid_argument("Cannot open wav: " + path);
-  }
-  std::vector<std::uint8_t> d((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
-  if (d.size() < 44 || std::string(reinterpret_cast<const char*>(d.data()), 4) != "RIFF" ||
-      std::string(reinterpret_cast<const char*>(d.data() + 8), 4) != "WAVE") {
-    throw std::invalid_argument("Invalid WAV file");
-  }
-
-  std::uint16_t format = 0;
-  std::uint16_t channels = 0;
-  std::uint32_t sampleRate = 0;
-  std::uint16_t bps = 0;
-  std::size_t dataOff = 0;
-  std::size_t dataSize = 0;
-
-  std::size_t off = 12;
-  while (off + 8 <= d.size()) {
-    const auto id = std::string(reinterpret_cast<const char*>(d.data() + off), 4);
-    const auto size = static_cast<std::size_t>(readU32Le(d, off + 4));
-    const auto chunkData = off + 8;
-    if (chunkData + size > d.size()) {
-      throw std::invalid_argument("Corrupt WAV chunk");
-    }
-    if (id == "fmt ") {
-      format = readU16Le(d, chunkData);
-      channels = readU16Le(d, chunkData + 2);
-      sampleRate = readU32Le(d, chunkData + 4);
-      bps = readU16Le(d, chunkData + 14);
-    } else if (id == "data") {
-      dataOff = chunkData;
-      dataSize = size;
-      break;
-    }
-    off = chunkData + size + (size % 2U);
-  }
-
-  if (format != 1 || channels == 0 || sampleRate == 0 || bps == 0 || dataOff == 0) {
-    throw std::invalid_argument("Unsupported WAV format for stub loader");
-  }
-
-  const int bytesPerSample = bps / 8;
-  const int bytesPerFrame = bytesPerSample * static_cast<int>(channels);
-  const std::size_t frameCount = dataSize / static_cast<std::size_t>(bytesPerFrame);
-
-  WavData out;
-  out.sampleRateHz = static_cast<double>(sampleRate);
-  out.frameCount = frameCount;
-  out.interleavedStereo.resize(frameCount * 2U, 0.0f);
-
-  for (std::size_t i = 0; i < frameCount; ++i) {
-    const std::size_t foff = dataOff + i * static_cast<std::size_t>(bytesPerFrame);
-    const float l = decodePcm(d.data() + foff, bps);
-    const std::size_t roff = foff + static_cast<std::size_t>(bytesPerSample * (channels > 1 ? 1 : 0));
-    const float r = decodePcm(d.data() + roff, bps);
-    out.interleavedStereo[i * 2U] = l;
-    out.interleavedStereo[i * 2U + 1U] = r;
-  }
-
-  return out;
-}
-
 int runSessionDashboard(const std::string& sessionDir) {
   const auto analysisText = readTextFile(sessionDir + "/analysis.json");
   const auto issuesText = readTextFile(sessionDir + "/issues.json");
@@ -222,9 +121,13 @@ int runSessionDashboard(const std::string& sessionDir) {
 }
 
 int runOfflineAnalysis(const std::string& wavPath) {
-  const auto wav = loadWavStereo(wavPath);
-  aifr3d::Analyzer analyzer;
-  const auto analysis = analyzer.analyzeInterleavedStereo(wav.interleavedStereo.data(), wav.frameCount, wav.sampleRateHz);
+  const aifr3d::io::WavReader wav(wavPath);
+  const aifr3d::Analyzer analyzer(0);  // offline analysis: use every hardware thread
+  const auto analysis = analyzer.analyzeBlocks(
+      [&](std::size_t first, std::size_t frames, float* left, float* right) {
+        wav.readStereo(first, frames, left, right);
+      },
+      wav.frameCount(), wav.sampleRateHz());
 
   std::cout << "=== DawAI Offline Analysis (Stub) ===\n";
   std::cout << "Frames: " << analysis.frame_count << "\n";
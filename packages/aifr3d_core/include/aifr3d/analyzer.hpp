@@ -1,11 +1,17 @@
 #pragma once
 
 #include <cstddef>
+#include <functional>
+#include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 namespace aifr3d {
 
+class ThreadPool;
+class AnalyzerWorkspace;
+
 struct BasicMetrics {
   std::optional<double> peak_dbfs;
   std::optional<double> rms_dbfs;
@@ -14,8 +20,13 @@ struct BasicMetrics {
 
 struct LoudnessMetrics {
   std::optional<double> integrated_lufs;
+  // Maximum of the 3 s short-term windows.
   std::optional<double> short_term_lufs;
   std::optional<double> loudness_range_lu;
+  // Maximum of the 400 ms momentary windows.
+  std::optional<double> momentary_max_lufs;
+  // Every complete 3 s window at a 100 ms hop, in stream order.
+  std::vector<std::optional<double>> short_term_series_lufs;
 };
 
 struct TruePeakMetrics {
@@ -33,10 +44,46 @@ struct SpectralBands {
   std::optional<double> air;
 };
 
+// Broad bands of each channel and of mid (L + R) / 2 and side (L - R) / 2,
+// on the same energy scale as SpectralBands of the mono sum.
+struct ChannelSpectra {
+  SpectralBands left;
+  SpectralBands right;
+  SpectralBands mid;
+  SpectralBands side;
+};
+
+// Band layouts the spectral stage can report.
+enum class BandLayout {
+  // sub, low, lowmid, mid, highmid, high, air: the SpectralBands fields.
+  kBroad7,
+  // ISO 266 base-2 fractional-octave bands around 1 kHz, 20 Hz to 20 kHz
+  // (31 and 61 bands).
+  kThirdOctave,
+  kSixthOctave,
+  // Zwicker's 24 critical bands up to 15.5 kHz.
+  kBark,
+  // One ERB-number wide (Glasberg & Moore), 41 bands from 20 Hz up to 20 kHz.
+  kErb,
+};
+
+// Mean STFT energy per band of one layout; bands ascend in frequency.
+struct BandSpectrum {
+  BandLayout layout{BandLayout::kBroad7};
+  std::vector<double> lower_hz;
+  std::vector<double> upper_hz;
+  std::vector<std::optional<double>> energy_db;
+};
+
 struct StereoMetrics {
   std::optional<double> correlation;
   std::optional<double> lr_balance_db;
   std::optional<double> width_proxy;
+  // Per broad band, from the cross-spectrum of the channel STFT: correlation
+  // Re(sum L R*) / sqrt(sum |L|^2 sum |R|^2) and width rms_side / (rms_mid +
+  // rms_side). Needs the spectral group with spectral_channels.
+  SpectralBands band_correlation;
+  SpectralBands band_width;
 };
 
 struct DynamicsMetrics {
@@ -44,6 +91,52 @@ struct DynamicsMetrics {
   std::optional<double> rms_dbfs;
   std::optional<double> crest_db;
   std::optional<double> dr_proxy_db;
+  // DR14-style dynamic range: per channel, the second-highest 3 s block peak
+  // over the RMS of the loudest 20% of blocks; the mean of both channels.
+  std::optional<double> dr_db;
+  // True peak minus integrated loudness; the sample peak is used instead when
+  // the true_peak group is off. Needs the loudness group.
+  std::optional<double> plr_db;
+  // Sample peak (not true peak) of each short-term window minus its loudness,
+  // aligned with LoudnessMetrics::short_term_series_lufs. Needs the loudness
+  // group.
+  std::vector<std::optional<double>> psr_series_db;
+};
+
+// Metric groups an analysis computes. Groups left off are not run at all and
+// their AnalysisResult fields stay nullopt.
+struct MetricGroups {
+  bool basic{true};
+  bool loudness{true};
+  bool true_peak{true};
+  bool spectral{true};
+  bool stereo{true};
+  bool dynamics{true};
+};
+
+struct AnalysisOptions {
+  MetricGroups groups;
+  // 1 (sample peak only), 2, 4 or 8.
+  int true_peak_oversample_factor{4};
+  // Skip oversampling blocks whose sample peak proves they cannot raise the
+  // true peak. Results are identical either way.
+  bool true_peak_pruning{true};
+  // Validation mode: dynamics percentiles from every stored |sample| via
+  // nth_element instead of the histogram. Memory grows with the input.
+  bool dynamics_exact_percentiles{false};
+  // Power of two in [256, 16384]; the STFT hop is half of it. Band energies
+  // are unnormalized, so they are only comparable at the same size.
+  std::size_t fft_size{1024};
+  // Extra band layouts computed from the same STFT frames, reported in
+  // AnalysisResult::band_spectra in this order.
+  std::vector<BandLayout> spectral_band_layouts;
+  // Read bands up to 500 Hz from a decimated copy of the signal analyzed with
+  // a long FFT (about 1.5 Hz bins) instead of the fft_size STFT.
+  bool spectral_low_path{false};
+  // Also report L/R/M/S broad bands in AnalysisResult::channel_spectra. Both
+  // channels share one complex FFT per frame, which then also supplies the
+  // mono bands (equal to the default path up to rounding).
+  bool spectral_channels{false};
 };
 
 struct AnalysisResult {
@@ -52,19 +145,117 @@ struct AnalysisResult {
   std::size_t frame_count{0};
   double sample_rate_hz{0.0};
   std::string generated_at_utc;
+  MetricGroups computed_groups;
   BasicMetrics basic;
   LoudnessMetrics loudness;
   TruePeakMetrics true_peak;
   SpectralBands spectral;
+  // One entry per AnalysisOptions::spectral_band_layouts.
+  std::vector<BandSpectrum> band_spectra;
+  // Set when AnalysisOptions::spectral_channels is on. Always from the
+  // fft_size STFT, even with the low path enabled.
+  std::optional<ChannelSpectra> channel_spectra;
   StereoMetrics stereo;
   DynamicsMetrics dynamics;
 };
 
+// Scratch reused across Analyzer calls: the per-chunk accumulators with their
+// STFT buffers and histograms. Once a workspace has seen an input of a given
+// chunk count and length, later analyses through it allocate nothing beyond
+// the returned AnalysisResult. A longer input grows the per-hop dynamics
+// levels and short-term series (about 40 bytes per 100 ms). Not thread-safe;
+// keep one per worker thread.
+class AnalyzerWorkspace {
+ public:
+  AnalyzerWorkspace();
+  ~AnalyzerWorkspace();
+  AnalyzerWorkspace(AnalyzerWorkspace&&) noexcept;
+  AnalyzerWorkspace& operator=(AnalyzerWorkspace&&) noexcept;
+  AnalyzerWorkspace(const AnalyzerWorkspace&) = delete;
+  AnalyzerWorkspace& operator=(const AnalyzerWorkspace&) = delete;
+
+ private:
+  friend class Analyzer;
+  struct Storage;
+  std::unique_ptr<Storage> storage_;
+};
+
+// One-shot analysis of an in-memory buffer. The frame range is split into
+// chunks whose layout depends only on frame_count; chunk partials are merged
+// in chunk order, so results are bit-identical for any thread_count.
 class Analyzer {
  public:
+  Analyzer();
+  // thread_count 0 uses std::thread::hardware_concurrency().
+  explicit Analyzer(std::size_t thread_count);
+  // Throws std::invalid_argument for out-of-range options.
+  explicit Analyzer(const AnalysisOptions& options, std::size_t thread_count = 1);
+
   AnalysisResult analyzeInterleavedStereo(const float* interleaved_stereo,
                                           std::size_t frame_count,
                                           double sample_rate_hz) const;
+  AnalysisResult analyzeInterleavedStereo(const float* interleaved_stereo,
+                                          std::size_t frame_count,
+                                          double sample_rate_hz,
+                                          AnalyzerWorkspace& workspace) const;
+
+  // Reads separate channel buffers (e.g. a JUCE AudioBuffer) without an
+  // interleaving copy. Results are identical to analyzeInterleavedStereo.
+  AnalysisResult analyzePlanarStereo(const float* left,
+                                     const float* right,
+                                     std::size_t frame_count,
+                                     double sample_rate_hz) const;
+  AnalysisResult analyzePlanarStereo(const float* left,
+                                     const float* right,
+                                     std::size_t frame_count,
+                                     double sample_rate_hz,
+                                     AnalyzerWorkspace& workspace) const;
+
+  // Writes frames [first_frame, first_frame + frames) as planar left/right,
+  // frames <= kAnalysisBlockFrames. Called from pool threads for disjoint and
+  // overlapping ranges at once, so it must be safe to call concurrently.
+  using PlanarBlockReader =
+      std::function<void(std::size_t first_frame, std::size_t frames, float* left, float* right)>;
+
+  // Pulls the input block by block from `read` (e.g. a decoder over a
+  // memory-mapped file) instead of a caller-owned buffer, so memory is a few
+  // blocks per thread however long the input. Results are identical to
+  // analyzePlanarStereo over the same samples.
+  AnalysisResult analyzeBlocks(const PlanarBlockReader& read,
+                               std::size_t frame_count,
+                               double sample_rate_hz) const;
+  AnalysisResult analyzeBlocks(const PlanarBlockReader& read,
+                               std::size_t frame_count,
+                               double sample_rate_hz,
+                               AnalyzerWorkspace& workspace) const;
+
+ private:
+  AnalysisOptions options_;
+  std::shared_ptr<ThreadPool> pool_;
+};
+
+// Push-based analyzer for material that does not fit in memory. No samples
+// are kept; the only state that grows with stream length is about 40 bytes
+// per 100 ms hop (dynamics hop levels and the short-term loudness series),
+// roughly 1.4 MB per hour. Call reset() before the first push() and again
+// after finalize() to start a new stream.
+class StreamingAnalyzer {
+ public:
+  StreamingAnalyzer();
+  ~StreamingAnalyzer();
+  StreamingAnalyzer(StreamingAnalyzer&&) noexcept;
+  StreamingAnalyzer& operator=(StreamingAnalyzer&&) noexcept;
+  StreamingAnalyzer(const StreamingAnalyzer&) = delete;
+  StreamingAnalyzer& operator=(const StreamingAnalyzer&) = delete;
+
+  void reset(double sample_rate_hz, const AnalysisOptions& options = {});
+  void push(const float* interleaved_stereo, std::size_t frame_count);
+  void pushPlanar(const float* left, const float* right, std::size_t frame_count);
+  AnalysisResult finalize();
+
+ private:
+  struct State;
+  std::unique_ptr<State> state_;
 };
 
 }  // namespace aifr3d
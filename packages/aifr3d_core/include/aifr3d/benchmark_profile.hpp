@@ -38,6 +38,9 @@ struct BenchmarkStereoTargets {
   std::optional<BenchmarkMetricTarget> correlation;
   std::optional<BenchmarkMetricTarget> lr_balance_db;
   std::optional<BenchmarkMetricTarget> width_proxy;
+  // Per broad band; JSON keys correlation_<band> and width_<band>.
+  BenchmarkSpectralTargets band_correlation;
+  BenchmarkSpectralTargets band_width;
 };
 
 struct BenchmarkDynamicsTargets {
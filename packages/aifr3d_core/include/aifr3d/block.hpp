@@ -0,0 +1,42 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+namespace aifr3d {
+
+// Frames per fused analysis block. Two planar float blocks (16 KiB) stay cache
+// resident while every metric accumulator consumes them.
+inline constexpr std::size_t kAnalysisBlockFrames = 2048;
+
+void deinterleave_stereo(const float* interleaved_stereo,
+                         std::size_t frame_count,
+                         float* left,
+                         float* right);
+
+// Reads the interleaved buffer exactly once, handing each block to `fn` as
+// planar (left, right, frames).
+template <typename BlockFn>
+void for_each_planar_block(const float* interleaved_stereo, std::size_t frame_count, BlockFn&& fn) {
+  std::array<float, kAnalysisBlockFrames> left{};
+  std::array<float, kAnalysisBlockFrames> right{};
+  for (std::size_t start = 0; start < frame_count; start += kAnalysisBlockFrames) {
+    const std::size_t n = std::min(kAnalysisBlockFrames, frame_count - start);
+    deinterleave_stereo(interleaved_stereo + start * 2U, n, left.data(), right.data());
+    fn(static_cast<const float*>(left.data()), static_cast<const float*>(right.data()), n);
+  }
+}
+
+// Planar input needs no copy: `fn` receives kAnalysisBlockFrames slices of the
+// caller's channels so the accumulators see the same block boundaries as the
+// interleaved path.
+template <typename BlockFn>
+void for_each_planar_block(const float* left, const float* right, std::size_t frame_count, BlockFn&& fn) {
+  for (std::size_t start = 0; start < frame_count; start += kAnalysisBlockFrames) {
+    const std::size_t n = std::min(kAnalysisBlockFrames, frame_count - start);
+    fn(left + start, right + start, n);
+  }
+}
+
+}  // namespace aifr3d
@@ -49,6 +49,11 @@ struct CompareStereo {
   MetricDelta correlation;
   MetricDelta lr_balance_db;
   MetricDelta width_proxy;
+  // Tallied only for bands the profile has a target for, and scored only when
+  // also measured, so profiles without per-band targets summarize and score
+  // as before.
+  CompareSpectral band_correlation;
+  CompareSpectral band_width;
 };
 
 struct CompareDynamics {
@@ -68,6 +73,9 @@ struct BenchmarkCompareSummary {
 struct BenchmarkCompareResult {
   std::string profile_id;
   std::string genre;
+  // Copied from AnalysisResult::computed_groups. Metrics of skipped groups
+  // are UNKNOWN but excluded from the summary counts and from scoring.
+  MetricGroups compared_groups;
   CompareBasic basic;
   CompareLoudness loudness;
   CompareSpectral spectral;
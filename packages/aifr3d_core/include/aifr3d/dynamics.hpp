@@ -2,11 +2,106 @@
 
 #include "aifr3d/analyzer.hpp"
 
+#include <array>
 #include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
 
 namespace aifr3d {
 
+// Fixed-resolution log-magnitude histogram of absolute sample values. Bins are
+// 1/600 octave (~0.01 dB) wide over [2^-34, 2^7) (about -205..+42 dBFS);
+// exact zeros are counted separately. Memory does not depend on sample count.
+class AmplitudeHistogram {
+ public:
+  static constexpr int kBinsPerOctave = 600;
+  static constexpr int kMinOctave = -34;
+  static constexpr int kMaxOctave = 7;
+  static constexpr std::size_t kBinCount =
+      static_cast<std::size_t>(kMaxOctave - kMinOctave) * static_cast<std::size_t>(kBinsPerOctave);
+
+  void clear();
+  void add(float abs_sample);
+  void merge(const AmplitudeHistogram& other);
+  std::uint64_t count() const { return total_; }
+
+  // dBFS value of the element at 0-based `rank` in ascending order, i.e. the
+  // same index a sorted array would use. nullopt when that element is zero.
+  std::optional<double> valueDbAtRank(std::uint64_t rank) const;
+
+ private:
+  std::vector<std::uint64_t> bins_;
+  std::uint64_t zero_count_{0};
+  std::uint64_t total_{0};
+};
+
+// Per-channel energy and peak of one 100 ms hop, on the hop grid of
+// LoudnessAccumulator.
+struct HopLevels {
+  std::array<double, 2> sum_sq{};
+  std::array<float, 2> peak{};
+  std::size_t frames{0};
+};
+
+// Incremental form of compute_dynamics_interleaved_stereo fed with planar
+// blocks. Peak/RMS follow interleaved sample order so sums match exactly.
+// Needs no history: startAt and prime only position the hop grid.
+// With track_distribution off only peak/RMS/crest are produced and neither
+// the histogram nor the hop levels are touched.
+// exact_percentiles keeps every |sample| instead and selects the percentiles
+// with nth_element, as a reference for the histogram; partials merge by
+// concatenation.
+//
+// The DR blocks (kDrBlockHops hops) and the PSR windows are assembled in
+// finalize from per-hop levels, so no samples are kept, but hops_ grows by one
+// HopLevels (32 bytes) per 100 ms of input. merge() combines the hop
+// straddling a chunk boundary and appends the rest.
+class DynamicsAccumulator {
+ public:
+  static constexpr std::size_t kContextFrames = 0;
+  static constexpr std::size_t kDrBlockHops = 30;
+  static constexpr double kDrLoudestFraction = 0.2;
+
+  void reset(double sample_rate_hz, bool track_distribution = true, bool exact_percentiles = false);
+  void startAt(std::size_t first_frame) { position_ = first_frame; }
+  void prime(const float* left, const float* right, std::size_t frames);
+  void push(const float* left, const float* right, std::size_t frames);
+  void merge(const DynamicsAccumulator& later);
+  DynamicsMetrics finalize();
+
+  // Fills psr_series_db and plr_db of `metrics` from the loudness of the same
+  // stream, both from the sample peak; Analyzer replaces plr_db with the true
+  // peak when it has one. Both accumulators must have seen the whole stream.
+  void addLoudnessRatios(DynamicsMetrics& metrics, const LoudnessMetrics& loudness) const;
+
+ private:
+  void accumulateHop(HopLevels& hop, const float* left, const float* right, std::size_t frames);
+
+  bool track_distribution_{true};
+  bool exact_percentiles_{false};
+  std::uint64_t samples_{0};
+  double peak_{0.0};
+  double sum_sq_{0.0};
+  AmplitudeHistogram histogram_;
+  std::vector<float> abs_samples_;
+
+  std::size_t hop_frames_{1};
+  std::size_t position_{0};
+  // hops_[i] is absolute hop first_hop_ + i.
+  std::size_t first_hop_{0};
+  std::vector<HopLevels> hops_;
+  // Per-block values in finalize, kept so a reused accumulator allocates nothing.
+  std::vector<double> block_scratch_;
+};
+
 DynamicsMetrics compute_dynamics_interleaved_stereo(const float* interleaved_stereo,
-                                                    std::size_t frame_count);
+                                                    std::size_t frame_count,
+                                                    double sample_rate_hz);
+
+DynamicsMetrics compute_dynamics_planar_stereo(const float* left,
+                                               const float* right,
+                                               std::size_t frame_count,
+                                               double sample_rate_hz);
 
 }  // namespace aifr3d
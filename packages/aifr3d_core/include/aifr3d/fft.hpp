@@ -2,6 +2,9 @@
 
 #include <complex>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
 #include <vector>
 
 namespace aifr3d {
@@ -11,4 +14,46 @@ using Complex = std::complex<double>;
 std::size_t next_power_of_two(std::size_t v);
 void fft_inplace(std::vector<Complex>& data);
 
+// Radix-2 decimation-in-time FFT of a fixed power-of-two size. Twiddles are
+// evaluated directly per index (never by repeated multiplication) and rounded
+// once to T; the bit-reversal permutation is stored as a swap list. A plan is
+// immutable after construction, so one instance may serve any number of
+// threads; forSize() hands out a process-wide instance per size.
+template <typename T>
+class FftPlan {
+ public:
+  using ComplexT = std::complex<T>;
+
+  // Throws std::invalid_argument unless size is a power of two >= 2.
+  explicit FftPlan(std::size_t size);
+
+  // Cached plan for `size`, built on first use and kept for the life of the
+  // process. Thread-safe.
+  static std::shared_ptr<const FftPlan> forSize(std::size_t size);
+
+  std::size_t size() const { return size_; }
+
+  // Forward, unscaled, in place over size() points.
+  void forward(ComplexT* data) const;
+
+  // Forward transform of size() real samples as a size() / 2 point complex
+  // FFT plus a split pass. Writes bins 0 .. size() / 2 (size() / 2 + 1
+  // values) to `out`, which also serves as the work buffer.
+  void forwardReal(const T* in, ComplexT* out) const;
+
+ private:
+  using SwapList = std::vector<std::pair<std::uint32_t, std::uint32_t>>;
+
+  void transform(ComplexT* data, std::size_t n, const SwapList& swaps) const;
+
+  std::size_t size_;
+  // twiddles_[k] = exp(-2 pi i k / size_) for k < size_ / 2.
+  std::vector<ComplexT> twiddles_;
+  SwapList swaps_;
+  SwapList half_swaps_;
+};
+
+extern template class FftPlan<float>;
+extern template class FftPlan<double>;
+
 }  // namespace aifr3d
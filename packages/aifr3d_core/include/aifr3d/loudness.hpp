@@ -2,12 +2,147 @@
 
 #include "aifr3d/analyzer.hpp"
 
+#include <array>
 #include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
 
 namespace aifr3d {
 
+// Transposed direct form II biquad, a0 normalized to 1.
+struct BiquadCoefficients {
+  double b0{1.0};
+  double b1{0.0};
+  double b2{0.0};
+  double a1{0.0};
+  double a2{0.0};
+};
+
+// ITU-R BS.1770-4 K-weighting: the high-shelf pre-filter followed by the RLB
+// high-pass, derived from their analog prototypes by the bilinear transform so
+// any sample rate matches the published 48 kHz coefficients in response.
+std::array<BiquadCoefficients, 2> k_weighting_coefficients(double sample_rate_hz);
+
+// Histogram of gating-block loudness in 0.01 LU bins from the absolute gate
+// (-70 LUFS) up, keeping per-bin block counts and energy sums. Blocks at or
+// below the absolute gate are dropped. The relative gate then needs no second
+// pass over the blocks: only the bin holding the threshold is ambiguous, and
+// blocks in it are classified by the bin centre. Percentiles resolve to bin
+// centres without sorting. Partials merge by adding bins.
+class LoudnessHistogram {
+ public:
+  static constexpr double kAbsoluteGateLufs = -70.0;
+  static constexpr int kBinsPerLu = 100;
+  // Blocks louder than +10 LUFS share the top bin; their energy is still exact.
+  static constexpr std::size_t kBinCount = 80U * static_cast<std::size_t>(kBinsPerLu);
+
+  void clear();
+  // Adds one block given its channel-summed K-weighted mean square.
+  void add(double mean_square);
+  void merge(const LoudnessHistogram& other);
+  // Power mean of the blocks above the absolute gate and above
+  // (their own power mean - relative_gate_lu), in LUFS.
+  std::optional<double> gatedLufs(double relative_gate_lu) const;
+  // Spread between two quantiles of the blocks passing both gates (EBU Tech
+  // 3342 loudness range with 0.10 / 0.95), in LU.
+  std::optional<double> gatedRangeLu(double relative_gate_lu, double low_quantile, double high_quantile) const;
+
+ private:
+  std::size_t firstBinAboveRelativeGate(double relative_gate_lu) const;
+
+  std::vector<std::uint64_t> counts_;
+  std::vector<double> energy_;
+  std::uint64_t total_{0};
+  double total_energy_{0.0};
+};
+
+// Incremental form of compute_loudness_interleaved_stereo fed with planar
+// blocks. Produces bit-identical results to the one-shot function.
+//
+// Both channels are K-weighted together (one biquad cascade, a lane per
+// channel) and their squares summed per 100 ms hop into a ring of the last
+// kShortTermHops hop energies; momentary (4 hops) and short-term (30 hops)
+// window sums are updated in O(1) per hop and re-summed exactly whenever the
+// absolute hop index wraps, so rounding drift cannot build up.
+//
+// Every momentary window is a BS.1770 gating block and lands in a
+// LoudnessHistogram, from which finalize() derives the gated integrated
+// loudness; short-term windows land in a second one for the loudness range.
+//
+// For chunked analysis a partial is positioned with startAt(), warmed with
+// prime() on the frames preceding its chunk (history only, nothing counted;
+// long enough for the filters to settle)
+// and folded into the partial of the immediately preceding chunk with
+// merge(). A hop is owned by the chunk holding its last frame; windows that
+// reach back across a chunk boundary are completed by merge() from the
+// earlier partial's ring and the later partial's leading hops. A merged
+// accumulator is only meant to be finalized or to absorb the next chunk.
+class LoudnessAccumulator {
+ public:
+  static constexpr std::size_t kMomentaryHops = 4;
+  static constexpr std::size_t kShortTermHops = 30;
+
+  // Frames in one 100 ms hop.
+  static std::size_t hopFramesFor(double sample_rate_hz);
+  // History a chunk needs: K-weighting settle time plus the hop straddling its
+  // first frame.
+  static std::size_t contextFramesFor(double sample_rate_hz);
+
+  void reset(double sample_rate_hz);
+  void startAt(std::size_t first_frame);
+  void prime(const float* left, const float* right, std::size_t frames);
+  void push(const float* left, const float* right, std::size_t frames);
+  void merge(const LoudnessAccumulator& later);
+  LoudnessMetrics finalize();
+
+ private:
+  void consume(const float* left, const float* right, std::size_t frames, bool owned);
+  void closeHop(bool owned);
+  void emitMomentary(double window_energy);
+  void emitShortTerm(double window_energy);
+  double ringSum(std::size_t last_hop, std::size_t hops) const;
+
+  double sample_rate_hz_{0.0};
+  std::size_t hop_frames_{1};
+  std::size_t position_{0};
+  std::size_t owned_frames_{0};
+  // K-weighted energy per channel, so summation order never depends on where
+  // blocks are split.
+  std::array<double, 2> sum_sq_{};
+
+  std::array<BiquadCoefficients, 2> k_filter_{};
+  // Transposed direct form II state {s1, s2} per stage, interleaved left/right.
+  std::array<double, 8> k_state_{};
+
+  std::array<double, 2> hop_energy_{};
+  bool hop_valid_{false};
+
+  // Owned hop energies, slot = absolute hop index % kShortTermHops. Slots of
+  // hops this partial never owned stay zero.
+  std::array<double, kShortTermHops> ring_{};
+  // The first owned hops, kept for stitching windows at merge().
+  std::array<double, kShortTermHops - 1U> head_{};
+  std::size_t first_hop_{0};
+  std::size_t hop_count_{0};
+  double momentary_sum_{0.0};
+  double short_term_sum_{0.0};
+
+  double max_momentary_energy_{0.0};
+  double max_short_term_energy_{0.0};
+  std::size_t momentary_windows_{0};
+  LoudnessHistogram gating_;
+  LoudnessHistogram short_term_gating_;
+  std::vector<double> short_term_series_;
+};
+
 LoudnessMetrics compute_loudness_interleaved_stereo(const float* interleaved_stereo,
                                                     std::size_t frame_count,
                                                     double sample_rate_hz);
 
+LoudnessMetrics compute_loudness_planar_stereo(const float* left,
+                                               const float* right,
+                                               std::size_t frame_count,
+                                               double sample_rate_hz);
+
 }  // namespace aifr3d
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace aifr3d {
+
+// Cascade of 2:1 decimators, each a linear-phase half-band FIR (Kaiser-windowed
+// sinc at a quarter of its input rate; flat to about 0.19 fs_in, > 80 dB down
+// beyond 0.31 fs_in). Every other tap but the centre is zero, so a stage costs
+// kTaps / 4 + 1 multiplies per output.
+//
+// Decimation runs on an absolute sample grid: stage k keeps the outputs whose
+// stage input index is even, so the decimated stream depends only on absolute
+// positions. After startAt(first_frame) and historyFramesFor(stages) frames of
+// input, outputs match a cascade that started at frame 0.
+class HalfBandCascade {
+ public:
+  static constexpr std::size_t kTaps = 47;
+  static constexpr int kMaxStages = 6;
+  // Nonzero taps on each side of the centre.
+  static constexpr std::size_t kSideTaps = (kTaps / 2U + 1U) / 2U;
+
+  // Input frames before the first output that is independent of the zero
+  // initial state.
+  static constexpr std::size_t historyFramesFor(int stages) {
+    return (kTaps - 1U) * ((std::size_t{1} << static_cast<unsigned>(stages)) - 1U);
+  }
+
+  // Throws std::invalid_argument unless 1 <= stages <= kMaxStages.
+  void reset(int stages);
+  void startAt(std::size_t first_frame);
+  int stages() const { return stages_; }
+
+  // Decimates `count` input samples in place: the outputs of the last stage
+  // overwrite the front of `samples` and their count is returned.
+  // `first_index` receives the absolute decimated index of the first output.
+  std::size_t process(double* samples, std::size_t count, std::size_t& first_index);
+
+ private:
+  static constexpr std::size_t kChunk = 1024;
+
+  struct Stage {
+    // The last kTaps - 1 inputs, followed by the chunk being filtered.
+    std::array<double, kTaps - 1U + kChunk> window{};
+    std::size_t next_index{0};
+  };
+
+  int stages_{1};
+  std::array<double, kSideTaps> side_{};
+  std::array<Stage, kMaxStages> stage_{};
+};
+
+}  // namespace aifr3d
@@ -0,0 +1,150 @@
+#pragma once
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AIFR3D_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define AIFR3D_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace aifr3d::simd {
+
+// Two double lanes. The analysis kernels keep left in the low lane and right in
+// the high lane so both channels run through one recursive filter in lockstep.
+// Falls back to scalar code on targets without SSE2/NEON.
+struct Double2 {
+#if defined(AIFR3D_SIMD_SSE2)
+  __m128d v;
+
+  static Double2 set(double lo, double hi) { return {_mm_set_pd(hi, lo)}; }
+  static Double2 load(const double* p) { return {_mm_loadu_pd(p)}; }
+  static Double2 broadcast(double x) { return {_mm_set1_pd(x)}; }
+  double lo() const { return _mm_cvtsd_f64(v); }
+  double hi() const { return _mm_cvtsd_f64(_mm_unpackhi_pd(v, v)); }
+#elif defined(AIFR3D_SIMD_NEON)
+  float64x2_t v;
+
+  static Double2 set(double lo, double hi) { return {vsetq_lane_f64(hi, vdupq_n_f64(lo), 1)}; }
+  static Double2 load(const double* p) { return {vld1q_f64(p)}; }
+  static Double2 broadcast(double x) { return {vdupq_n_f64(x)}; }
+  double lo() const { return vgetq_lane_f64(v, 0); }
+  double hi() const { return vgetq_lane_f64(v, 1); }
+#else
+  double v0;
+  double v1;
+
+  static Double2 set(double lo, double hi) { return {lo, hi}; }
+  static Double2 load(const double* p) { return {p[0], p[1]}; }
+  static Double2 broadcast(double x) { return {x, x}; }
+  double lo() const { return v0; }
+  double hi() const { return v1; }
+#endif
+
+  static Double2 zero() { return broadcast(0.0); }
+  double sum() const { return lo() + hi(); }
+};
+
+#if defined(AIFR3D_SIMD_SSE2)
+inline Double2 operator+(Double2 a, Double2 b) { return {_mm_add_pd(a.v, b.v)}; }
+inline Double2 operator-(Double2 a, Double2 b) { return {_mm_sub_pd(a.v, b.v)}; }
+inline Double2 operator*(Double2 a, Double2 b) { return {_mm_mul_pd(a.v, b.v)}; }
+#elif defined(AIFR3D_SIMD_NEON)
+inline Double2 operator+(Double2 a, Double2 b) { return {vaddq_f64(a.v, b.v)}; }
+inline Double2 operator-(Double2 a, Double2 b) { return {vsubq_f64(a.v, b.v)}; }
+inline Double2 operator*(Double2 a, Double2 b) { return {vmulq_f64(a.v, b.v)}; }
+#else
+inline Double2 operator+(Double2 a, Double2 b) { return {a.v0 + b.v0, a.v1 + b.v1}; }
+inline Double2 operator-(Double2 a, Double2 b) { return {a.v0 - b.v0, a.v1 - b.v1}; }
+inline Double2 operator*(Double2 a, Double2 b) { return {a.v0 * b.v0, a.v1 * b.v1}; }
+#endif
+
+// Four float lanes for FIR inner products over consecutive planar samples.
+struct Float4 {
+#if defined(AIFR3D_SIMD_SSE2)
+  __m128 v;
+
+  static Float4 load(const float* p) { return {_mm_loadu_ps(p)}; }
+  static Float4 broadcast(float x) { return {_mm_set1_ps(x)}; }
+  Float4 abs() const { return {_mm_andnot_ps(_mm_set1_ps(-0.0f), v)}; }
+  float maxLane() const {
+    const __m128 pairs = _mm_max_ps(v, _mm_movehl_ps(v, v));
+    return _mm_cvtss_f32(_mm_max_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+  }
+#elif defined(AIFR3D_SIMD_NEON)
+  float32x4_t v;
+
+  static Float4 load(const float* p) { return {vld1q_f32(p)}; }
+  static Float4 broadcast(float x) { return {vdupq_n_f32(x)}; }
+  Float4 abs() const { return {vabsq_f32(v)}; }
+  float maxLane() const { return vmaxvq_f32(v); }
+#else
+  float v[4];
+
+  static Float4 load(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+  static Float4 broadcast(float x) { return {{x, x, x, x}}; }
+  Float4 abs() const { return {{v[0] < 0.0f ? -v[0] : v[0], v[1] < 0.0f ? -v[1] : v[1],
+                                v[2] < 0.0f ? -v[2] : v[2], v[3] < 0.0f ? -v[3] : v[3]}}; }
+  float maxLane() const {
+    const float a = v[0] > v[1] ? v[0] : v[1];
+    const float b = v[2] > v[3] ? v[2] : v[3];
+    return a > b ? a : b;
+  }
+#endif
+
+  static Float4 zero() { return broadcast(0.0f); }
+};
+
+#if defined(AIFR3D_SIMD_SSE2)
+inline Float4 operator+(Float4 a, Float4 b) { return {_mm_add_ps(a.v, b.v)}; }
+inline Float4 operator*(Float4 a, Float4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+inline Float4 max(Float4 a, Float4 b) { return {_mm_max_ps(a.v, b.v)}; }
+#elif defined(AIFR3D_SIMD_NEON)
+inline Float4 operator+(Float4 a, Float4 b) { return {vaddq_f32(a.v, b.v)}; }
+inline Float4 operator*(Float4 a, Float4 b) { return {vmulq_f32(a.v, b.v)}; }
+inline Float4 max(Float4 a, Float4 b) { return {vmaxq_f32(a.v, b.v)}; }
+#else
+inline Float4 operator+(Float4 a, Float4 b) {
+  return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}};
+}
+inline Float4 operator*(Float4 a, Float4 b) {
+  return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}};
+}
+inline Float4 max(Float4 a, Float4 b) {
+  return {{a.v[0] > b.v[0] ? a.v[0] : b.v[0], a.v[1] > b.v[1] ? a.v[1] : b.v[1],
+           a.v[2] > b.v[2] ? a.v[2] : b.v[2], a.v[3] > b.v[3] ? a.v[3] : b.v[3]}};
+}
+#endif
+
+// Cache-line aligned storage for scratch written on every frame. Buffers
+// owned by accumulators on different worker threads never share a line, and
+// vector loads never split one.
+inline constexpr std::size_t kCacheLineBytes = 64;
+
+template <typename T>
+struct AlignedAllocator {
+  using value_type = T;
+
+  AlignedAllocator() = default;
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U>&) noexcept {}
+
+  T* allocate(std::size_t n) {
+    return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{kCacheLineBytes}));
+  }
+  void deallocate(T* p, std::size_t) noexcept { ::operator delete(p, std::align_val_t{kCacheLineBytes}); }
+
+  template <typename U>
+  bool operator==(const AlignedAllocator<U>&) const noexcept {
+    return true;
+  }
+};
+
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+}  // namespace aifr3d::simd
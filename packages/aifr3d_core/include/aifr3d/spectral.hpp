@@ -1,13 +1,169 @@
 #pragma once
 
 #include "aifr3d/analyzer.hpp"
+#include "aifr3d/fft.hpp"
+#include "aifr3d/multirate.hpp"
+#include "aifr3d/simd.hpp"
+#include "aifr3d/spectral_plan.hpp"
 
+#include <array>
 #include <cstddef>
+#include <memory>
+#include <optional>
+#include <vector>
 
 namespace aifr3d {
 
+class ThreadPool;
+
+// Incremental STFT band accumulator fed with planar blocks. Keeps the last
+// fft_size mono samples so frames spanning block boundaries are preserved.
+// Window, FFT and band weights come from shared SpectralPlans: the kBroad7
+// plan behind SpectralBands plus one per extra layout, all applied to the
+// power spectrum of the same frame.
+// The hop is half the FFT size and STFT frames start on absolute multiples of
+// it; startAt/prime/merge follow the chunking contract of LoudnessAccumulator.
+//
+// With the low path on, a copy of the mono signal is decimated by a
+// HalfBandCascade to at least kLowPathMinRateHz and analyzed with a
+// kLowFftSize STFT. Bands ending at or below kLowPathCrossoverHz are then read
+// from it, rescaled to the full-rate energy scale, for much finer bins at a
+// small fraction of the cost of one long full-rate FFT.
+//
+// With channels on, each full-rate frame packs the windowed left channel into
+// the real part and the right into the imaginary part of one complex FFT.
+// Conjugate symmetry separates the two spectra, and mid/side follow linearly,
+// so four spectra (and the mono bands, from mid) cost one N-point transform.
+class SpectralAccumulator {
+ public:
+  static constexpr std::size_t kDefaultFftSize = 1024;
+  static constexpr std::size_t kMinFftSize = 256;
+  static constexpr std::size_t kMaxFftSize = 16384;
+  static constexpr std::size_t kContextFrames = kMaxFftSize - 1U;
+  static constexpr std::size_t kLowFftSize = 4096;
+  static constexpr double kLowPathMinRateHz = 4000.0;
+  static constexpr double kLowPathCrossoverHz = 500.0;
+
+  // fft_size must be a power of two in [kMinFftSize, kMaxFftSize].
+  void reset(double sample_rate_hz,
+             std::size_t fft_size = kDefaultFftSize,
+             const std::vector<BandLayout>& extra_layouts = {},
+             bool low_path = false,
+             bool channels = false);
+  // History a chunk needs at a given FFT size (<= kContextFrames).
+  static constexpr std::size_t contextFramesFor(std::size_t fft_size) { return fft_size - 1U; }
+  // Halvings that keep the low path at or above kLowPathMinRateHz; 0 when the
+  // rate is too low for any.
+  static int lowPathStagesFor(double sample_rate_hz);
+  // History a chunk needs for the low path.
+  static std::size_t lowPathContextFramesFor(double sample_rate_hz);
+  void startAt(std::size_t first_frame);
+  void prime(const float* left, const float* right, std::size_t frames);
+  void push(const float* left, const float* right, std::size_t frames);
+  void merge(const SpectralAccumulator& later);
+  SpectralBands finalize();
+  // One spectrum per extra layout, in reset() order.
+  std::vector<BandSpectrum> bandSpectra() const;
+  // L/R/M/S broad bands from the full-rate STFT; nullopt unless reset() was
+  // asked for channels.
+  std::optional<ChannelSpectra> channelSpectra() const;
+  // Fills the per-band correlation and width of `stereo` from the same
+  // frames. Leaves them nullopt without channels.
+  void addBandStereo(StereoMetrics& stereo) const;
+
+ private:
+  // One STFT over a mono stream: frames of the plans' FFT size start on
+  // absolute multiples of their hop. plans.front() supplies the window and
+  // FFT; every plan's bands are accumulated from the same power spectrum.
+  // All per-frame scratch is owned here, so accumulators on different threads
+  // share nothing but the immutable plans.
+  //
+  // In channel mode `pending` holds the left channel and `pending_right` the
+  // right; `spectrum` is the full N-point packed transform.
+  struct Stft {
+    std::vector<std::shared_ptr<const SpectralPlan>> plans;
+    bool channels{false};
+    std::size_t first_frame_start{0};
+    simd::AlignedVector<double> pending;
+    simd::AlignedVector<double> pending_right;
+    std::size_t filled{0};
+    simd::AlignedVector<double> frame;
+    simd::AlignedVector<Complex> spectrum;
+    simd::AlignedVector<double> power;
+    // Left, right and side power and the L/R cross-power Re(L R*) of the
+    // current frame (mid is `power`).
+    std::array<simd::AlignedVector<double>, 4> channel_power;
+    // Summed band energy per plan, one entry per band.
+    std::vector<simd::AlignedVector<double>> accum;
+    // Broad-band sums of channel_power.
+    std::array<simd::AlignedVector<double>, 4> channel_accum;
+    std::size_t windows{0};
+
+    void reset(std::size_t fft_size,
+               double sample_rate_hz,
+               const std::vector<BandLayout>& extra_layouts,
+               bool with_channels);
+    void startAt(std::size_t first_index);
+    // Appends `count` samples whose first has absolute index `first_index`.
+    // `right` is read only in channel mode, where `samples` is the left channel.
+    void add(const double* samples, const double* right, std::size_t count, std::size_t first_index, bool owned);
+    void processFrame();
+    void processChannelFrame();
+    void merge(const Stft& later);
+  };
+
+  void consume(const float* left, const float* right, std::size_t frames, bool owned);
+  // Mean energy of band `band` of plan `p`, from the low path when it covers it.
+  double bandEnergy(std::size_t p, std::size_t band) const;
+
+  double sample_rate_hz_{0.0};
+  std::size_t position_{0};
+  Stft full_;
+
+  // Mono sum of one block: read by the full-rate STFT, then decimated in
+  // place by the cascade.
+  simd::AlignedVector<double> mono_;
+  simd::AlignedVector<double> left_;
+  simd::AlignedVector<double> right_;
+
+  bool low_path_{false};
+  HalfBandCascade cascade_;
+  Stft low_;
+  // Full-rate over low-path energy scale for the same signal: N * sum(w^2)
+  // of each STFT.
+  double low_scale_{1.0};
+};
+
 SpectralBands compute_spectral_bands_interleaved_stereo(const float* interleaved_stereo,
                                                         std::size_t frame_count,
                                                         double sample_rate_hz);
 
+SpectralBands compute_spectral_bands_planar_stereo(const float* left,
+                                                   const float* right,
+                                                   std::size_t frame_count,
+                                                   double sample_rate_hz);
+
+// Same bands with the STFT split across `pool`: at most
+// kMaxParallelSpectralSegments segments of at least
+// kParallelSpectralSegmentFrames, each analyzed by its own accumulator primed
+// with the FFT history before it and folded in segment order as soon as it
+// and every earlier segment are done. Segments depend only on frame_count, so
+// results are bit-identical for any thread count (and match the serial
+// functions to rounding), and scratch stays bounded for any input length.
+// Like the serial functions these use the default STFT settings; Analyzer
+// applies AnalysisOptions.
+inline constexpr std::size_t kParallelSpectralSegmentFrames = std::size_t{1} << 16U;
+inline constexpr std::size_t kMaxParallelSpectralSegments = 64;
+
+SpectralBands compute_spectral_bands_interleaved_stereo(const float* interleaved_stereo,
+                                                        std::size_t frame_count,
+                                                        double sample_rate_hz,
+                                                        ThreadPool& pool);
+
+SpectralBands compute_spectral_bands_planar_stereo(const float* left,
+                                                   const float* right,
+                                                   std::size_t frame_count,
+                                                   double sample_rate_hz,
+                                                   ThreadPool& pool);
+
 }  // namespace aifr3d
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "aifr3d/analyzer.hpp"
+#include "aifr3d/fft.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace aifr3d {
+
+// Everything about an STFT that depends only on its shape: the FFT plan, the
+// Hann window and a sparse band-weight matrix. Each band weights one
+// contiguous run of bins (DC and Nyquist excluded), so applying the matrix is
+// a short dot product per band over the frame's power spectrum.
+//
+// kBroad7 keeps whole-bin membership by centre frequency. The other layouts
+// weight each bin by the fraction of its width inside the band, so bands
+// narrower than a bin still see energy and a layout tiling the spectrum
+// conserves it.
+//
+// Plans are immutable; get() returns a process-wide instance per
+// (fft_size, hop, sample_rate_hz, layout), so repeated analyses at the same
+// rate pay the setup once. Thread-safe.
+class SpectralPlan {
+ public:
+  // Band weights()[offset + j] applies to bin begin + j, for bins [begin, end).
+  struct BandWeights {
+    std::size_t begin{0};
+    std::size_t end{0};
+    std::size_t offset{0};
+  };
+  static constexpr std::uint16_t kNoBand = 0xFFFFU;
+
+  // fft_size must be a power of two >= 4; throws std::invalid_argument
+  // otherwise or when sample_rate_hz is not positive.
+  SpectralPlan(std::size_t fft_size, std::size_t hop, double sample_rate_hz, BandLayout layout);
+
+  static std::shared_ptr<const SpectralPlan> get(std::size_t fft_size,
+                                                 std::size_t hop,
+                                                 double sample_rate_hz,
+                                                 BandLayout layout = BandLayout::kBroad7);
+
+  std::size_t fftSize() const { return fft_size_; }
+  std::size_t hop() const { return hop_; }
+  double sampleRateHz() const { return sample_rate_hz_; }
+  BandLayout layout() const { return layout_; }
+
+  const FftPlan<double>& fft() const { return *fft_; }
+  const std::vector<double>& window() const { return window_; }
+
+  std::size_t bandCount() const { return bands_.size(); }
+  const std::vector<BandWeights>& bands() const { return bands_; }
+  const std::vector<double>& weights() const { return weights_; }
+  const std::vector<double>& lowerHz() const { return lower_hz_; }
+  const std::vector<double>& upperHz() const { return upper_hz_; }
+  // Band holding the centre of each bin 0 .. fft_size / 2, or kNoBand.
+  const std::vector<std::uint16_t>& bandOfBin() const { return band_of_bin_; }
+
+  // band_energy[i] += weighted sum of power over band i, for the
+  // fft_size / 2 + 1 bins of one frame.
+  void accumulateBands(const double* power, double* band_energy) const;
+
+ private:
+  std::size_t fft_size_;
+  std::size_t hop_;
+  double sample_rate_hz_;
+  BandLayout layout_;
+  std::shared_ptr<const FftPlan<double>> fft_;
+  std::vector<double> window_;
+  std::vector<BandWeights> bands_;
+  std::vector<double> weights_;
+  std::vector<double> lower_hz_;
+  std::vector<double> upper_hz_;
+  std::vector<std::uint16_t> band_of_bin_;
+};
+
+}  // namespace aifr3d
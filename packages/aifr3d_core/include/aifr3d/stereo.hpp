@@ -6,7 +6,35 @@
 
 namespace aifr3d {
 
+// Incremental form of compute_stereo_metrics_interleaved_stereo fed with
+// planar blocks. Needs no history, so startAt/prime are no-ops.
+class StereoAccumulator {
+ public:
+  static constexpr std::size_t kContextFrames = 0;
+
+  void reset();
+  void startAt(std::size_t /*first_frame*/) {}
+  void prime(const float* /*left*/, const float* /*right*/, std::size_t /*frames*/) {}
+  void push(const float* left, const float* right, std::size_t frames);
+  void merge(const StereoAccumulator& later);
+  StereoMetrics finalize();
+
+ private:
+  std::size_t frames_{0};
+  double sum_l_{0.0};
+  double sum_r_{0.0};
+  double sum_ll_{0.0};
+  double sum_rr_{0.0};
+  double sum_lr_{0.0};
+  double sum_mid2_{0.0};
+  double sum_side2_{0.0};
+};
+
 StereoMetrics compute_stereo_metrics_interleaved_stereo(const float* interleaved_stereo,
                                                         std::size_t frame_count);
 
+StereoMetrics compute_stereo_metrics_planar_stereo(const float* left,
+                                                   const float* right,
+                                                   std::size_t frame_count);
+
 }  // namespace aifr3d
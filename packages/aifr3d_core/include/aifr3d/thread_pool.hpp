@@ -0,0 +1,48 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace aifr3d {
+
+// Minimal fixed-size worker pool for data-parallel loops. The calling thread
+// participates, so a pool of N threads spawns N - 1 workers. parallelFor calls
+// on one pool are serialized.
+class ThreadPool {
+ public:
+  explicit ThreadPool(std::size_t thread_count);
+  ~ThreadPool();
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  std::size_t threadCount() const { return workers_.size() + 1U; }
+
+  // Runs task(i) for every i in [0, count) and returns once all have finished.
+  // Index order across threads is unspecified; the first exception thrown by a
+  // task is rethrown here after the loop drains.
+  void parallelFor(std::size_t count, const std::function<void(std::size_t)>& task);
+
+ private:
+  void workerLoop();
+  void drain();
+
+  std::vector<std::thread> workers_;
+  std::mutex call_mutex_;
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  const std::function<void(std::size_t)>* task_{nullptr};
+  std::size_t count_{0};
+  std::size_t next_{0};
+  std::size_t active_{0};
+  std::size_t generation_{0};
+  std::exception_ptr error_;
+  bool stopping_{false};
+};
+
+}  // namespace aifr3d
@@ -1,13 +1,74 @@
 #pragma once
 
 #include "aifr3d/analyzer.hpp"
+#include "aifr3d/block.hpp"
 
+#include <array>
 #include <cstddef>
 
 namespace aifr3d {
 
+// Incremental form of compute_true_peak_interleaved_stereo fed with planar
+// blocks, following ITU-R BS.1770-4 Annex 2: each channel is upsampled by a
+// polyphase FIR interpolator (Kaiser-windowed sinc, kTapsPerPhase taps per
+// phase) and the largest magnitude over the samples and the interpolated
+// points is kept. Phase 0 of the interpolator is the identity, so only the
+// factor - 1 in-between phases are filtered.
+//
+// The point at n + p / factor needs input up to frame n + kTapsPerPhase / 2.
+// It is produced when that frame arrives and belongs to the partial owning it,
+// so a chunk needs kContextFrames of history; finalize() flushes the last
+// points against trailing silence. startAt/prime/merge otherwise follow the
+// chunking contract of LoudnessAccumulator.
+//
+// With pruning, each kPruneFrames stretch is only oversampled when the sample
+// peak of the input its windows read, times the interpolator's worst-case
+// gain, could exceed the running maximum; otherwise it provably cannot change
+// the result.
+class TruePeakAccumulator {
+ public:
+  static constexpr std::size_t kTapsPerPhase = 24;
+  static constexpr std::size_t kContextFrames = kTapsPerPhase - 1U;
+  static constexpr std::size_t kPruneFrames = 256;
+
+  // 1 (sample peak only), 2, 4 or 8.
+  static constexpr bool isSupportedFactor(int factor) {
+    return factor == 1 || factor == 2 || factor == 4 || factor == 8;
+  }
+
+  // Throws std::invalid_argument for an unsupported factor.
+  void reset(int oversample_factor, bool pruning = true);
+  void startAt(std::size_t first_frame) { position_ = first_frame; }
+  void prime(const float* left, const float* right, std::size_t frames);
+  void push(const float* left, const float* right, std::size_t frames);
+  void merge(const TruePeakAccumulator& later);
+  TruePeakMetrics finalize();
+
+ private:
+  static constexpr std::size_t kHistory = kTapsPerPhase - 1U;
+
+  void consume(const float* left, const float* right, std::size_t frames, bool owned);
+  float scanInterpolated(const float* window, std::size_t frames) const;
+  float scanChannel(const float* window, std::size_t first, std::size_t end, float max_abs) const;
+
+  int oversample_factor_{1};
+  bool pruning_{true};
+  // Upper bound on |interpolated| / max |input| over a window, rounding included.
+  float overshoot_bound_{1.0f};
+  std::size_t position_{0};
+  float max_abs_{0.0f};
+  // The last kHistory input frames, followed by the block being scanned.
+  std::array<float, kHistory + kAnalysisBlockFrames> left_window_{};
+  std::array<float, kHistory + kAnalysisBlockFrames> right_window_{};
+};
+
 TruePeakMetrics compute_true_peak_interleaved_stereo(const float* interleaved_stereo,
                                                      std::size_t frame_count,
                                                      int oversample_factor);
 
+TruePeakMetrics compute_true_peak_planar_stereo(const float* left,
+                                                const float* right,
+                                                std::size_t frame_count,
+                                                int oversample_factor);
+
 }  // namespace aifr3d
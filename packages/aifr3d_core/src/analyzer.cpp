@@ -1,32 +1,358 @@
 #include "aifr3d/analyzer.hpp"
 
+#include "aifr3d/block.hpp"
 #include "aifr3d/dynamics.hpp"
 #include "aifr3d/loudness.hpp"
 #include "aifr3d/spectral.hpp"
 #include "aifr3d/stereo.hpp"
+#include "aifr3d/thread_pool.hpp"
 #include "aifr3d/true_peak.hpp"
 
-#include <cmath>
+#include <algorithm>
+#include <array>
+#include <functional>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 
 namespace aifr3d {
 
 namespace {
 
-constexpr double kDbFloorAmplitude = 0.0;
+// Chunks never shrink below this, and a buffer is never split into more than
+// kMaxChunks, which bounds the memory held by partial accumulators.
+constexpr std::size_t kMinChunkFrames = std::size_t{1} << 18U;
+constexpr std::size_t kMaxChunks = 64;
 
-std::optional<double> toDbFs(double linear_amplitude) {
-  if (!(linear_amplitude > kDbFloorAmplitude)) {
-    return std::nullopt;
+void validateOptions(const AnalysisOptions& options) {
+  if (!TruePeakAccumulator::isSupportedFactor(options.true_peak_oversample_factor)) {
+    throw std::invalid_argument("true_peak_oversample_factor must be 1, 2, 4 or 8");
   }
-  return 20.0 * std::log10(linear_amplitude);
+  const std::size_t fft = options.fft_size;
+  if (fft < SpectralAccumulator::kMinFftSize || fft > SpectralAccumulator::kMaxFftSize || (fft & (fft - 1U)) != 0U) {
+    throw std::invalid_argument("fft_size must be a power of two in [256, 16384]");
+  }
+}
+
+// History a chunk needs so every window and STFT frame it owns is complete.
+// Stereo and dynamics need none.
+std::size_t chunkContextFrames(const AnalysisOptions& options, double sample_rate_hz) {
+  std::size_t frames = 0;
+  if (options.groups.loudness) {
+    frames = std::max(frames, LoudnessAccumulator::contextFramesFor(sample_rate_hz));
+  }
+  if (options.groups.true_peak) {
+    frames = std::max(frames, TruePeakAccumulator::kContextFrames);
+  }
+  if (options.groups.spectral) {
+    frames = std::max(frames, SpectralAccumulator::contextFramesFor(options.fft_size));
+    if (options.spectral_low_path) {
+      frames = std::max(frames, SpectralAccumulator::lowPathContextFramesFor(sample_rate_hz));
+    }
+  }
+  return frames;
+}
+
+// Every enabled metric accumulator, driven in lockstep. Each block is consumed
+// by all of them while it is still cache resident. Disabled accumulators are
+// never reset or fed, so they cost nothing.
+struct MetricAccumulators {
+  MetricGroups groups;
+  LoudnessAccumulator loudness;
+  TruePeakAccumulator true_peak;
+  SpectralAccumulator spectral;
+  StereoAccumulator stereo;
+  DynamicsAccumulator dynamics;
+
+  // Basic peak/RMS/crest come from the dynamics accumulator, which then skips
+  // its histogram unless dynamics itself is requested.
+  bool needsDynamicsPass() const { return groups.basic || groups.dynamics; }
+
+  void reset(double sample_rate_hz, std::size_t first_frame, const AnalysisOptions& options) {
+    groups = options.groups;
+    if (groups.loudness) {
+      loudness.reset(sample_rate_hz);
+      loudness.startAt(first_frame);
+    }
+    if (groups.true_peak) {
+      true_peak.reset(options.true_peak_oversample_factor, options.true_peak_pruning);
+      true_peak.startAt(first_frame);
+    }
+    if (groups.spectral) {
+      spectral.reset(sample_rate_hz, options.fft_size, options.spectral_band_layouts, options.spectral_low_path,
+                     options.spectral_channels);
+      spectral.startAt(first_frame);
+    }
+    if (groups.stereo) {
+      stereo.reset();
+      stereo.startAt(first_frame);
+    }
+    if (needsDynamicsPass()) {
+      dynamics.reset(sample_rate_hz, groups.dynamics, options.dynamics_exact_percentiles);
+      dynamics.startAt(first_frame);
+    }
+  }
+
+  void prime(const float* l, const float* r, std::size_t n) {
+    if (groups.loudness) {
+      loudness.prime(l, r, n);
+    }
+    if (groups.true_peak) {
+      true_peak.prime(l, r, n);
+    }
+    if (groups.spectral) {
+      spectral.prime(l, r, n);
+    }
+    if (groups.stereo) {
+      stereo.prime(l, r, n);
+    }
+    if (needsDynamicsPass()) {
+      dynamics.prime(l, r, n);
+    }
+  }
+
+  void push(const float* l, const float* r, std::size_t n) {
+    if (groups.loudness) {
+      loudness.push(l, r, n);
+    }
+    if (groups.true_peak) {
+      true_peak.push(l, r, n);
+    }
+    if (groups.spectral) {
+      spectral.push(l, r, n);
+    }
+    if (groups.stereo) {
+      stereo.push(l, r, n);
+    }
+    if (needsDynamicsPass()) {
+      dynamics.push(l, r, n);
+    }
+  }
+
+  void merge(const MetricAccumulators& later) {
+    if (groups.loudness) {
+      loudness.merge(later.loudness);
+    }
+    if (groups.true_peak) {
+      true_peak.merge(later.true_peak);
+    }
+    if (groups.spectral) {
+      spectral.merge(later.spectral);
+    }
+    if (groups.stereo) {
+      stereo.merge(later.stereo);
+    }
+    if (needsDynamicsPass()) {
+      dynamics.merge(later.dynamics);
+    }
+  }
+
+  AnalysisResult finalize(std::size_t frame_count, double sample_rate_hz) {
+    AnalysisResult out;
+    out.schema_version = 1;
+    out.analysis_id = std::nullopt;
+    out.frame_count = frame_count;
+    out.sample_rate_hz = sample_rate_hz;
+    out.generated_at_utc = "1970-01-01T00:00:00Z";
+    out.computed_groups = groups;
+
+    if (groups.loudness) {
+      out.loudness = loudness.finalize();
+    }
+    if (groups.true_peak) {
+      out.true_peak = true_peak.finalize();
+    }
+    if (groups.spectral) {
+      out.spectral = spectral.finalize();
+      out.band_spectra = spectral.bandSpectra();
+      out.channel_spectra = spectral.channelSpectra();
+    }
+    if (groups.stereo) {
+      out.stereo = stereo.finalize();
+      if (groups.spectral) {
+        spectral.addBandStereo(out.stereo);
+      }
+    }
+    if (needsDynamicsPass()) {
+      const DynamicsMetrics dynamics_metrics = dynamics.finalize();
+      // Peak/RMS share the dynamics accumulator: same interleaved summation
+      // order as the former standalone scan, so values are unchanged.
+      if (groups.basic) {
+        out.basic.peak_dbfs = dynamics_metrics.peak_dbfs;
+        out.basic.rms_dbfs = dynamics_metrics.rms_dbfs;
+        out.basic.crest_db = dynamics_metrics.crest_db;
+      }
+      if (groups.dynamics) {
+        out.dynamics = dynamics_metrics;
+        if (groups.loudness) {
+          dynamics.addLoudnessRatios(out.dynamics, out.loudness);
+          // PLR is defined on the true peak; the sample peak stands in only
+          // when the true_peak group is off.
+          if (groups.true_peak && out.true_peak.true_peak_dbfs.has_value() &&
+              out.loudness.integrated_lufs.has_value()) {
+            out.dynamics.plr_db = *out.true_peak.true_peak_dbfs - *out.loudness.integrated_lufs;
+          }
+        }
+      }
+    }
+    return out;
+  }
+};
+
+std::size_t chunkFramesFor(std::size_t frame_count) {
+  const std::size_t even_split = (frame_count + kMaxChunks - 1U) / kMaxChunks;
+  return std::max(kMinChunkFrames, even_split);
+}
+
+// `blocks(first, count, fn)` hands frames [first, first + count) to `fn` as
+// planar blocks; it is the only part that depends on the input layout.
+// Partials are taken from `partials` and only ever grown, so their buffers are
+// reused by the next call.
+template <typename BlockSource>
+AnalysisResult analyzeChunked(ThreadPool* pool,
+                              const AnalysisOptions& options,
+                              std::vector<MetricAccumulators>& partials,
+                              std::size_t frame_count,
+                              double sample_rate_hz,
+                              const BlockSource& blocks) {
+  const std::size_t chunk_frames = chunkFramesFor(frame_count);
+  const std::size_t chunk_count = std::max<std::size_t>(1U, (frame_count + chunk_frames - 1U) / chunk_frames);
+  if (partials.size() < chunk_count) {
+    partials.resize(chunk_count);
+  }
+  const std::size_t context_frames = chunkContextFrames(options, sample_rate_hz);
+
+  // Each chunk is primed with the frames just before it so windows and STFT
+  // frames straddling a boundary are owned by exactly one chunk.
+  const auto run_chunk = [&](std::size_t index) {
+    const std::size_t owned_start = index * chunk_frames;
+    const std::size_t owned_end = std::min(frame_count, owned_start + chunk_frames);
+    const std::size_t context_start = owned_start - std::min(owned_start, context_frames);
+    MetricAccumulators& acc = partials[index];
+    acc.reset(sample_rate_hz, context_start, options);
+    blocks(context_start, owned_start - context_start,
+           [&](const float* l, const float* r, std::size_t n) { acc.prime(l, r, n); });
+    blocks(owned_start, owned_end - owned_start,
+           [&](const float* l, const float* r, std::size_t n) { acc.push(l, r, n); });
+  };
+
+  if (pool != nullptr) {
+    // std::cref keeps the std::function from copying the closure to the heap.
+    pool->parallelFor(chunk_count, std::cref(run_chunk));
+  } else {
+    for (std::size_t i = 0; i < chunk_count; ++i) {
+      run_chunk(i);
+    }
+  }
+
+  for (std::size_t i = 1; i < chunk_count; ++i) {
+    partials.front().merge(partials[i]);
+  }
+  return partials.front().finalize(frame_count, sample_rate_hz);
 }
 
 }  // namespace
 
+struct AnalyzerWorkspace::Storage {
+  std::vector<MetricAccumulators> partials;
+};
+
+AnalyzerWorkspace::AnalyzerWorkspace() : storage_(std::make_unique<Storage>()) {}
+
+AnalyzerWorkspace::~AnalyzerWorkspace() = default;
+
+AnalyzerWorkspace::AnalyzerWorkspace(AnalyzerWorkspace&&) noexcept = default;
+
+AnalyzerWorkspace& AnalyzerWorkspace::operator=(AnalyzerWorkspace&&) noexcept = default;
+
+struct StreamingAnalyzer::State {
+  double sample_rate_hz{0.0};
+  std::size_t frame_count{0};
+  MetricAccumulators metrics;
+};
+
+StreamingAnalyzer::StreamingAnalyzer() : state_(std::make_unique<State>()) {}
+
+StreamingAnalyzer::~StreamingAnalyzer() = default;
+
+StreamingAnalyzer::StreamingAnalyzer(StreamingAnalyzer&&) noexcept = default;
+
+StreamingAnalyzer& StreamingAnalyzer::operator=(StreamingAnalyzer&&) noexcept = default;
+
+void StreamingAnalyzer::reset(double sample_rate_hz, const AnalysisOptions& options) {
+  if (!(sample_rate_hz > 0.0)) {
+    throw std::invalid_argument("sample_rate_hz must be > 0");
+  }
+  validateOptions(options);
+  State& s = *state_;
+  s.sample_rate_hz = sample_rate_hz;
+  s.frame_count = 0;
+  s.metrics.reset(sample_rate_hz, 0, options);
+}
+
+void StreamingAnalyzer::push(const float* interleaved_stereo, std::size_t frame_count) {
+  State& s = *state_;
+  if (!(s.sample_rate_hz > 0.0)) {
+    throw std::logic_error("StreamingAnalyzer::reset must be called before push");
+  }
+  if (frame_count > 0 && interleaved_stereo == nullptr) {
+    throw std::invalid_argument("interleaved_stereo must be non-null when frame_count > 0");
+  }
+
+  for_each_planar_block(interleaved_stereo, frame_count,
+                        [&](const float* l, const float* r, std::size_t n) { s.metrics.push(l, r, n); });
+  s.frame_count += frame_count;
+}
+
+void StreamingAnalyzer::pushPlanar(const float* left, const float* right, std::size_t frame_count) {
+  State& s = *state_;
+  if (!(s.sample_rate_hz > 0.0)) {
+    throw std::logic_error("StreamingAnalyzer::reset must be called before push");
+  }
+  if (frame_count > 0 && (left == nullptr || right == nullptr)) {
+    throw std::invalid_argument("left and right must be non-null when frame_count > 0");
+  }
+
+  for_each_planar_block(left, right, frame_count,
+                        [&](const float* l, const float* r, std::size_t n) { s.metrics.push(l, r, n); });
+  s.frame_count += frame_count;
+}
+
+AnalysisResult StreamingAnalyzer::finalize() {
+  State& s = *state_;
+  if (!(s.sample_rate_hz > 0.0)) {
+    throw std::logic_error("StreamingAnalyzer::reset must be called before finalize");
+  }
+  auto out = s.metrics.finalize(s.frame_count, s.sample_rate_hz);
+  s.sample_rate_hz = 0.0;
+  return out;
+}
+
+Analyzer::Analyzer() = default;
+
+Analyzer::Analyzer(std::size_t thread_count) : Analyzer(AnalysisOptions{}, thread_count) {}
+
+Analyzer::Analyzer(const AnalysisOptions& options, std::size_t thread_count) : options_(options) {
+  validateOptions(options_);
+  if (thread_count == 0) {
+    thread_count = std::max(1U, std::thread::hardware_concurrency());
+  }
+  if (thread_count > 1U) {
+    pool_ = std::make_shared<ThreadPool>(thread_count);
+  }
+}
+
 AnalysisResult Analyzer::analyzeInterleavedStereo(const float* interleaved_stereo,
                                                   std::size_t frame_count,
                                                   double sample_rate_hz) const {
+  AnalyzerWorkspace workspace;
+  return analyzeInterleavedStereo(interleaved_stereo, frame_count, sample_rate_hz, workspace);
+}
+
+AnalysisResult Analyzer::analyzeInterleavedStereo(const float* interleaved_stereo,
+                                                  std::size_t frame_count,
+                                                  double sample_rate_hz,
+                                                  AnalyzerWorkspace& workspace) const {
   if (!(sample_rate_hz > 0.0)) {
     throw std::invalid_argument("sample_rate_hz must be > 0");
   }
@@ -34,47 +360,66 @@ AnalysisResult Analyzer::analyzeInterleavedStereo(const float* interleaved_stere
     throw std::invalid_argument("interleaved_stereo must be non-null when frame_count > 0");
   }
 
-  double peak = 0.0;
-  double energy_sum = 0.0;
-  const std::size_t sample_count = frame_count * 2U;
+  return analyzeChunked(pool_.get(), options_, workspace.storage_->partials, frame_count, sample_rate_hz,
+                        [&](std::size_t first, std::size_t count, const auto& fn) {
+                          for_each_planar_block(interleaved_stereo + first * 2U, count, fn);
+                        });
+}
 
-  for (std::size_t i = 0; i < sample_count; ++i) {
-    const double s = static_cast<double>(interleaved_stereo[i]);
-    const double abs_s = std::fabs(s);
-    if (abs_s > peak) {
-      peak = abs_s;
-    }
-    energy_sum += s * s;
+AnalysisResult Analyzer::analyzePlanarStereo(const float* left,
+                                             const float* right,
+                                             std::size_t frame_count,
+                                             double sample_rate_hz) const {
+  AnalyzerWorkspace workspace;
+  return analyzePlanarStereo(left, right, frame_count, sample_rate_hz, workspace);
+}
+
+AnalysisResult Analyzer::analyzePlanarStereo(const float* left,
+                                             const float* right,
+                                             std::size_t frame_count,
+                                             double sample_rate_hz,
+                                             AnalyzerWorkspace& workspace) const {
+  if (!(sample_rate_hz > 0.0)) {
+    throw std::invalid_argument("sample_rate_hz must be > 0");
+  }
+  if (frame_count > 0 && (left == nullptr || right == nullptr)) {
+    throw std::invalid_argument("left and right must be non-null when frame_count > 0");
   }
 
-  const double rms = (sample_count > 0U) ? std::sqrt(energy_sum / static_cast<double>(sample_count)) : 0.0;
+  return analyzeChunked(pool_.get(), options_, workspace.storage_->partials, frame_count, sample_rate_hz,
+                        [&](std::size_t first, std::size_t count, const auto& fn) {
+                          for_each_planar_block(left + first, right + first, count, fn);
+                        });
+}
 
-  AnalysisResult out;
-  out.schema_version = 1;
-  out.analysis_id = std::nullopt;
-  out.frame_count = frame_count;
-  out.sample_rate_hz = sample_rate_hz;
-  out.generated_at_utc = "1970-01-01T00:00:00Z";
-  out.basic.peak_dbfs = toDbFs(peak);
-  out.basic.rms_dbfs = toDbFs(rms);
+AnalysisResult Analyzer::analyzeBlocks(const PlanarBlockReader& read,
+                                       std::size_t frame_count,
+                                       double sample_rate_hz) const {
+  AnalyzerWorkspace workspace;
+  return analyzeBlocks(read, frame_count, sample_rate_hz, workspace);
+}
 
-  if (out.basic.peak_dbfs.has_value() && out.basic.rms_dbfs.has_value()) {
-    out.basic.crest_db = *out.basic.peak_dbfs - *out.basic.rms_dbfs;
-  } else {
-    out.basic.crest_db = std::nullopt;
+AnalysisResult Analyzer::analyzeBlocks(const PlanarBlockReader& read,
+                                       std::size_t frame_count,
+                                       double sample_rate_hz,
+                                       AnalyzerWorkspace& workspace) const {
+  if (!(sample_rate_hz > 0.0)) {
+    throw std::invalid_argument("sample_rate_hz must be > 0");
+  }
+  if (frame_count > 0 && !read) {
+    throw std::invalid_argument("read must be set when frame_count > 0");
   }
 
-  out.loudness = compute_loudness_interleaved_stereo(interleaved_stereo, frame_count, sample_rate_hz);
-  out.true_peak = compute_true_peak_interleaved_stereo(interleaved_stereo, frame_count, 4);
-  out.spectral = compute_spectral_bands_interleaved_stereo(interleaved_stereo, frame_count, sample_rate_hz);
-  out.stereo = compute_stereo_metrics_interleaved_stereo(interleaved_stereo, frame_count);
-  out.dynamics = compute_dynamics_interleaved_stereo(interleaved_stereo, frame_count);
-
-  out.dynamics.peak_dbfs = out.basic.peak_dbfs;
-  out.dynamics.rms_dbfs = out.basic.rms_dbfs;
-  out.dynamics.crest_db = out.basic.crest_db;
-
-  return out;
+  return analyzeChunked(pool_.get(), options_, workspace.storage_->partials, frame_count, sample_rate_hz,
+                        [&](std::size_t first, std::size_t count, const auto& fn) {
+                          std::array<float, kAnalysisBlockFrames> left{};
+                          std::array<float, kAnalysisBlockFrames> right{};
+                          for (std::size_t start = 0; start < count; start += kAnalysisBlockFrames) {
+                            const std::size_t n = std::min(kAnalysisBlockFrames, count - start);
+                            read(first + start, n, left.data(), right.data());
+                            fn(static_cast<const float*>(left.data()), static_cast<const float*>(right.data()), n);
+                          }
+                        });
 }
 
 }  // namespace aifr3d
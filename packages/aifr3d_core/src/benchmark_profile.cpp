@@ -304,6 +304,19 @@ std::optional<BenchmarkMetricTarget> parseOptionalMetric(const JsonObject& objec
   return parseMetricTarget(it->second.asObject());
 }
 
+// The seven broad bands, each under `prefix` + band name.
+BenchmarkSpectralTargets parseBandTargets(const JsonObject& object, const std::string& prefix) {
+  BenchmarkSpectralTargets out;
+  out.sub = parseOptionalMetric(object, prefix + "sub");
+  out.low = parseOptionalMetric(object, prefix + "low");
+  out.lowmid = parseOptionalMetric(object, prefix + "lowmid");
+  out.mid = parseOptionalMetric(object, prefix + "mid");
+  out.highmid = parseOptionalMetric(object, prefix + "highmid");
+  out.high = parseOptionalMetric(object, prefix + "high");
+  out.air = parseOptionalMetric(object, prefix + "air");
+  return out;
+}
+
 }  // namespace
 
 BenchmarkProfile loadBenchmarkProfileFromJson(const std::string& json_path) {
@@ -341,19 +354,15 @@ BenchmarkProfile loadBenchmarkProfileFromJson(const std::string& json_path) {
   }
   if (const auto it = metrics.find("spectral"); it != metrics.end()) {
     const JsonObject& g = requireObject(it->second, "metrics.spectral");
-    profile.metrics.spectral.sub = parseOptionalMetric(g, "sub");
-    profile.metrics.spectral.low = parseOptionalMetric(g, "low");
-    profile.metrics.spectral.lowmid = parseOptionalMetric(g, "lowmid");
-    profile.metrics.spectral.mid = parseOptionalMetric(g, "mid");
-    profile.metrics.spectral.highmid = parseOptionalMetric(g, "highmid");
-    profile.metrics.spectral.high = parseOptionalMetric(g, "high");
-    profile.metrics.spectral.air = parseOptionalMetric(g, "air");
+    profile.metrics.spectral = parseBandTargets(g, "");
   }
   if (const auto it = metrics.find("stereo"); it != metrics.end()) {
     const JsonObject& g = requireObject(it->second, "metrics.stereo");
     profile.metrics.stereo.correlation = parseOptionalMetric(g, "correlation");
     profile.metrics.stereo.lr_balance_db = parseOptionalMetric(g, "lr_balance_db");
     profile.metrics.stereo.width_proxy = parseOptionalMetric(g, "width_proxy");
+    profile.metrics.stereo.band_correlation = parseBandTargets(g, "correlation_");
+    profile.metrics.stereo.band_width = parseBandTargets(g, "width_");
   }
   if (const auto it = metrics.find("dynamics"); it != metrics.end()) {
     const JsonObject& g = requireObject(it->second, "metrics.dynamics");
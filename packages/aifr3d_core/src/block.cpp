@@ -0,0 +1,15 @@
+#include "aifr3d/block.hpp"
+
+namespace aifr3d {
+
+void deinterleave_stereo(const float* interleaved_stereo,
+                         std::size_t frame_count,
+                         float* left,
+                         float* right) {
+  for (std::size_t i = 0; i < frame_count; ++i) {
+    left[i] = interleaved_stereo[i * 2U];
+    right[i] = interleaved_stereo[i * 2U + 1U];
+  }
+}
+
+}  // namespace aifr3d
@@ -73,6 +73,35 @@ void tally(const MetricDelta& m, BenchmarkCompareSummary& s) {
   }
 }
 
+CompareSpectral compareBands(const SpectralBands& values, const BenchmarkSpectralTargets& targets) {
+  CompareSpectral out;
+  out.sub = compareMetric(values.sub, targets.sub);
+  out.low = compareMetric(values.low, targets.low);
+  out.lowmid = compareMetric(values.lowmid, targets.lowmid);
+  out.mid = compareMetric(values.mid, targets.mid);
+  out.highmid = compareMetric(values.highmid, targets.highmid);
+  out.high = compareMetric(values.high, targets.high);
+  out.air = compareMetric(values.air, targets.air);
+  return out;
+}
+
+void tallyTargetedBands(const CompareSpectral& bands,
+                        const BenchmarkSpectralTargets& targets,
+                        BenchmarkCompareSummary& s) {
+  const auto tally_if = [&](const MetricDelta& m, const std::optional<BenchmarkMetricTarget>& target) {
+    if (target.has_value()) {
+      tally(m, s);
+    }
+  };
+  tally_if(bands.sub, targets.sub);
+  tally_if(bands.low, targets.low);
+  tally_if(bands.lowmid, targets.lowmid);
+  tally_if(bands.mid, targets.mid);
+  tally_if(bands.highmid, targets.highmid);
+  tally_if(bands.high, targets.high);
+  tally_if(bands.air, targets.air);
+}
+
 }  // namespace
 
 BenchmarkCompareResult compareAgainstBenchmark(const AnalysisResult& analysis,
@@ -80,6 +109,7 @@ BenchmarkCompareResult compareAgainstBenchmark(const AnalysisResult& analysis,
   BenchmarkCompareResult out;
   out.profile_id = benchmark.profile_id;
   out.genre = benchmark.genre;
+  out.compared_groups = analysis.computed_groups;
 
   out.basic.peak_dbfs = compareMetric(analysis.basic.peak_dbfs, benchmark.metrics.basic.peak_dbfs);
   out.basic.rms_dbfs = compareMetric(analysis.basic.rms_dbfs, benchmark.metrics.basic.rms_dbfs);
@@ -92,13 +122,7 @@ BenchmarkCompareResult compareAgainstBenchmark(const AnalysisResult& analysis,
   out.loudness.loudness_range_lu = compareMetric(analysis.loudness.loudness_range_lu,
                                                  benchmark.metrics.loudness.loudness_range_lu);
 
-  out.spectral.sub = compareMetric(analysis.spectral.sub, benchmark.metrics.spectral.sub);
-  out.spectral.low = compareMetric(analysis.spectral.low, benchmark.metrics.spectral.low);
-  out.spectral.lowmid = compareMetric(analysis.spectral.lowmid, benchmark.metrics.spectral.lowmid);
-  out.spectral.mid = compareMetric(analysis.spectral.mid, benchmark.metrics.spectral.mid);
-  out.spectral.highmid = compareMetric(analysis.spectral.highmid, benchmark.metrics.spectral.highmid);
-  out.spectral.high = compareMetric(analysis.spectral.high, benchmark.metrics.spectral.high);
-  out.spectral.air = compareMetric(analysis.spectral.air, benchmark.metrics.spectral.air);
+  out.spectral = compareBands(analysis.spectral, benchmark.metrics.spectral);
 
   out.stereo.correlation =
       compareMetric(analysis.stereo.correlation, benchmark.metrics.stereo.correlation);
@@ -106,6 +130,9 @@ BenchmarkCompareResult compareAgainstBenchmark(const AnalysisResult& analysis,
       compareMetric(analysis.stereo.lr_balance_db, benchmark.metrics.stereo.lr_balance_db);
   out.stereo.width_proxy =
       compareMetric(analysis.stereo.width_proxy, benchmark.metrics.stereo.width_proxy);
+  out.stereo.band_correlation =
+      compareBands(analysis.stereo.band_correlation, benchmark.metrics.stereo.band_correlation);
+  out.stereo.band_width = compareBands(analysis.stereo.band_width, benchmark.metrics.stereo.band_width);
 
   out.dynamics.peak_dbfs = compareMetric(analysis.dynamics.peak_dbfs, benchmark.metrics.dynamics.peak_dbfs);
   out.dynamics.rms_dbfs = compareMetric(analysis.dynamics.rms_dbfs, benchmark.metrics.dynamics.rms_dbfs);
@@ -135,6 +162,8 @@ BenchmarkCompareResult compareAgainstBenchmark(const AnalysisResult& analysis,
       tally(g.correlation, out.summary);
       tally(g.lr_balance_db, out.summary);
       tally(g.width_proxy, out.summary);
+      tallyTargetedBands(g.band_correlation, benchmark.metrics.stereo.band_correlation, out.summary);
+      tallyTargetedBands(g.band_width, benchmark.metrics.stereo.band_width, out.summary);
     } else if constexpr (std::is_same_v<T, CompareDynamics>) {
       tally(g.peak_dbfs, out.summary);
       tally(g.rms_dbfs, out.summary);
@@ -143,11 +172,22 @@ BenchmarkCompareResult compareAgainstBenchmark(const AnalysisResult& analysis,
     }
   };
 
-  tally_group(out.basic);
-  tally_group(out.loudness);
-  tally_group(out.spectral);
-  tally_group(out.stereo);
-  tally_group(out.dynamics);
+  const MetricGroups& groups = out.compared_groups;
+  if (groups.basic) {
+    tally_group(out.basic);
+  }
+  if (groups.loudness) {
+    tally_group(out.loudness);
+  }
+  if (groups.spectral) {
+    tally_group(out.spectral);
+  }
+  if (groups.stereo) {
+    tally_group(out.stereo);
+  }
+  if (groups.dynamics) {
+    tally_group(out.dynamics);
+  }
 
   return out;
 }
@@ -1,13 +1,21 @@
 #include "aifr3d/dynamics.hpp"
 
+#include "aifr3d/block.hpp"
+#include "aifr3d/loudness.hpp"
+
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cmath>
-#include <vector>
+#include <functional>
 
 namespace aifr3d {
 
 namespace {
 
+constexpr int kMantissaIndexBits = 12;
+constexpr std::size_t kMantissaTableSize = std::size_t{1} << kMantissaIndexBits;
+
 std::optional<double> to_db(double linear) {
   if (!(linear > 0.0)) {
     return std::nullopt;
@@ -15,48 +23,327 @@ std::optional<double> to_db(double linear) {
   return 20.0 * std::log10(linear);
 }
 
+// Maps the top mantissa bits of a float to its sub-octave bin, so binning a
+// sample needs no log10 call.
+const std::array<std::uint16_t, kMantissaTableSize>& mantissa_bins() {
+  static const auto table = [] {
+    std::array<std::uint16_t, kMantissaTableSize> t{};
+    for (std::size_t j = 0; j < kMantissaTableSize; ++j) {
+      const double m = 1.0 + (static_cast<double>(j) + 0.5) / static_cast<double>(kMantissaTableSize);
+      const double bin = std::floor(std::log2(m) * AmplitudeHistogram::kBinsPerOctave);
+      t[j] = static_cast<std::uint16_t>(std::min(bin, AmplitudeHistogram::kBinsPerOctave - 1.0));
+    }
+    return t;
+  }();
+  return table;
+}
+
 }  // namespace
 
-DynamicsMetrics compute_dynamics_interleaved_stereo(const float* interleaved_stereo,
-                                                    std::size_t frame_count) {
-  DynamicsMetrics out;
-  if (interleaved_stereo == nullptr || frame_count == 0) {
-    return out;
+void AmplitudeHistogram::clear() {
+  bins_.assign(kBinCount, 0U);
+  zero_count_ = 0;
+  total_ = 0;
+}
+
+void AmplitudeHistogram::add(float abs_sample) {
+  ++total_;
+  const std::uint32_t bits = std::bit_cast<std::uint32_t>(abs_sample) & 0x7FFFFFFFU;
+  if (bits == 0U) {
+    ++zero_count_;
+    return;
+  }
+  const int octave = static_cast<int>(bits >> 23U) - 127;
+  std::size_t bin = 0;
+  if (octave >= kMaxOctave) {
+    bin = kBinCount - 1U;
+  } else if (octave >= kMinOctave) {
+    bin = static_cast<std::size_t>(octave - kMinOctave) * static_cast<std::size_t>(kBinsPerOctave) +
+          mantissa_bins()[(bits >> (23U - kMantissaIndexBits)) & (kMantissaTableSize - 1U)];
   }
+  ++bins_[bin];
+}
 
-  const std::size_t sample_count = frame_count * 2U;
-  double peak = 0.0;
-  double sum_sq = 0.0;
-  std::vector<double> abs_values;
-  abs_values.reserve(sample_count);
+void AmplitudeHistogram::merge(const AmplitudeHistogram& other) {
+  for (std::size_t b = 0; b < bins_.size(); ++b) {
+    bins_[b] += other.bins_[b];
+  }
+  zero_count_ += other.zero_count_;
+  total_ += other.total_;
+}
 
-  for (std::size_t i = 0; i < sample_count; ++i) {
-    const double s = static_cast<double>(interleaved_stereo[i]);
-    const double a = std::fabs(s);
-    peak = std::max(peak, a);
-    sum_sq += s * s;
-    abs_values.push_back(a);
+std::optional<double> AmplitudeHistogram::valueDbAtRank(std::uint64_t rank) const {
+  if (rank >= total_ || rank < zero_count_) {
+    return std::nullopt;
+  }
+  std::uint64_t remaining = rank - zero_count_;
+  for (std::size_t b = 0; b < bins_.size(); ++b) {
+    if (remaining < bins_[b]) {
+      const double log2_center =
+          static_cast<double>(kMinOctave) + (static_cast<double>(b) + 0.5) / static_cast<double>(kBinsPerOctave);
+      return 20.0 * std::log10(2.0) * log2_center;
+    }
+    remaining -= bins_[b];
   }
+  return std::nullopt;
+}
+
+void DynamicsAccumulator::reset(double sample_rate_hz, bool track_distribution, bool exact_percentiles) {
+  track_distribution_ = track_distribution;
+  exact_percentiles_ = track_distribution && exact_percentiles;
+  samples_ = 0;
+  peak_ = 0.0;
+  sum_sq_ = 0.0;
+  abs_samples_.clear();
+  if (track_distribution_ && !exact_percentiles_) {
+    histogram_.clear();
+  }
+  hop_frames_ = LoudnessAccumulator::hopFramesFor(sample_rate_hz);
+  position_ = 0;
+  first_hop_ = 0;
+  hops_.clear();
+}
+
+void DynamicsAccumulator::prime(const float* /*left*/, const float* /*right*/, std::size_t frames) {
+  position_ += frames;
+}
+
+void DynamicsAccumulator::accumulateHop(HopLevels& hop, const float* left, const float* right, std::size_t frames) {
+  double sum_l = hop.sum_sq[0];
+  double sum_r = hop.sum_sq[1];
+  float peak_l = hop.peak[0];
+  float peak_r = hop.peak[1];
+  for (std::size_t i = 0; i < frames; ++i) {
+    const double l = static_cast<double>(left[i]);
+    const double r = static_cast<double>(right[i]);
+    sum_l += l * l;
+    sum_r += r * r;
+    peak_l = std::max(peak_l, std::fabs(left[i]));
+    peak_r = std::max(peak_r, std::fabs(right[i]));
+  }
+  hop.sum_sq = {sum_l, sum_r};
+  hop.peak = {peak_l, peak_r};
+  hop.frames += frames;
+}
+
+void DynamicsAccumulator::push(const float* left, const float* right, std::size_t frames) {
+  for (std::size_t i = 0; i < frames; ++i) {
+    const double l = static_cast<double>(left[i]);
+    const double r = static_cast<double>(right[i]);
+    peak_ = std::max(peak_, std::fabs(l));
+    sum_sq_ += l * l;
+    peak_ = std::max(peak_, std::fabs(r));
+    sum_sq_ += r * r;
+  }
+  samples_ += 2U * static_cast<std::uint64_t>(frames);
+  if (exact_percentiles_) {
+    for (std::size_t i = 0; i < frames; ++i) {
+      abs_samples_.push_back(std::fabs(left[i]));
+      abs_samples_.push_back(std::fabs(right[i]));
+    }
+  } else if (track_distribution_) {
+    for (std::size_t i = 0; i < frames; ++i) {
+      histogram_.add(std::fabs(left[i]));
+      histogram_.add(std::fabs(right[i]));
+    }
+  }
+  if (!track_distribution_) {
+    return;
+  }
+  std::size_t done = 0;
+  while (done < frames) {
+    const std::size_t hop = position_ / hop_frames_;
+    const std::size_t n = std::min(frames - done, (hop + 1U) * hop_frames_ - position_);
+    if (hops_.empty()) {
+      first_hop_ = hop;
+    }
+    const std::size_t index = hop - first_hop_;
+    if (index == hops_.size()) {
+      hops_.emplace_back();
+    }
+    accumulateHop(hops_[index], left + done, right + done, n);
+    position_ += n;
+    done += n;
+  }
+}
 
-  const double rms = std::sqrt(sum_sq / static_cast<double>(sample_count));
-  out.peak_dbfs = to_db(peak);
+void DynamicsAccumulator::merge(const DynamicsAccumulator& later) {
+  peak_ = std::max(peak_, later.peak_);
+  sum_sq_ += later.sum_sq_;
+  samples_ += later.samples_;
+  if (exact_percentiles_) {
+    abs_samples_.insert(abs_samples_.end(), later.abs_samples_.begin(), later.abs_samples_.end());
+  } else if (track_distribution_) {
+    histogram_.merge(later.histogram_);
+  }
+  if (track_distribution_ && !later.hops_.empty()) {
+    if (hops_.empty()) {
+      first_hop_ = later.first_hop_;
+    }
+    // Only the first hop of `later` can straddle the boundary with ours.
+    for (std::size_t j = 0; j < later.hops_.size(); ++j) {
+      const std::size_t index = later.first_hop_ + j - first_hop_;
+      const HopLevels& hop = later.hops_[j];
+      if (index < hops_.size()) {
+        HopLevels& into = hops_[index];
+        into.sum_sq[0] += hop.sum_sq[0];
+        into.sum_sq[1] += hop.sum_sq[1];
+        into.peak = {std::max(into.peak[0], hop.peak[0]), std::max(into.peak[1], hop.peak[1])};
+        into.frames += hop.frames;
+      } else {
+        hops_.push_back(hop);
+      }
+    }
+  }
+  position_ = later.position_;
+}
+
+DynamicsMetrics DynamicsAccumulator::finalize() {
+  DynamicsMetrics out;
+  const std::uint64_t n = samples_;
+  if (n == 0U) {
+    return out;
+  }
+
+  const double rms = std::sqrt(sum_sq_ / static_cast<double>(n));
+  out.peak_dbfs = to_db(peak_);
   out.rms_dbfs = to_db(rms);
   if (out.peak_dbfs.has_value() && out.rms_dbfs.has_value()) {
     out.crest_db = *out.peak_dbfs - *out.rms_dbfs;
   }
+  if (!track_distribution_) {
+    return out;
+  }
+
+  const auto p10_idx = static_cast<std::uint64_t>(static_cast<double>(n - 1U) * 0.10);
+  const auto p95_idx = static_cast<std::uint64_t>(static_cast<double>(n - 1U) * 0.95);
+  std::optional<double> p10_db;
+  std::optional<double> p95_db;
+  if (exact_percentiles_) {
+    // Two selections, the second over the elements above the first: O(N).
+    const auto p10 = abs_samples_.begin() + static_cast<std::ptrdiff_t>(p10_idx);
+    const auto p95 = abs_samples_.begin() + static_cast<std::ptrdiff_t>(p95_idx);
+    std::nth_element(abs_samples_.begin(), p10, abs_samples_.end());
+    if (p95 != p10) {
+      std::nth_element(p10 + 1, p95, abs_samples_.end());
+    }
+    p10_db = to_db(static_cast<double>(*p10));
+    p95_db = to_db(static_cast<double>(*p95));
+  } else {
+    p10_db = histogram_.valueDbAtRank(p10_idx);
+    p95_db = histogram_.valueDbAtRank(p95_idx);
+  }
+  if (p10_db.has_value() && p95_db.has_value()) {
+    out.dr_proxy_db = *p95_db - *p10_db;
+  }
+
+  // Blocks are counted from the start of the stream; a final partial block
+  // counts with its own length.
+  if (!hops_.empty()) {
+    const std::size_t first_block = first_hop_ / kDrBlockHops;
+    const std::size_t block_count = (first_hop_ + hops_.size() - 1U) / kDrBlockHops - first_block + 1U;
+    const std::size_t loudest = std::max<std::size_t>(
+        1U, static_cast<std::size_t>(kDrLoudestFraction * static_cast<double>(block_count)));
+    double dr_sum = 0.0;
+    int dr_channels = 0;
+    for (std::size_t c = 0; c < 2U; ++c) {
+      // DR14 block RMS is scaled by sqrt(2) so a full-scale sine reads 0 dBFS.
+      block_scratch_.assign(block_count, 0.0);
+      std::size_t block_frames = 0;
+      for (std::size_t i = 0; i < hops_.size(); ++i) {
+        const std::size_t b = (first_hop_ + i) / kDrBlockHops - first_block;
+        block_scratch_[b] += hops_[i].sum_sq[c];
+        block_frames += hops_[i].frames;
+        if (i + 1U == hops_.size() || (first_hop_ + i + 1U) % kDrBlockHops == 0U) {
+          block_scratch_[b] = 2.0 * block_scratch_[b] / static_cast<double>(block_frames);
+          block_frames = 0;
+        }
+      }
+      std::nth_element(block_scratch_.begin(), block_scratch_.begin() + static_cast<std::ptrdiff_t>(loudest - 1U),
+                       block_scratch_.end(), std::greater<>());
+      double top_mean_square = 0.0;
+      for (std::size_t b = 0; b < loudest; ++b) {
+        top_mean_square += block_scratch_[b];
+      }
+      top_mean_square /= static_cast<double>(loudest);
+
+      // The second-highest block peak, so a single click cannot set it.
+      block_scratch_.assign(block_count, 0.0);
+      for (std::size_t i = 0; i < hops_.size(); ++i) {
+        double& peak = block_scratch_[(first_hop_ + i) / kDrBlockHops - first_block];
+        peak = std::max(peak, static_cast<double>(hops_[i].peak[c]));
+      }
+      const std::size_t rank = block_count > 1U ? 1U : 0U;
+      std::nth_element(block_scratch_.begin(), block_scratch_.begin() + static_cast<std::ptrdiff_t>(rank),
+                       block_scratch_.end(), std::greater<>());
+      const double peak = block_scratch_[rank];
 
-  std::sort(abs_values.begin(), abs_values.end());
-  if (!abs_values.empty()) {
-    const std::size_t p10_idx = static_cast<std::size_t>((abs_values.size() - 1U) * 0.10);
-    const std::size_t p95_idx = static_cast<std::size_t>((abs_values.size() - 1U) * 0.95);
-    const auto p10_db = to_db(abs_values[p10_idx]);
-    const auto p95_db = to_db(abs_values[p95_idx]);
-    if (p10_db.has_value() && p95_db.has_value()) {
-      out.dr_proxy_db = *p95_db - *p10_db;
+      if (top_mean_square > 0.0 && peak > 0.0) {
+        dr_sum += 20.0 * std::log10(peak) - 10.0 * std::log10(top_mean_square);
+        ++dr_channels;
+      }
+    }
+    if (dr_channels > 0) {
+      out.dr_db = dr_sum / static_cast<double>(dr_channels);
     }
   }
 
   return out;
 }
 
+void DynamicsAccumulator::addLoudnessRatios(DynamicsMetrics& metrics, const LoudnessMetrics& loudness) const {
+  if (loudness.integrated_lufs.has_value() && peak_ > 0.0) {
+    metrics.plr_db = 20.0 * std::log10(peak_) - *loudness.integrated_lufs;
+  }
+
+  // Short-term window w covers hops [w, w + kShortTermHops) of the stream.
+  const std::size_t window_hops = LoudnessAccumulator::kShortTermHops;
+  metrics.psr_series_db.clear();
+  metrics.psr_series_db.reserve(loudness.short_term_series_lufs.size());
+  for (std::size_t w = 0; w < loudness.short_term_series_lufs.size(); ++w) {
+    const auto& lufs = loudness.short_term_series_lufs[w];
+    float peak = 0.0f;
+    for (std::size_t h = w; h < w + window_hops; ++h) {
+      if (h >= first_hop_ && h - first_hop_ < hops_.size()) {
+        const HopLevels& hop = hops_[h - first_hop_];
+        peak = std::max(peak, std::max(hop.peak[0], hop.peak[1]));
+      }
+    }
+    if (lufs.has_value() && peak > 0.0f) {
+      metrics.psr_series_db.emplace_back(20.0 * std::log10(static_cast<double>(peak)) - *lufs);
+    } else {
+      metrics.psr_series_db.emplace_back(std::nullopt);
+    }
+  }
+}
+
+DynamicsMetrics compute_dynamics_interleaved_stereo(const float* interleaved_stereo,
+                                                    std::size_t frame_count,
+                                                    double sample_rate_hz) {
+  if (interleaved_stereo == nullptr || frame_count == 0) {
+    return DynamicsMetrics{};
+  }
+
+  DynamicsAccumulator acc;
+  acc.reset(sample_rate_hz);
+  for_each_planar_block(interleaved_stereo, frame_count,
+                        [&](const float* l, const float* r, std::size_t n) { acc.push(l, r, n); });
+  return acc.finalize();
+}
+
+DynamicsMetrics compute_dynamics_planar_stereo(const float* left,
+                                               const float* right,
+                                               std::size_t frame_count,
+                                               double sample_rate_hz) {
+  if (left == nullptr || right == nullptr || frame_count == 0) {
+    return DynamicsMetrics{};
+  }
+
+  DynamicsAccumulator acc;
+  acc.reset(sample_rate_hz);
+  for_each_planar_block(left, right, frame_count,
+                        [&](const float* l, const float* r, std::size_t n) { acc.push(l, r, n); });
+  return acc.finalize();
+}
+
 }  // namespace aifr3d
@@ -1,10 +1,34 @@
 #include "aifr3d/fft.hpp"
 
 #include <cmath>
+#include <map>
+#include <mutex>
 #include <stdexcept>
 
 namespace aifr3d {
 
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Index pairs (i, j), i < j, exchanged by the bit-reversal permutation of n.
+std::vector<std::pair<std::uint32_t, std::uint32_t>> bit_reversal_swaps(std::size_t n) {
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> swaps;
+  for (std::size_t i = 1, j = 0; i < n; ++i) {
+    std::size_t bit = n >> 1U;
+    for (; j & bit; bit >>= 1U) {
+      j ^= bit;
+    }
+    j ^= bit;
+    if (i < j) {
+      swaps.emplace_back(static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(j));
+    }
+  }
+  return swaps;
+}
+
+}  // namespace
+
 std::size_t next_power_of_two(std::size_t v) {
   if (v == 0) {
     return 1;
@@ -21,32 +45,95 @@ void fft_inplace(std::vector<Complex>& data) {
   if (n == 0 || (n & (n - 1U)) != 0U) {
     throw std::invalid_argument("fft_inplace requires power-of-two non-empty input");
   }
+  if (n == 1U) {
+    return;
+  }
+  FftPlan<double>::forSize(n)->forward(data.data());
+}
 
-  for (std::size_t i = 1, j = 0; i < n; ++i) {
-    std::size_t bit = n >> 1U;
-    for (; j & bit; bit >>= 1U) {
-      j ^= bit;
-    }
-    j ^= bit;
-    if (i < j) {
-      std::swap(data[i], data[j]);
-    }
+template <typename T>
+FftPlan<T>::FftPlan(std::size_t size) : size_(size) {
+  if (size < 2U || (size & (size - 1U)) != 0U || size > (std::size_t{1} << 31U)) {
+    throw std::invalid_argument("FftPlan size must be a power of two >= 2");
   }
+  twiddles_.resize(size / 2U);
+  for (std::size_t k = 0; k < twiddles_.size(); ++k) {
+    const double angle = -2.0 * kPi * static_cast<double>(k) / static_cast<double>(size);
+    twiddles_[k] = ComplexT(static_cast<T>(std::cos(angle)), static_cast<T>(std::sin(angle)));
+  }
+  swaps_ = bit_reversal_swaps(size);
+  half_swaps_ = bit_reversal_swaps(size / 2U);
+}
+
+template <typename T>
+std::shared_ptr<const FftPlan<T>> FftPlan<T>::forSize(std::size_t size) {
+  static std::mutex mutex;
+  static std::map<std::size_t, std::shared_ptr<const FftPlan>> plans;
+  const std::lock_guard<std::mutex> lock(mutex);
+  const auto it = plans.find(size);
+  if (it != plans.end()) {
+    return it->second;
+  }
+  auto plan = std::make_shared<const FftPlan>(size);
+  plans.emplace(size, plan);
+  return plan;
+}
 
+// n divides size_; the twiddle for butterfly j of a len-point stage is
+// exp(-2 pi i j / len) = twiddles_[j * (size_ / len)].
+template <typename T>
+void FftPlan<T>::transform(ComplexT* data, std::size_t n, const SwapList& swaps) const {
+  for (const auto& [i, j] : swaps) {
+    std::swap(data[i], data[j]);
+  }
   for (std::size_t len = 2; len <= n; len <<= 1U) {
-    const double ang = -2.0 * std::acos(-1.0) / static_cast<double>(len);
-    const Complex wlen(std::cos(ang), std::sin(ang));
+    const std::size_t half = len / 2U;
+    const std::size_t stride = size_ / len;
     for (std::size_t i = 0; i < n; i += len) {
-      Complex w(1.0, 0.0);
-      for (std::size_t j = 0; j < len / 2U; ++j) {
-        const Complex u = data[i + j];
-        const Complex v = data[i + j + len / 2U] * w;
+      for (std::size_t j = 0; j < half; ++j) {
+        const ComplexT u = data[i + j];
+        const ComplexT v = data[i + j + half] * twiddles_[j * stride];
         data[i + j] = u + v;
-        data[i + j + len / 2U] = u - v;
-        w *= wlen;
+        data[i + j + half] = u - v;
       }
     }
   }
 }
 
+template <typename T>
+void FftPlan<T>::forward(ComplexT* data) const {
+  transform(data, size_, swaps_);
+}
+
+// Even samples in the real part and odd samples in the imaginary part give
+// Z = E + iO, with E and O the half-size spectra of the two phases; then
+// X[k] = E[k] + W^k O[k] and X[m - k] = conj(E[k] - W^k O[k]).
+template <typename T>
+void FftPlan<T>::forwardReal(const T* in, ComplexT* out) const {
+  const std::size_t m = size_ / 2U;
+  for (std::size_t k = 0; k < m; ++k) {
+    out[k] = ComplexT(in[2U * k], in[2U * k + 1U]);
+  }
+  transform(out, m, half_swaps_);
+
+  const ComplexT z0 = out[0];
+  out[0] = ComplexT(z0.real() + z0.imag(), T(0));
+  out[m] = ComplexT(z0.real() - z0.imag(), T(0));
+  const T half = T(0.5);
+  for (std::size_t k = 1; k <= m / 2U; ++k) {
+    const ComplexT a = out[k];
+    const ComplexT b = std::conj(out[m - k]);
+    const ComplexT even = (a + b) * half;
+    const ComplexT diff = (a - b) * half;
+    // diff / i
+    const ComplexT odd(diff.imag(), -diff.real());
+    const ComplexT rotated = twiddles_[k] * odd;
+    out[k] = even + rotated;
+    out[m - k] = std::conj(even - rotated);
+  }
+}
+
+template class FftPlan<float>;
+template class FftPlan<double>;
+
 }  // namespace aifr3d
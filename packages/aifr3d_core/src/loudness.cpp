@@ -1,61 +1,437 @@
 #include "aifr3d/loudness.hpp"
 
+#include "aifr3d/block.hpp"
+#include "aifr3d/simd.hpp"
+
+#include <algorithm>
 #include <cmath>
 
 namespace aifr3d {
 
-LoudnessMetrics compute_loudness_interleaved_stereo(const float* interleaved_stereo,
-                                                    std::size_t frame_count,
-                                                    double sample_rate_hz) {
-  (void)sample_rate_hz;
+namespace {
 
-  LoudnessMetrics out;
-  if (interleaved_stereo == nullptr || frame_count == 0) {
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kHopSeconds = 0.1;
+// The RLB high-pass decays as exp(-240 t); after 250 ms an unprimed filter
+// state is below double rounding of the signal.
+constexpr double kFilterSettleSeconds = 0.25;
+constexpr double kIntegratedRelativeGateLu = 10.0;
+constexpr double kRangeRelativeGateLu = 20.0;
+constexpr double kRangeLowQuantile = 0.10;
+constexpr double kRangeHighQuantile = 0.95;
+
+std::optional<double> mean_square_to_lufs(double mean_square) {
+  if (!(mean_square > 0.0)) {
+    return std::nullopt;
+  }
+  return -0.691 + 10.0 * std::log10(mean_square);
+}
+
+}  // namespace
+
+std::array<BiquadCoefficients, 2> k_weighting_coefficients(double sample_rate_hz) {
+  std::array<BiquadCoefficients, 2> out{};
+  if (!(sample_rate_hz > 0.0)) {
     return out;
   }
 
-  double mean_square = 0.0;
-  double max_short_term_ms = 0.0;
-  const std::size_t sample_count = frame_count * 2U;
+  // A stage whose corner lies at or above Nyquist is left as identity.
+  constexpr double kShelfHz = 1681.974450955533;
+  constexpr double kShelfGainDb = 3.999843853973347;
+  constexpr double kShelfQ = 0.7071752369554196;
+  if (kShelfHz < 0.5 * sample_rate_hz) {
+    const double k = std::tan(kPi * kShelfHz / sample_rate_hz);
+    const double vh = std::pow(10.0, kShelfGainDb / 20.0);
+    const double vb = std::pow(vh, 0.4996667741545416);
+    const double a0 = 1.0 + k / kShelfQ + k * k;
+    out[0].b0 = (vh + vb * k / kShelfQ + k * k) / a0;
+    out[0].b1 = 2.0 * (k * k - vh) / a0;
+    out[0].b2 = (vh - vb * k / kShelfQ + k * k) / a0;
+    out[0].a1 = 2.0 * (k * k - 1.0) / a0;
+    out[0].a2 = (1.0 - k / kShelfQ + k * k) / a0;
+  }
+
+  constexpr double kHighPassHz = 38.13547087602444;
+  constexpr double kHighPassQ = 0.5003270373238773;
+  if (kHighPassHz < 0.5 * sample_rate_hz) {
+    const double k = std::tan(kPi * kHighPassHz / sample_rate_hz);
+    const double a0 = 1.0 + k / kHighPassQ + k * k;
+    out[1].b0 = 1.0;
+    out[1].b1 = -2.0;
+    out[1].b2 = 1.0;
+    out[1].a1 = 2.0 * (k * k - 1.0) / a0;
+    out[1].a2 = (1.0 - k / kHighPassQ + k * k) / a0;
+  }
+  return out;
+}
 
-  for (std::size_t i = 0; i < sample_count; ++i) {
-    const double s = static_cast<double>(interleaved_stereo[i]);
-    mean_square += s * s;
+void LoudnessHistogram::clear() {
+  counts_.assign(kBinCount, 0U);
+  energy_.assign(kBinCount, 0.0);
+  total_ = 0;
+  total_energy_ = 0.0;
+}
+
+void LoudnessHistogram::add(double mean_square) {
+  const auto lufs = mean_square_to_lufs(mean_square);
+  if (!lufs.has_value() || !(*lufs > kAbsoluteGateLufs)) {
+    return;
   }
-  mean_square /= static_cast<double>(sample_count);
+  const double position = (*lufs - kAbsoluteGateLufs) * static_cast<double>(kBinsPerLu);
+  const auto bin = std::min(static_cast<std::size_t>(position), kBinCount - 1U);
+  ++counts_[bin];
+  energy_[bin] += mean_square;
+  ++total_;
+  total_energy_ += mean_square;
+}
+
+void LoudnessHistogram::merge(const LoudnessHistogram& other) {
+  for (std::size_t b = 0; b < counts_.size(); ++b) {
+    counts_[b] += other.counts_[b];
+    energy_[b] += other.energy_[b];
+  }
+  total_ += other.total_;
+  total_energy_ += other.total_energy_;
+}
+
+// First bin whose centre lies above the relative threshold, or kBinCount
+// when the histogram is empty or silent.
+std::size_t LoudnessHistogram::firstBinAboveRelativeGate(double relative_gate_lu) const {
+  if (total_ == 0U) {
+    return kBinCount;
+  }
+  const auto ungated = mean_square_to_lufs(total_energy_ / static_cast<double>(total_));
+  if (!ungated.has_value()) {
+    return kBinCount;
+  }
+  const double threshold = *ungated - relative_gate_lu;
+  const double centre_offset = (threshold - kAbsoluteGateLufs) * static_cast<double>(kBinsPerLu) - 0.5;
+  return centre_offset < 0.0 ? 0U : std::min(static_cast<std::size_t>(centre_offset) + 1U, kBinCount - 1U);
+}
+
+std::optional<double> LoudnessHistogram::gatedLufs(double relative_gate_lu) const {
+  std::uint64_t count = 0;
+  double energy = 0.0;
+  for (std::size_t b = firstBinAboveRelativeGate(relative_gate_lu); b < counts_.size(); ++b) {
+    count += counts_[b];
+    energy += energy_[b];
+  }
+  if (count == 0U) {
+    return std::nullopt;
+  }
+  return mean_square_to_lufs(energy / static_cast<double>(count));
+}
+
+std::optional<double> LoudnessHistogram::gatedRangeLu(double relative_gate_lu,
+                                                      double low_quantile,
+                                                      double high_quantile) const {
+  const std::size_t first = firstBinAboveRelativeGate(relative_gate_lu);
+  std::uint64_t count = 0;
+  for (std::size_t b = first; b < counts_.size(); ++b) {
+    count += counts_[b];
+  }
+  if (count == 0U) {
+    return std::nullopt;
+  }
+
+  const auto lufs_at_quantile = [&](double q) {
+    std::uint64_t remaining = static_cast<std::uint64_t>(std::floor(static_cast<double>(count - 1U) * q + 0.5));
+    std::size_t b = first;
+    while (remaining >= counts_[b]) {
+      remaining -= counts_[b];
+      ++b;
+    }
+    return kAbsoluteGateLufs + (static_cast<double>(b) + 0.5) / static_cast<double>(kBinsPerLu);
+  };
+  return lufs_at_quantile(high_quantile) - lufs_at_quantile(low_quantile);
+}
+
+std::size_t LoudnessAccumulator::contextFramesFor(double sample_rate_hz) {
+  const double settle = std::ceil(sample_rate_hz * kFilterSettleSeconds);
+  return hopFramesFor(sample_rate_hz) + (settle >= 1.0 ? static_cast<std::size_t>(settle) : 0U);
+}
+
+std::size_t LoudnessAccumulator::hopFramesFor(double sample_rate_hz) {
+  const double frames = std::round(sample_rate_hz * kHopSeconds);
+  return frames >= 1.0 ? static_cast<std::size_t>(frames) : 1U;
+}
+
+void LoudnessAccumulator::reset(double sample_rate_hz) {
+  sample_rate_hz_ = sample_rate_hz;
+  hop_frames_ = hopFramesFor(sample_rate_hz);
+  position_ = 0;
+  owned_frames_ = 0;
+  sum_sq_ = {};
+  k_filter_ = k_weighting_coefficients(sample_rate_hz);
+  k_state_.fill(0.0);
+  hop_energy_ = {};
+  hop_valid_ = true;
+  ring_.fill(0.0);
+  head_.fill(0.0);
+  first_hop_ = 0;
+  hop_count_ = 0;
+  momentary_sum_ = 0.0;
+  short_term_sum_ = 0.0;
+  max_momentary_energy_ = 0.0;
+  max_short_term_energy_ = 0.0;
+  momentary_windows_ = 0;
+  gating_.clear();
+  short_term_gating_.clear();
+  short_term_series_.clear();
+}
+
+void LoudnessAccumulator::startAt(std::size_t first_frame) {
+  position_ = first_frame;
+  hop_valid_ = first_frame % hop_frames_ == 0U;
+}
+
+double LoudnessAccumulator::ringSum(std::size_t last_hop, std::size_t hops) const {
+  double sum = 0.0;
+  for (std::size_t h = last_hop + 1U - hops; h <= last_hop; ++h) {
+    sum += ring_[h % kShortTermHops];
+  }
+  return sum;
+}
+
+void LoudnessAccumulator::emitMomentary(double window_energy) {
+  max_momentary_energy_ = std::max(max_momentary_energy_, window_energy);
+  ++momentary_windows_;
+  gating_.add(window_energy / (static_cast<double>(kMomentaryHops) * static_cast<double>(hop_frames_)));
+}
+
+void LoudnessAccumulator::emitShortTerm(double window_energy) {
+  max_short_term_energy_ = std::max(max_short_term_energy_, window_energy);
+  short_term_series_.push_back(window_energy);
+  short_term_gating_.add(window_energy / (static_cast<double>(kShortTermHops) * static_cast<double>(hop_frames_)));
+}
 
-  constexpr std::size_t window_frames = 4800;  // ~100ms @ 48kHz proxy window
-  if (frame_count >= window_frames) {
-    for (std::size_t start = 0; start + window_frames <= frame_count; start += window_frames / 2U) {
-      double wms = 0.0;
-      for (std::size_t f = 0; f < window_frames; ++f) {
-        const std::size_t idx = (start + f) * 2U;
-        const double l = static_cast<double>(interleaved_stereo[idx]);
-        const double r = static_cast<double>(interleaved_stereo[idx + 1U]);
-        const double mono = 0.5 * (l + r);
-        wms += mono * mono;
+// Records the hop ending at position_. Only hops observed from their first
+// frame and ending inside the owned range count.
+void LoudnessAccumulator::closeHop(bool owned) {
+  if (owned && hop_valid_) {
+    const double hop_energy = hop_energy_[0] + hop_energy_[1];
+    const std::size_t k = position_ / hop_frames_ - 1U;
+    if (hop_count_ == 0U) {
+      first_hop_ = k;
+    }
+    if (hop_count_ < head_.size()) {
+      head_[hop_count_] = hop_energy;
+    }
+    ++hop_count_;
+
+    double& slot = ring_[k % kShortTermHops];
+    short_term_sum_ += hop_energy - slot;
+    if (k >= kMomentaryHops) {
+      momentary_sum_ -= ring_[(k - kMomentaryHops) % kShortTermHops];
+    }
+    momentary_sum_ += hop_energy;
+    slot = hop_energy;
+    if ((k + 1U) % kShortTermHops == 0U) {
+      short_term_sum_ = ringSum(k, kShortTermHops);
+    }
+    if ((k + 1U) % kMomentaryHops == 0U) {
+      momentary_sum_ = ringSum(k, kMomentaryHops);
+    }
+
+    // Windows reaching back before this partial's first hop are left to merge().
+    const std::size_t local_hops = k - first_hop_ + 1U;
+    if (local_hops >= kMomentaryHops) {
+      emitMomentary(momentary_sum_);
+    }
+    if (local_hops >= kShortTermHops) {
+      emitShortTerm(short_term_sum_);
+    }
+  }
+  hop_energy_ = {};
+  hop_valid_ = true;
+}
+
+void LoudnessAccumulator::consume(const float* left, const float* right, std::size_t frames, bool owned) {
+  using simd::Double2;
+  const BiquadCoefficients& pre = k_filter_[0];
+  const BiquadCoefficients& rlb = k_filter_[1];
+  const Double2 pb0 = Double2::broadcast(pre.b0);
+  const Double2 pb1 = Double2::broadcast(pre.b1);
+  const Double2 pb2 = Double2::broadcast(pre.b2);
+  const Double2 pa1 = Double2::broadcast(pre.a1);
+  const Double2 pa2 = Double2::broadcast(pre.a2);
+  const Double2 rb0 = Double2::broadcast(rlb.b0);
+  const Double2 rb1 = Double2::broadcast(rlb.b1);
+  const Double2 rb2 = Double2::broadcast(rlb.b2);
+  const Double2 ra1 = Double2::broadcast(rlb.a1);
+  const Double2 ra2 = Double2::broadcast(rlb.a2);
+  Double2 p1 = Double2::set(k_state_[0], k_state_[1]);
+  Double2 p2 = Double2::set(k_state_[2], k_state_[3]);
+  Double2 r1 = Double2::set(k_state_[4], k_state_[5]);
+  Double2 r2 = Double2::set(k_state_[6], k_state_[7]);
+
+  Double2 total = Double2::set(sum_sq_[0], sum_sq_[1]);
+
+  std::size_t i = 0;
+  while (i < frames) {
+    const std::size_t segment = std::min(frames - i, hop_frames_ - (position_ % hop_frames_));
+    Double2 energy = Double2::set(hop_energy_[0], hop_energy_[1]);
+    for (std::size_t k = i; k < i + segment; ++k) {
+      const Double2 x = Double2::set(static_cast<double>(left[k]), static_cast<double>(right[k]));
+      const Double2 shelved = pb0 * x + p1;
+      p1 = pb1 * x - pa1 * shelved + p2;
+      p2 = pb2 * x - pa2 * shelved;
+      const Double2 y = rb0 * shelved + r1;
+      r1 = rb1 * shelved - ra1 * y + r2;
+      r2 = rb2 * shelved - ra2 * y;
+      const Double2 power = y * y;
+      energy = energy + power;
+      if (owned) {
+        total = total + power;
+      }
+    }
+    hop_energy_ = {energy.lo(), energy.hi()};
+    position_ += segment;
+    i += segment;
+    if (position_ % hop_frames_ == 0U) {
+      closeHop(owned);
+    }
+  }
+
+  k_state_ = {p1.lo(), p1.hi(), p2.lo(), p2.hi(), r1.lo(), r1.hi(), r2.lo(), r2.hi()};
+  sum_sq_ = {total.lo(), total.hi()};
+}
+
+void LoudnessAccumulator::prime(const float* left, const float* right, std::size_t frames) {
+  consume(left, right, frames, false);
+}
+
+void LoudnessAccumulator::push(const float* left, const float* right, std::size_t frames) {
+  consume(left, right, frames, true);
+  owned_frames_ += frames;
+}
+
+void LoudnessAccumulator::merge(const LoudnessAccumulator& later) {
+  // Windows ending on the later partial's leading hops span the boundary:
+  // their older hops are in this partial's ring. Emitting them here keeps the
+  // short-term series in stream order.
+  const std::size_t stitched = std::min(later.hop_count_, kShortTermHops - 1U);
+  for (std::size_t j = 0; j < stitched; ++j) {
+    const std::size_t k = later.first_hop_ + j;
+    const auto window_energy = [&](std::size_t hops) {
+      double sum = 0.0;
+      for (std::size_t h = k + 1U - hops; h < later.first_hop_; ++h) {
+        sum += ring_[h % kShortTermHops];
       }
-      wms /= static_cast<double>(window_frames);
-      if (wms > max_short_term_ms) {
-        max_short_term_ms = wms;
+      for (std::size_t h = 0; h <= j; ++h) {
+        sum += later.head_[h];
       }
+      return sum;
+    };
+    if (j + 1U < kMomentaryHops && k + 1U >= kMomentaryHops) {
+      emitMomentary(window_energy(kMomentaryHops));
+    }
+    if (k + 1U >= kShortTermHops) {
+      emitShortTerm(window_energy(kShortTermHops));
     }
-  } else {
-    max_short_term_ms = mean_square;
   }
 
-  // Phase 2 deterministic LUFS proxy (not full EBU R128)
-  if (mean_square > 0.0) {
-    out.integrated_lufs = -0.691 + 10.0 * std::log10(mean_square);
+  max_momentary_energy_ = std::max(max_momentary_energy_, later.max_momentary_energy_);
+  max_short_term_energy_ = std::max(max_short_term_energy_, later.max_short_term_energy_);
+  momentary_windows_ += later.momentary_windows_;
+  gating_.merge(later.gating_);
+  short_term_gating_.merge(later.short_term_gating_);
+  short_term_series_.insert(short_term_series_.end(), later.short_term_series_.begin(),
+                            later.short_term_series_.end());
+
+  const std::size_t later_end = later.first_hop_ + later.hop_count_;
+  for (std::size_t h = later_end - std::min(later.hop_count_, kShortTermHops); h < later_end; ++h) {
+    ring_[h % kShortTermHops] = later.ring_[h % kShortTermHops];
   }
-  if (max_short_term_ms > 0.0) {
-    out.short_term_lufs = -0.691 + 10.0 * std::log10(max_short_term_ms);
+  for (std::size_t j = 0; hop_count_ + j < head_.size() && j < later.hop_count_; ++j) {
+    head_[hop_count_ + j] = later.head_[j];
   }
-  if (out.short_term_lufs.has_value() && out.integrated_lufs.has_value()) {
-    out.loudness_range_lu = *out.short_term_lufs - *out.integrated_lufs;
+  if (hop_count_ == 0U) {
+    first_hop_ = later.first_hop_;
   }
+  hop_count_ += later.hop_count_;
+
+  sum_sq_[0] += later.sum_sq_[0];
+  sum_sq_[1] += later.sum_sq_[1];
+  owned_frames_ += later.owned_frames_;
+  position_ = later.position_;
+  k_state_ = later.k_state_;
+  hop_energy_ = later.hop_energy_;
+  hop_valid_ = later.hop_valid_;
+  momentary_sum_ = later.momentary_sum_;
+  short_term_sum_ = later.short_term_sum_;
+}
 
+LoudnessMetrics LoudnessAccumulator::finalize() {
+  LoudnessMetrics out;
+  if (owned_frames_ == 0) {
+    return out;
+  }
+
+  const double mean_square = (sum_sq_[0] + sum_sq_[1]) / static_cast<double>(owned_frames_);
+  const auto hop_frames = static_cast<double>(hop_frames_);
+
+  // Programs shorter than a window report the window over every complete hop,
+  // or the whole-program mean square when not even one hop completed.
+  const auto fallback = [&](std::size_t window_hops) {
+    const std::size_t hops = std::min(hop_count_, window_hops);
+    if (hops == 0U) {
+      return mean_square;
+    }
+    return ringSum(first_hop_ + hop_count_ - 1U, hops) / (static_cast<double>(hops) * hop_frames);
+  };
+  const double max_momentary_ms =
+      momentary_windows_ > 0U
+          ? max_momentary_energy_ / (static_cast<double>(kMomentaryHops) * hop_frames)
+          : fallback(kMomentaryHops);
+  const double max_short_term_ms =
+      !short_term_series_.empty()
+          ? max_short_term_energy_ / (static_cast<double>(kShortTermHops) * hop_frames)
+          : fallback(kShortTermHops);
+
+  // Gated per BS.1770-4; programs shorter than one gating block report their
+  // ungated K-weighted level.
+  out.integrated_lufs =
+      momentary_windows_ > 0U ? gating_.gatedLufs(kIntegratedRelativeGateLu) : mean_square_to_lufs(mean_square);
+  out.short_term_lufs = mean_square_to_lufs(max_short_term_ms);
+  out.momentary_max_lufs = mean_square_to_lufs(max_momentary_ms);
+  out.loudness_range_lu = short_term_gating_.gatedRangeLu(kRangeRelativeGateLu, kRangeLowQuantile, kRangeHighQuantile);
+
+  out.short_term_series_lufs.reserve(short_term_series_.size());
+  for (double window_energy : short_term_series_) {
+    out.short_term_series_lufs.push_back(
+        mean_square_to_lufs(window_energy / (static_cast<double>(kShortTermHops) * hop_frames)));
+  }
   return out;
 }
 
+LoudnessMetrics compute_loudness_interleaved_stereo(const float* interleaved_stereo,
+                                                    std::size_t frame_count,
+                                                    double sample_rate_hz) {
+  if (interleaved_stereo == nullptr || frame_count == 0) {
+    return LoudnessMetrics{};
+  }
+
+  LoudnessAccumulator acc;
+  acc.reset(sample_rate_hz);
+  for_each_planar_block(interleaved_stereo, frame_count,
+                        [&](const float* l, const float* r, std::size_t n) { acc.push(l, r, n); });
+  return acc.finalize();
+}
+
+LoudnessMetrics compute_loudness_planar_stereo(const float* left,
+                                               const float* right,
+                                               std::size_t frame_count,
+                                               double sample_rate_hz) {
+  if (left == nullptr || right == nullptr || frame_count == 0) {
+    return LoudnessMetrics{};
+  }
+
+  LoudnessAccumulator acc;
+  acc.reset(sample_rate_hz);
+  for_each_planar_block(left, right, frame_count,
+                        [&](const float* l, const float* r, std::size_t n) { acc.push(l, r, n); });
+  return acc.finalize();
+}
+
 }  // namespace aifr3d
@@ -0,0 +1,96 @@
+#include "aifr3d/multirate.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace aifr3d {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kKaiserBeta = 8.0;
+constexpr std::size_t kCentre = HalfBandCascade::kTaps / 2U;
+// Nonzero side taps: offsets 1, 3, 5, ... from the centre.
+constexpr std::size_t kSideTaps = HalfBandCascade::kSideTaps;
+
+double bessel_i0(double x) {
+  double sum = 1.0;
+  double term = 1.0;
+  for (int k = 1; term > 1e-12 * sum; ++k) {
+    const double half = x / (2.0 * static_cast<double>(k));
+    term *= half * half;
+    sum += term;
+  }
+  return sum;
+}
+
+// side[m] weights the samples 2m + 1 either side of the centre; the centre tap
+// is exactly 0.5.
+const std::array<double, kSideTaps>& half_band_side_taps() {
+  static const auto taps = [] {
+    std::array<double, kSideTaps> t{};
+    for (std::size_t m = 0; m < kSideTaps; ++m) {
+      const double u = static_cast<double>(2U * m + 1U);
+      const double r = u / static_cast<double>(kCentre + 1U);
+      const double window = bessel_i0(kKaiserBeta * std::sqrt(1.0 - r * r)) / bessel_i0(kKaiserBeta);
+      t[m] = std::sin(0.5 * kPi * u) / (kPi * u) * window;
+    }
+    return t;
+  }();
+  return taps;
+}
+
+}  // namespace
+
+void HalfBandCascade::reset(int stages) {
+  if (stages < 1 || stages > kMaxStages) {
+    throw std::invalid_argument("HalfBandCascade stages must be in [1, 6]");
+  }
+  stages_ = stages;
+  stage_ = {};
+  side_ = half_band_side_taps();
+}
+
+void HalfBandCascade::startAt(std::size_t first_frame) {
+  std::size_t index = first_frame;
+  for (int k = 0; k < stages_; ++k) {
+    Stage& stage = stage_[static_cast<std::size_t>(k)];
+    stage.window.fill(0.0);
+    stage.next_index = index;
+    // Stage k emits at its even input indices; the first one feeds stage k + 1.
+    index = (index + 1U) / 2U;
+  }
+}
+
+std::size_t HalfBandCascade::process(double* samples, std::size_t count, std::size_t& first_index) {
+  constexpr std::size_t kHistory = kTaps - 1U;
+  for (int k = 0; k < stages_; ++k) {
+    Stage& stage = stage_[static_cast<std::size_t>(k)];
+    first_index = (stage.next_index + 1U) / 2U;
+    std::size_t emitted = 0;
+    for (std::size_t done = 0; done < count;) {
+      const std::size_t n = std::min(kChunk, count - done);
+      std::copy(samples + done, samples + done + n, stage.window.begin() + kHistory);
+      // Input i of the chunk is the newest sample of window[i .. i + kTaps);
+      // only even absolute indices produce an output.
+      for (std::size_t i = (stage.next_index + done) % 2U; i < n; i += 2U) {
+        const double* w = stage.window.data() + i;
+        // Four partial sums keep the adds off one dependency chain.
+        std::array<double, 4> acc{0.5 * w[kCentre], 0.0, 0.0, 0.0};
+        for (std::size_t m = 0; m < kSideTaps; ++m) {
+          acc[m % 4U] += side_[m] * (w[kCentre - 1U - 2U * m] + w[kCentre + 1U + 2U * m]);
+        }
+        samples[emitted++] = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+      }
+      std::copy(stage.window.begin() + static_cast<std::ptrdiff_t>(n),
+                stage.window.begin() + static_cast<std::ptrdiff_t>(n + kHistory), stage.window.begin());
+      done += n;
+    }
+    stage.next_index += count;
+    count = emitted;
+  }
+  return count;
+}
+
+}  // namespace aifr3d
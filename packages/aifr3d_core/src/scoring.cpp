@@ -2,6 +2,8 @@
 
 #include <algorithm>
 #include <cmath>
+#include <string>
+#include <vector>
 
 namespace aifr3d {
 
@@ -29,7 +31,7 @@ double scoreMetric(const MetricDelta& m) {
   }
 }
 
-double average(std::initializer_list<double> vals) {
+double average(const std::vector<double>& vals) {
   double s = 0.0;
   std::size_t n = 0;
   for (double v : vals) {
@@ -39,6 +41,16 @@ double average(std::initializer_list<double> vals) {
   return (n > 0U) ? (s / static_cast<double>(n)) : 0.0;
 }
 
+// Scores of the per-band metrics that have both a value and a target.
+void appendMeasuredBands(const CompareSpectral& bands, std::vector<double>& scores) {
+  for (const MetricDelta* m : {&bands.sub, &bands.low, &bands.lowmid, &bands.mid, &bands.highmid, &bands.high,
+                               &bands.air}) {
+    if (m->mean.has_value()) {
+      scores.push_back(scoreMetric(*m));
+    }
+  }
+}
+
 }  // namespace
 
 ScoreBreakdown computeScore(const BenchmarkCompareResult& compare, const ScoreConfig& config) {
@@ -46,39 +58,59 @@ ScoreBreakdown computeScore(const BenchmarkCompareResult& compare, const ScoreCo
   out.version = config.version;
   out.weights = config.weights;
 
-  const double loudness = average({
-      scoreMetric(compare.loudness.integrated_lufs),
-      scoreMetric(compare.loudness.short_term_lufs),
-      scoreMetric(compare.loudness.loudness_range_lu),
-  });
-
-  const double dynamics = average({
-      scoreMetric(compare.dynamics.peak_dbfs),
-      scoreMetric(compare.dynamics.rms_dbfs),
-      scoreMetric(compare.dynamics.crest_db),
-      scoreMetric(compare.dynamics.dr_proxy_db),
-  });
-
-  const double tonal_balance = average({
-      scoreMetric(compare.spectral.sub),
-      scoreMetric(compare.spectral.low),
-      scoreMetric(compare.spectral.lowmid),
-      scoreMetric(compare.spectral.mid),
-      scoreMetric(compare.spectral.highmid),
-      scoreMetric(compare.spectral.high),
-      scoreMetric(compare.spectral.air),
-  });
-
-  const double stereo = average({
-      scoreMetric(compare.stereo.correlation),
-      scoreMetric(compare.stereo.lr_balance_db),
-      scoreMetric(compare.stereo.width_proxy),
-  });
-
-  out.subscores["loudness"] = loudness;
-  out.subscores["dynamics"] = dynamics;
-  out.subscores["tonal_balance"] = tonal_balance;
-  out.subscores["stereo"] = stereo;
+  // Subscores of skipped metric groups are omitted, so their weight drops out
+  // of the weighted mean instead of pulling it toward the UNKNOWN score.
+  const MetricGroups& groups = compare.compared_groups;
+  std::string skipped;
+  const auto skip = [&](const char* name) { skipped += skipped.empty() ? name : std::string(",") + name; };
+
+  if (groups.loudness) {
+    out.subscores["loudness"] = average({
+        scoreMetric(compare.loudness.integrated_lufs),
+        scoreMetric(compare.loudness.short_term_lufs),
+        scoreMetric(compare.loudness.loudness_range_lu),
+    });
+  } else {
+    skip("loudness");
+  }
+
+  if (groups.dynamics) {
+    out.subscores["dynamics"] = average({
+        scoreMetric(compare.dynamics.peak_dbfs),
+        scoreMetric(compare.dynamics.rms_dbfs),
+        scoreMetric(compare.dynamics.crest_db),
+        scoreMetric(compare.dynamics.dr_proxy_db),
+    });
+  } else {
+    skip("dynamics");
+  }
+
+  if (groups.spectral) {
+    out.subscores["tonal_balance"] = average({
+        scoreMetric(compare.spectral.sub),
+        scoreMetric(compare.spectral.low),
+        scoreMetric(compare.spectral.lowmid),
+        scoreMetric(compare.spectral.mid),
+        scoreMetric(compare.spectral.highmid),
+        scoreMetric(compare.spectral.high),
+        scoreMetric(compare.spectral.air),
+    });
+  } else {
+    skip("tonal_balance");
+  }
+
+  if (groups.stereo) {
+    std::vector<double> scores{
+        scoreMetric(compare.stereo.correlation),
+        scoreMetric(compare.stereo.lr_balance_db),
+        scoreMetric(compare.stereo.width_proxy),
+    };
+    appendMeasuredBands(compare.stereo.band_correlation, scores);
+    appendMeasuredBands(compare.stereo.band_width, scores);
+    out.subscores["stereo"] = average(scores);
+  } else {
+    skip("stereo");
+  }
 
   double total_weight = 0.0;
   double weighted_sum = 0.0;
@@ -98,6 +130,9 @@ ScoreBreakdown computeScore(const BenchmarkCompareResult& compare, const ScoreCo
                       ",slightly_off:" + std::to_string(compare.summary.slightly_off_count) +
                       ",needs_attention:" + std::to_string(compare.summary.needs_attention_count) +
                       ",unknown:" + std::to_string(compare.summary.unknown_count));
+  if (!skipped.empty()) {
+    out.notes.push_back("skipped_subscores=" + skipped);
+  }
 
   return out;
 }
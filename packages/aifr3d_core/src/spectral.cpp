@@ -1,25 +1,20 @@
 #include "aifr3d/spectral.hpp"
 
-#include "aifr3d/fft.hpp"
+#include "aifr3d/block.hpp"
+#include "aifr3d/thread_pool.hpp"
 
+#include <algorithm>
 #include <array>
 #include <cmath>
-#include <vector>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
 
 namespace aifr3d {
 
 namespace {
 
-struct BandDef {
-  double lo;
-  double hi;
-};
-
-constexpr std::array<BandDef, 7> kBands{{
-    {20.0, 60.0}, {60.0, 200.0}, {200.0, 500.0}, {500.0, 2000.0},
-    {2000.0, 6000.0}, {6000.0, 12000.0}, {12000.0, 20000.0},
-}};
-
 std::optional<double> energy_to_db(double e) {
   if (!(e > 0.0)) {
     return std::nullopt;
@@ -27,69 +22,453 @@ std::optional<double> energy_to_db(double e) {
   return 10.0 * std::log10(e);
 }
 
-}  // namespace
+// SpectralBands fields in kBroad7 band order.
+constexpr std::array<std::optional<double> SpectralBands::*, 7> kBroadBands{
+    &SpectralBands::sub,     &SpectralBands::low,  &SpectralBands::lowmid, &SpectralBands::mid,
+    &SpectralBands::highmid, &SpectralBands::high, &SpectralBands::air};
 
-SpectralBands compute_spectral_bands_interleaved_stereo(const float* interleaved_stereo,
-                                                        std::size_t frame_count,
-                                                        double sample_rate_hz) {
+SpectralBands bands_from_energy(const std::array<double, 7>& energy) {
   SpectralBands out;
-  if (interleaved_stereo == nullptr || frame_count == 0 || !(sample_rate_hz > 0.0)) {
-    return out;
+  for (std::size_t bi = 0; bi < kBroadBands.size(); ++bi) {
+    out.*kBroadBands[bi] = energy_to_db(energy[bi]);
   }
+  return out;
+}
 
-  const std::size_t fft_size = 1024;
-  const std::size_t hop = 512;
-  if (frame_count < fft_size) {
-    return out;
+// Mean of seven summed band energies over `windows` frames.
+SpectralBands mean_bands(const double* accum, std::size_t windows) {
+  std::array<double, 7> energy{};
+  for (std::size_t bi = 0; bi < energy.size(); ++bi) {
+    energy[bi] = accum[bi] / static_cast<double>(windows);
   }
+  return bands_from_energy(energy);
+}
+
+// Runs one SpectralAccumulator per segment on `pool` and folds them left to
+// right. `blocks(first, count, fn)` feeds frames [first, first + count).
+// Segment boundaries depend only on frame_count, and each finished segment is
+// folded (and its scratch released) as soon as every earlier one is, so at
+// most kMaxParallelSpectralSegments accumulators exist for any input length.
+template <typename BlockSource>
+SpectralBands analyze_segments(ThreadPool& pool,
+                               std::size_t frame_count,
+                               double sample_rate_hz,
+                               const BlockSource& blocks) {
+  const std::size_t even_split = (frame_count + kMaxParallelSpectralSegments - 1U) / kMaxParallelSpectralSegments;
+  const std::size_t segment_frames = std::max(kParallelSpectralSegmentFrames, even_split);
+  const std::size_t segment_count = (frame_count + segment_frames - 1U) / segment_frames;
+  const std::size_t context_frames = SpectralAccumulator::contextFramesFor(SpectralAccumulator::kDefaultFftSize);
+  std::vector<SpectralAccumulator> partials(segment_count);
+  std::vector<char> finished(segment_count, 0);
+  std::size_t next_to_fold = 0;
+  std::mutex fold_mutex;
+
+  const auto run_segment = [&](std::size_t index) {
+    const std::size_t owned_start = index * segment_frames;
+    const std::size_t owned_end = std::min(frame_count, owned_start + segment_frames);
+    const std::size_t context_start = owned_start - std::min(owned_start, context_frames);
+    SpectralAccumulator& acc = partials[index];
+    acc.reset(sample_rate_hz);
+    acc.startAt(context_start);
+    blocks(context_start, owned_start - context_start,
+           [&](const float* l, const float* r, std::size_t n) { acc.prime(l, r, n); });
+    blocks(owned_start, owned_end - owned_start,
+           [&](const float* l, const float* r, std::size_t n) { acc.push(l, r, n); });
+
+    const std::lock_guard<std::mutex> lock(fold_mutex);
+    finished[index] = 1;
+    for (; next_to_fold < segment_count && finished[next_to_fold] != 0; ++next_to_fold) {
+      if (next_to_fold > 0U) {
+        partials.front().merge(partials[next_to_fold]);
+        partials[next_to_fold] = SpectralAccumulator{};
+      }
+    }
+  };
+  // std::cref keeps the std::function from copying the closure to the heap.
+  pool.parallelFor(segment_count, std::cref(run_segment));
+  return partials.front().finalize();
+}
 
-  std::array<double, 7> accum{};
-  std::size_t windows = 0;
-  std::vector<Complex> buf(fft_size);
+}  // namespace
 
-  for (std::size_t start = 0; start + fft_size <= frame_count; start += hop) {
-    for (std::size_t i = 0; i < fft_size; ++i) {
-      const std::size_t idx = (start + i) * 2U;
-      const double l = static_cast<double>(interleaved_stereo[idx]);
-      const double r = static_cast<double>(interleaved_stereo[idx + 1U]);
-      const double mono = 0.5 * (l + r);
-      const double w = 0.5 * (1.0 - std::cos((2.0 * std::acos(-1.0) * static_cast<double>(i)) /
-                                             static_cast<double>(fft_size - 1U)));
-      buf[i] = Complex(mono * w, 0.0);
+void SpectralAccumulator::Stft::reset(std::size_t fft_size,
+                                     double sample_rate_hz,
+                                     const std::vector<BandLayout>& extra_layouts,
+                                     bool with_channels) {
+  const std::size_t hop = fft_size / 2U;
+  plans.clear();
+  plans.push_back(SpectralPlan::get(fft_size, hop, sample_rate_hz, BandLayout::kBroad7));
+  for (const BandLayout layout : extra_layouts) {
+    plans.push_back(SpectralPlan::get(fft_size, hop, sample_rate_hz, layout));
+  }
+  channels = with_channels;
+  first_frame_start = 0;
+  pending.assign(fft_size, 0.0);
+  filled = 0;
+  frame.assign(fft_size, 0.0);
+  spectrum.assign(channels ? fft_size : fft_size / 2U + 1U, Complex(0.0, 0.0));
+  power.assign(fft_size / 2U + 1U, 0.0);
+  accum.resize(plans.size());
+  for (std::size_t p = 0; p < plans.size(); ++p) {
+    accum[p].assign(plans[p]->bandCount(), 0.0);
+  }
+  if (channels) {
+    pending_right.assign(fft_size, 0.0);
+    for (std::size_t c = 0; c < channel_power.size(); ++c) {
+      channel_power[c].assign(fft_size / 2U + 1U, 0.0);
+      channel_accum[c].assign(plans.front()->bandCount(), 0.0);
     }
+  }
+  windows = 0;
+}
+
+void SpectralAccumulator::Stft::startAt(std::size_t first_index) {
+  const std::size_t hop = plans.front()->hop();
+  first_frame_start = ((first_index + hop - 1U) / hop) * hop;
+  filled = 0;
+}
 
-    fft_inplace(buf);
-
-    const std::size_t bins = fft_size / 2U;
-    for (std::size_t b = 1; b < bins; ++b) {
-      const double freq = static_cast<double>(b) * sample_rate_hz / static_cast<double>(fft_size);
-      const double mag2 = std::norm(buf[b]);
-      for (std::size_t bi = 0; bi < kBands.size(); ++bi) {
-        if (freq >= kBands[bi].lo && freq < kBands[bi].hi) {
-          accum[bi] += mag2;
-          break;
-        }
+void SpectralAccumulator::Stft::add(const double* samples,
+                                     const double* right,
+                                     std::size_t count,
+                                     std::size_t first_index,
+                                     bool owned) {
+  std::size_t i = 0;
+  if (first_index < first_frame_start) {
+    i = std::min(count, first_frame_start - first_index);
+  }
+  const std::size_t hop = plans.front()->hop();
+  while (i < count) {
+    const std::size_t n = std::min(count - i, pending.size() - filled);
+    std::copy(samples + i, samples + i + n, pending.begin() + static_cast<std::ptrdiff_t>(filled));
+    if (channels) {
+      std::copy(right + i, right + i + n, pending_right.begin() + static_cast<std::ptrdiff_t>(filled));
+    }
+    filled += n;
+    i += n;
+    if (filled == pending.size()) {
+      // Frames completing inside the primed context belong to the previous chunk.
+      if (owned) {
+        processFrame();
+      }
+      std::copy(pending.begin() + static_cast<std::ptrdiff_t>(hop), pending.end(), pending.begin());
+      if (channels) {
+        std::copy(pending_right.begin() + static_cast<std::ptrdiff_t>(hop), pending_right.end(),
+                  pending_right.begin());
       }
+      filled = pending.size() - hop;
     }
-    ++windows;
+  }
+}
+
+void SpectralAccumulator::Stft::processFrame() {
+  if (channels) {
+    processChannelFrame();
+    return;
+  }
+  const SpectralPlan& plan = *plans.front();
+  const std::vector<double>& window = plan.window();
+  for (std::size_t i = 0; i < frame.size(); ++i) {
+    frame[i] = pending[i] * window[i];
   }
 
-  if (windows == 0) {
+  plan.fft().forwardReal(frame.data(), spectrum.data());
+  for (std::size_t b = 0; b < power.size(); ++b) {
+    power[b] = std::norm(spectrum[b]);
+  }
+  for (std::size_t p = 0; p < plans.size(); ++p) {
+    plans[p]->accumulateBands(power.data(), accum[p].data());
+  }
+  ++windows;
+}
+
+void SpectralAccumulator::Stft::processChannelFrame() {
+  const SpectralPlan& plan = *plans.front();
+  const std::vector<double>& window = plan.window();
+  const std::size_t n = pending.size();
+  for (std::size_t i = 0; i < n; ++i) {
+    spectrum[i] = Complex(pending[i] * window[i], pending_right[i] * window[i]);
+  }
+
+  // Z = L + iR with L and R Hermitian, so L[k] = (Z[k] + conj(Z[n - k])) / 2
+  // and R[k] = (Z[k] - conj(Z[n - k])) / 2i.
+  plan.fft().forward(spectrum.data());
+  for (std::size_t k = 0; k < power.size(); ++k) {
+    const Complex z = spectrum[k];
+    const Complex mirror = std::conj(spectrum[(n - k) & (n - 1U)]);
+    const Complex left = 0.5 * (z + mirror);
+    const Complex right = Complex(0.0, -0.5) * (z - mirror);
+    power[k] = std::norm(0.5 * (left + right));
+    channel_power[0][k] = std::norm(left);
+    channel_power[1][k] = std::norm(right);
+    channel_power[2][k] = std::norm(0.5 * (left - right));
+    channel_power[3][k] = left.real() * right.real() + left.imag() * right.imag();
+  }
+  for (std::size_t p = 0; p < plans.size(); ++p) {
+    plans[p]->accumulateBands(power.data(), accum[p].data());
+  }
+  for (std::size_t c = 0; c < channel_power.size(); ++c) {
+    plan.accumulateBands(channel_power[c].data(), channel_accum[c].data());
+  }
+  ++windows;
+}
+
+void SpectralAccumulator::Stft::merge(const Stft& later) {
+  for (std::size_t p = 0; p < accum.size(); ++p) {
+    for (std::size_t bi = 0; bi < accum[p].size(); ++bi) {
+      accum[p][bi] += later.accum[p][bi];
+    }
+  }
+  if (channels) {
+    for (std::size_t c = 0; c < channel_accum.size(); ++c) {
+      for (std::size_t bi = 0; bi < channel_accum[c].size(); ++bi) {
+        channel_accum[c][bi] += later.channel_accum[c][bi];
+      }
+    }
+  }
+  windows += later.windows;
+}
+
+int SpectralAccumulator::lowPathStagesFor(double sample_rate_hz) {
+  int stages = 0;
+  while (stages < HalfBandCascade::kMaxStages &&
+         sample_rate_hz / static_cast<double>(2 << stages) >= kLowPathMinRateHz) {
+    ++stages;
+  }
+  return stages;
+}
+
+std::size_t SpectralAccumulator::lowPathContextFramesFor(double sample_rate_hz) {
+  const int stages = lowPathStagesFor(sample_rate_hz);
+  if (stages == 0) {
+    return 0;
+  }
+  return (kLowFftSize << static_cast<unsigned>(stages)) + HalfBandCascade::historyFramesFor(stages);
+}
+
+void SpectralAccumulator::reset(double sample_rate_hz,
+                                std::size_t fft_size,
+                                const std::vector<BandLayout>& extra_layouts,
+                                bool low_path,
+                                bool channels) {
+  if (fft_size < kMinFftSize || fft_size > kMaxFftSize || (fft_size & (fft_size - 1U)) != 0U) {
+    throw std::invalid_argument("fft_size must be a power of two in [256, 16384]");
+  }
+  sample_rate_hz_ = sample_rate_hz;
+  position_ = 0;
+  low_path_ = false;
+  if (!(sample_rate_hz > 0.0)) {
+    full_.plans.clear();
+    full_.channels = false;
+    full_.windows = 0;
+    return;
+  }
+  full_.reset(fft_size, sample_rate_hz, extra_layouts, channels);
+  mono_.assign(kAnalysisBlockFrames, 0.0);
+  if (channels) {
+    left_.assign(kAnalysisBlockFrames, 0.0);
+    right_.assign(kAnalysisBlockFrames, 0.0);
+  }
+
+  const int stages = low_path ? lowPathStagesFor(sample_rate_hz) : 0;
+  if (stages > 0) {
+    low_path_ = true;
+    cascade_.reset(stages);
+    low_.reset(kLowFftSize, sample_rate_hz / static_cast<double>(1 << stages), extra_layouts, false);
+    double full_norm = 0.0;
+    for (const double w : full_.plans.front()->window()) {
+      full_norm += w * w;
+    }
+    double low_norm = 0.0;
+    for (const double w : low_.plans.front()->window()) {
+      low_norm += w * w;
+    }
+    low_scale_ = (static_cast<double>(fft_size) * full_norm) / (static_cast<double>(kLowFftSize) * low_norm);
+  }
+}
+
+void SpectralAccumulator::startAt(std::size_t first_frame) {
+  position_ = first_frame;
+  full_.startAt(first_frame);
+  if (low_path_) {
+    cascade_.startAt(first_frame);
+    // The first decimated sample the cascade can emit from here.
+    const std::size_t step = std::size_t{1} << static_cast<unsigned>(cascade_.stages());
+    low_.startAt((first_frame + step - 1U) / step);
+  }
+}
+
+void SpectralAccumulator::consume(const float* left, const float* right, std::size_t frames, bool owned) {
+  for (std::size_t done = 0; done < frames;) {
+    const std::size_t n = std::min(mono_.size(), frames - done);
+    for (std::size_t i = 0; i < n; ++i) {
+      mono_[i] = 0.5 * (static_cast<double>(left[done + i]) + static_cast<double>(right[done + i]));
+    }
+    if (full_.channels) {
+      for (std::size_t i = 0; i < n; ++i) {
+        left_[i] = static_cast<double>(left[done + i]);
+        right_[i] = static_cast<double>(right[done + i]);
+      }
+      full_.add(left_.data(), right_.data(), n, position_, owned);
+    } else {
+      full_.add(mono_.data(), nullptr, n, position_, owned);
+    }
+    if (low_path_) {
+      std::size_t first_index = 0;
+      const std::size_t decimated = cascade_.process(mono_.data(), n, first_index);
+      low_.add(mono_.data(), nullptr, decimated, first_index, owned);
+    }
+    position_ += n;
+    done += n;
+  }
+}
+
+void SpectralAccumulator::prime(const float* left, const float* right, std::size_t frames) {
+  if (!(sample_rate_hz_ > 0.0)) {
+    return;
+  }
+  consume(left, right, frames, false);
+}
+
+void SpectralAccumulator::push(const float* left, const float* right, std::size_t frames) {
+  if (!(sample_rate_hz_ > 0.0)) {
+    return;
+  }
+  consume(left, right, frames, true);
+}
+
+void SpectralAccumulator::merge(const SpectralAccumulator& later) {
+  full_.merge(later.full_);
+  if (low_path_) {
+    low_.merge(later.low_);
+  }
+}
+
+double SpectralAccumulator::bandEnergy(std::size_t p, std::size_t band) const {
+  if (low_path_ && low_.windows > 0U && full_.plans[p]->upperHz()[band] <= kLowPathCrossoverHz) {
+    return low_.accum[p][band] / static_cast<double>(low_.windows) * low_scale_;
+  }
+  return full_.accum[p][band] / static_cast<double>(full_.windows);
+}
+
+SpectralBands SpectralAccumulator::finalize() {
+  if (full_.windows == 0) {
+    return SpectralBands{};
+  }
+
+  std::array<double, 7> energy{};
+  for (std::size_t bi = 0; bi < energy.size(); ++bi) {
+    energy[bi] = bandEnergy(0, bi);
+  }
+  return bands_from_energy(energy);
+}
+
+std::optional<ChannelSpectra> SpectralAccumulator::channelSpectra() const {
+  if (!full_.channels) {
+    return std::nullopt;
+  }
+  ChannelSpectra out;
+  if (full_.windows == 0) {
     return out;
   }
+  out.left = mean_bands(full_.channel_accum[0].data(), full_.windows);
+  out.right = mean_bands(full_.channel_accum[1].data(), full_.windows);
+  out.mid = mean_bands(full_.accum[0].data(), full_.windows);
+  out.side = mean_bands(full_.channel_accum[2].data(), full_.windows);
+  return out;
+}
 
-  for (double& v : accum) {
-    v /= static_cast<double>(windows);
+void SpectralAccumulator::addBandStereo(StereoMetrics& stereo) const {
+  if (!full_.channels || full_.windows == 0) {
+    return;
+  }
+  for (std::size_t bi = 0; bi < kBroadBands.size(); ++bi) {
+    const double ll = full_.channel_accum[0][bi];
+    const double rr = full_.channel_accum[1][bi];
+    const double lr = full_.channel_accum[3][bi];
+    const double denom = std::sqrt(ll * rr);
+    if (denom > 0.0) {
+      stereo.band_correlation.*kBroadBands[bi] = std::clamp(lr / denom, -1.0, 1.0);
+    }
+    const double rms_mid = std::sqrt(full_.accum[0][bi]);
+    const double rms_side = std::sqrt(full_.channel_accum[2][bi]);
+    if (rms_mid + rms_side > 0.0) {
+      stereo.band_width.*kBroadBands[bi] = std::clamp(rms_side / (rms_mid + rms_side), 0.0, 1.0);
+    }
   }
+}
 
-  out.sub = energy_to_db(accum[0]);
-  out.low = energy_to_db(accum[1]);
-  out.lowmid = energy_to_db(accum[2]);
-  out.mid = energy_to_db(accum[3]);
-  out.highmid = energy_to_db(accum[4]);
-  out.high = energy_to_db(accum[5]);
-  out.air = energy_to_db(accum[6]);
+std::vector<BandSpectrum> SpectralAccumulator::bandSpectra() const {
+  std::vector<BandSpectrum> out;
+  for (std::size_t p = 1; p < full_.plans.size(); ++p) {
+    const SpectralPlan& plan = *full_.plans[p];
+    BandSpectrum spectrum;
+    spectrum.layout = plan.layout();
+    spectrum.lower_hz = plan.lowerHz();
+    spectrum.upper_hz = plan.upperHz();
+    spectrum.energy_db.reserve(plan.bandCount());
+    for (std::size_t bi = 0; bi < plan.bandCount(); ++bi) {
+      spectrum.energy_db.push_back(full_.windows > 0U ? energy_to_db(bandEnergy(p, bi)) : std::nullopt);
+    }
+    out.push_back(std::move(spectrum));
+  }
   return out;
 }
 
+SpectralBands compute_spectral_bands_interleaved_stereo(const float* interleaved_stereo,
+                                                        std::size_t frame_count,
+                                                        double sample_rate_hz) {
+  if (interleaved_stereo == nullptr || frame_count == 0 || !(sample_rate_hz > 0.0)) {
+    return SpectralBands{};
+  }
+
+  SpectralAccumulator acc;
+  acc.reset(sample_rate_hz);
+  for_each_planar_block(interleaved_stereo, frame_count,
+                        [&](const float* l, const float* r, std::size_t n) { acc.push(l, r, n); });
+  return acc.finalize();
+}
+
+SpectralBands compute_spectral_bands_planar_stereo(const float* left,
+                                                   const float* right,
+                                                   std::size_t frame_count,
+                                                   double sample_rate_hz) {
+  if (left == nullptr || right == nullptr || frame_count == 0 || !(sample_rate_hz > 0.0)) {
+    return SpectralBands{};
+  }
+
+  SpectralAccumulator acc;
+  acc.reset(sample_rate_hz);
+  for_each_planar_block(left, right, frame_count,
+                        [&](const float* l, const float* r, std::size_t n) { acc.push(l, r, n); });
+  return acc.finalize();
+}
+
+SpectralBands compute_spectral_bands_interleaved_stereo(const float* interleaved_stereo,
+                                                        std::size_t frame_count,
+                                                        double sample_rate_hz,
+                                                        ThreadPool& pool) {
+  if (interleaved_stereo == nullptr || frame_count == 0 || !(sample_rate_hz > 0.0)) {
+    return SpectralBands{};
+  }
+
+  return analyze_segments(pool, frame_count, sample_rate_hz, [&](std::size_t first, std::size_t count, const auto& fn) {
+    for_each_planar_block(interleaved_stereo + first * 2U, count, fn);
+  });
+}
+
+SpectralBands compute_spectral_bands_planar_stereo(const float* left,
+                                                   const float* right,
+                                                   std::size_t frame_count,
+                                                   double sample_rate_hz,
+                                                   ThreadPool& pool) {
+  if (left == nullptr || right == nullptr || frame_count == 0 || !(sample_rate_hz > 0.0)) {
+    return SpectralBands{};
+  }
+
+  return analyze_segments(pool, frame_count, sample_rate_hz, [&](std::size_t first, std::size_t count, const auto& fn) {
+    for_each_planar_block(left + first, right + first, count, fn);
+  });
+}
+
 }  // namespace aifr3d
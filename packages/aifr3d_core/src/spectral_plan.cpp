@@ -0,0 +1,167 @@
+#include "aifr3d/spectral_plan.hpp"
+
+#include "aifr3d/simd.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+namespace aifr3d {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+using Edges = std::vector<std::pair<double, double>>;
+
+constexpr std::array<double, 8> kBroad7Edges{20.0, 60.0, 200.0, 500.0, 2000.0, 6000.0, 12000.0, 20000.0};
+
+constexpr std::array<double, 25> kBarkEdges{0.0,    100.0,  200.0,  300.0,  400.0,  510.0,  630.0,
+                                            770.0,  920.0,  1080.0, 1270.0, 1480.0, 1720.0, 2000.0,
+                                            2320.0, 2700.0, 3150.0, 3700.0, 4400.0, 5300.0, 6400.0,
+                                            7700.0, 9500.0, 12000.0, 15500.0};
+
+// Base-2 bands centred on 1000 * 2^(n / per_octave) for n in [first, last].
+Edges fractional_octave_edges(int per_octave, int first, int last) {
+  Edges edges;
+  const double half = 1.0 / (2.0 * static_cast<double>(per_octave));
+  for (int n = first; n <= last; ++n) {
+    const double centre = 1000.0 * std::exp2(static_cast<double>(n) / static_cast<double>(per_octave));
+    edges.emplace_back(centre * std::exp2(-half), centre * std::exp2(half));
+  }
+  return edges;
+}
+
+double erb_number(double hz) { return 21.4 * std::log10(1.0 + 0.00437 * hz); }
+double erb_number_to_hz(double erb) { return (std::pow(10.0, erb / 21.4) - 1.0) / 0.00437; }
+
+Edges erb_edges() {
+  Edges edges;
+  const double first = erb_number(20.0);
+  const double last = erb_number(20000.0);
+  for (double e = first; e < last; e += 1.0) {
+    edges.emplace_back(erb_number_to_hz(e), std::min(20000.0, erb_number_to_hz(e + 1.0)));
+  }
+  return edges;
+}
+
+template <std::size_t N>
+Edges adjacent_edges(const std::array<double, N>& bounds) {
+  Edges edges;
+  for (std::size_t i = 0; i + 1U < N; ++i) {
+    edges.emplace_back(bounds[i], bounds[i + 1U]);
+  }
+  return edges;
+}
+
+Edges layout_edges(BandLayout layout) {
+  switch (layout) {
+    case BandLayout::kThirdOctave:
+      return fractional_octave_edges(3, -17, 13);
+    case BandLayout::kSixthOctave:
+      return fractional_octave_edges(6, -34, 26);
+    case BandLayout::kBark:
+      return adjacent_edges(kBarkEdges);
+    case BandLayout::kErb:
+      return erb_edges();
+    case BandLayout::kBroad7:
+      break;
+  }
+  return adjacent_edges(kBroad7Edges);
+}
+
+}  // namespace
+
+SpectralPlan::SpectralPlan(std::size_t fft_size, std::size_t hop, double sample_rate_hz, BandLayout layout)
+    : fft_size_(fft_size), hop_(hop), sample_rate_hz_(sample_rate_hz), layout_(layout) {
+  if (fft_size < 4U || (fft_size & (fft_size - 1U)) != 0U) {
+    throw std::invalid_argument("SpectralPlan fft_size must be a power of two >= 4");
+  }
+  if (!(sample_rate_hz > 0.0)) {
+    throw std::invalid_argument("SpectralPlan sample_rate_hz must be positive");
+  }
+  fft_ = FftPlan<double>::forSize(fft_size);
+
+  window_.resize(fft_size);
+  for (std::size_t i = 0; i < fft_size; ++i) {
+    window_[i] = 0.5 * (1.0 - std::cos((2.0 * kPi * static_cast<double>(i)) / static_cast<double>(fft_size - 1U)));
+  }
+
+  const Edges edges = layout_edges(layout);
+  const std::size_t bins = fft_size / 2U;
+  const double bin_hz = sample_rate_hz / static_cast<double>(fft_size);
+  band_of_bin_.assign(bins + 1U, kNoBand);
+  for (std::size_t bi = 0; bi < edges.size(); ++bi) {
+    const auto [lo, hi] = edges[bi];
+    lower_hz_.push_back(lo);
+    upper_hz_.push_back(hi);
+    BandWeights band;
+    band.offset = weights_.size();
+    for (std::size_t b = 1; b < bins; ++b) {
+      const double freq = static_cast<double>(b) * sample_rate_hz / static_cast<double>(fft_size);
+      double weight = 0.0;
+      if (layout == BandLayout::kBroad7) {
+        weight = freq >= lo && freq < hi ? 1.0 : 0.0;
+      } else {
+        const double overlap = std::min(hi, freq + 0.5 * bin_hz) - std::max(lo, freq - 0.5 * bin_hz);
+        weight = std::max(0.0, overlap) / bin_hz;
+      }
+      if (freq >= lo && freq < hi) {
+        band_of_bin_[b] = static_cast<std::uint16_t>(bi);
+      }
+      if (weight <= 0.0) {
+        continue;
+      }
+      if (band.begin == band.end) {
+        band.begin = b;
+      }
+      band.end = b + 1U;
+      weights_.push_back(weight);
+    }
+    bands_.push_back(band);
+  }
+}
+
+std::shared_ptr<const SpectralPlan> SpectralPlan::get(std::size_t fft_size,
+                                                      std::size_t hop,
+                                                      double sample_rate_hz,
+                                                      BandLayout layout) {
+  using Key = std::tuple<std::size_t, std::size_t, double, BandLayout>;
+  static std::mutex mutex;
+  static std::map<Key, std::shared_ptr<const SpectralPlan>> plans;
+  const Key key{fft_size, hop, sample_rate_hz, layout};
+  const std::lock_guard<std::mutex> lock(mutex);
+  const auto it = plans.find(key);
+  if (it != plans.end()) {
+    return it->second;
+  }
+  auto plan = std::make_shared<const SpectralPlan>(fft_size, hop, sample_rate_hz, layout);
+  plans.emplace(key, plan);
+  return plan;
+}
+
+void SpectralPlan::accumulateBands(const double* power, double* band_energy) const {
+  for (std::size_t bi = 0; bi < bands_.size(); ++bi) {
+    const BandWeights& band = bands_[bi];
+    const double* w = weights_.data() + band.offset;
+    const double* p = power + band.begin;
+    const std::size_t n = band.end - band.begin;
+    simd::Double2 acc = simd::Double2::zero();
+    std::size_t j = 0;
+    for (; j + 2U <= n; j += 2U) {
+      acc = acc + simd::Double2::load(w + j) * simd::Double2::load(p + j);
+    }
+    double sum = acc.sum();
+    for (; j < n; ++j) {
+      sum += w[j] * p[j];
+    }
+    band_energy[bi] += sum;
+  }
+}
+
+}  // namespace aifr3d
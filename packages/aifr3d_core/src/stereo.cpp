@@ -1,59 +1,70 @@
 #include "aifr3d/stereo.hpp"
 
+#include "aifr3d/block.hpp"
+
 #include <algorithm>
 #include <cmath>
 
 namespace aifr3d {
 
-StereoMetrics compute_stereo_metrics_interleaved_stereo(const float* interleaved_stereo,
-                                                        std::size_t frame_count) {
-  StereoMetrics out;
-  if (interleaved_stereo == nullptr || frame_count == 0) {
-    return out;
-  }
+void StereoAccumulator::reset() {
+  *this = StereoAccumulator{};
+}
 
-  double sum_l = 0.0;
-  double sum_r = 0.0;
-  double sum_ll = 0.0;
-  double sum_rr = 0.0;
-  double sum_lr = 0.0;
-  double sum_mid2 = 0.0;
-  double sum_side2 = 0.0;
-
-  for (std::size_t i = 0; i < frame_count; ++i) {
-    const double l = static_cast<double>(interleaved_stereo[i * 2U]);
-    const double r = static_cast<double>(interleaved_stereo[i * 2U + 1U]);
-    sum_l += l;
-    sum_r += r;
-    sum_ll += l * l;
-    sum_rr += r * r;
-    sum_lr += l * r;
+void StereoAccumulator::push(const float* left, const float* right, std::size_t frames) {
+  for (std::size_t i = 0; i < frames; ++i) {
+    const double l = static_cast<double>(left[i]);
+    const double r = static_cast<double>(right[i]);
+    sum_l_ += l;
+    sum_r_ += r;
+    sum_ll_ += l * l;
+    sum_rr_ += r * r;
+    sum_lr_ += l * r;
     const double mid = 0.5 * (l + r);
     const double side = 0.5 * (l - r);
-    sum_mid2 += mid * mid;
-    sum_side2 += side * side;
+    sum_mid2_ += mid * mid;
+    sum_side2_ += side * side;
+  }
+  frames_ += frames;
+}
+
+void StereoAccumulator::merge(const StereoAccumulator& later) {
+  frames_ += later.frames_;
+  sum_l_ += later.sum_l_;
+  sum_r_ += later.sum_r_;
+  sum_ll_ += later.sum_ll_;
+  sum_rr_ += later.sum_rr_;
+  sum_lr_ += later.sum_lr_;
+  sum_mid2_ += later.sum_mid2_;
+  sum_side2_ += later.sum_side2_;
+}
+
+StereoMetrics StereoAccumulator::finalize() {
+  StereoMetrics out;
+  if (frames_ == 0) {
+    return out;
   }
 
-  const double n = static_cast<double>(frame_count);
-  const double mean_l = sum_l / n;
-  const double mean_r = sum_r / n;
-  const double var_l = std::max(0.0, (sum_ll / n) - mean_l * mean_l);
-  const double var_r = std::max(0.0, (sum_rr / n) - mean_r * mean_r);
-  const double cov = (sum_lr / n) - mean_l * mean_r;
+  const double n = static_cast<double>(frames_);
+  const double mean_l = sum_l_ / n;
+  const double mean_r = sum_r_ / n;
+  const double var_l = std::max(0.0, (sum_ll_ / n) - mean_l * mean_l);
+  const double var_r = std::max(0.0, (sum_rr_ / n) - mean_r * mean_r);
+  const double cov = (sum_lr_ / n) - mean_l * mean_r;
   const double denom = std::sqrt(var_l * var_r);
 
   if (denom > 1e-15) {
     out.correlation = std::clamp(cov / denom, -1.0, 1.0);
   }
 
-  const double rms_l = std::sqrt(sum_ll / n);
-  const double rms_r = std::sqrt(sum_rr / n);
+  const double rms_l = std::sqrt(sum_ll_ / n);
+  const double rms_r = std::sqrt(sum_rr_ / n);
   if (rms_l > 0.0 && rms_r > 0.0) {
     out.lr_balance_db = 20.0 * std::log10(rms_l / rms_r);
   }
 
-  const double rms_mid = std::sqrt(sum_mid2 / n);
-  const double rms_side = std::sqrt(sum_side2 / n);
+  const double rms_mid = std::sqrt(sum_mid2_ / n);
+  const double rms_side = std::sqrt(sum_side2_ / n);
   const double denom_width = rms_mid + rms_side;
   if (denom_width > 0.0) {
     out.width_proxy = std::clamp(rms_side / denom_width, 0.0, 1.0);
@@ -62,4 +73,29 @@ StereoMetrics compute_stereo_metrics_interleaved_stereo(const float* interleaved
   return out;
 }
 
+StereoMetrics compute_stereo_metrics_interleaved_stereo(const float* interleaved_stereo,
+                                                        std::size_t frame_count) {
+  if (interleaved_stereo == nullptr || frame_count == 0) {
+    return StereoMetrics{};
+  }
+
+  StereoAccumulator acc;
+  for_each_planar_block(interleaved_stereo, frame_count,
+                        [&](const float* l, const float* r, std::size_t n) { acc.push(l, r, n); });
+  return acc.finalize();
+}
+
+StereoMetrics compute_stereo_metrics_planar_stereo(const float* left,
+                                                   const float* right,
+                                                   std::size_t frame_count) {
+  if (left == nullptr || right == nullptr || frame_count == 0) {
+    return StereoMetrics{};
+  }
+
+  StereoAccumulator acc;
+  for_each_planar_block(left, right, frame_count,
+                        [&](const float* l, const float* r, std::size_t n) { acc.push(l, r, n); });
+  return acc.finalize();
+}
+
 }  // namespace aifr3d
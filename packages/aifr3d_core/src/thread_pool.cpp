@@ -0,0 +1,100 @@
+#include "aifr3d/thread_pool.hpp"
+
+namespace aifr3d {
+
+ThreadPool::ThreadPool(std::size_t thread_count) {
+  const std::size_t workers = thread_count > 1U ? thread_count - 1U : 0U;
+  workers_.reserve(workers);
+  for (std::size_t i = 0; i < workers; ++i) {
+    workers_.emplace_back([this] { workerLoop(); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    const std::scoped_lock lock(mutex_);
+    stopping_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto& w : workers_) {
+    w.join();
+  }
+}
+
+void ThreadPool::drain() {
+  std::unique_lock lock(mutex_);
+  while (next_ < count_) {
+    const std::size_t index = next_++;
+    const auto* task = task_;
+    ++active_;
+    lock.unlock();
+    std::exception_ptr failure;
+    try {
+      (*task)(index);
+    } catch (...) {
+      failure = std::current_exception();
+    }
+    lock.lock();
+    if (failure && !error_) {
+      error_ = failure;
+    }
+    --active_;
+  }
+  if (active_ == 0U) {
+    done_cv_.notify_all();
+  }
+}
+
+void ThreadPool::workerLoop() {
+  std::size_t seen_generation = 0;
+  std::unique_lock lock(mutex_);
+  while (true) {
+    work_cv_.wait(lock, [&] { return stopping_ || generation_ != seen_generation; });
+    if (stopping_) {
+      return;
+    }
+    seen_generation = generation_;
+    lock.unlock();
+    drain();
+    lock.lock();
+  }
+}
+
+void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& task) {
+  if (count == 0) {
+    return;
+  }
+  if (workers_.empty() || count == 1U) {
+    for (std::size_t i = 0; i < count; ++i) {
+      task(i);
+    }
+    return;
+  }
+
+  const std::scoped_lock call_lock(call_mutex_);
+  {
+    const std::scoped_lock lock(mutex_);
+    task_ = &task;
+    count_ = count;
+    next_ = 0;
+    active_ = 0;
+    error_ = nullptr;
+    ++generation_;
+  }
+  work_cv_.notify_all();
+  drain();
+
+  std::exception_ptr error;
+  {
+    std::unique_lock lock(mutex_);
+    done_cv_.wait(lock, [&] { return next_ >= count_ && active_ == 0U; });
+    task_ = nullptr;
+    error = error_;
+    error_ = nullptr;
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+}  // namespace aifr3d
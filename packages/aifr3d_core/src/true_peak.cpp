@@ -1,45 +1,259 @@
 #include "aifr3d/true_peak.hpp"
 
+#include "aifr3d/simd.hpp"
+
 #include <algorithm>
 #include <cmath>
+#include <stdexcept>
 
 namespace aifr3d {
 
-TruePeakMetrics compute_true_peak_interleaved_stereo(const float* interleaved_stereo,
-                                                     std::size_t frame_count,
-                                                     int oversample_factor) {
-  TruePeakMetrics out;
-  out.oversample_factor = oversample_factor > 1 ? oversample_factor : 1;
+namespace {
 
-  if (interleaved_stereo == nullptr || frame_count == 0) {
-    return out;
-  }
-
-  double max_abs = 0.0;
-  const std::size_t channels = 2U;
-
-  for (std::size_t c = 0; c < channels; ++c) {
-    for (std::size_t f = 0; f < frame_count; ++f) {
-      const std::size_t idx = f * channels + c;
-      const double s0 = static_cast<double>(interleaved_stereo[idx]);
-      max_abs = std::max(max_abs, std::fabs(s0));
-
-      if (f + 1U < frame_count) {
-        const std::size_t idx_next = (f + 1U) * channels + c;
-        const double s1 = static_cast<double>(interleaved_stereo[idx_next]);
-        for (int k = 1; k < out.oversample_factor; ++k) {
-          const double t = static_cast<double>(k) / static_cast<double>(out.oversample_factor);
-          const double interp = s0 + (s1 - s0) * t;
-          max_abs = std::max(max_abs, std::fabs(interp));
-        }
+constexpr double kPi = 3.14159265358979323846;
+// With 24 taps per phase the interpolated points stay within 0.01 dB of an
+// ideal reconstruction for content up to 0.4 fs (0.013 dB up to 0.42 fs);
+// past that the window's transition band makes crests read low.
+constexpr double kKaiserBeta = 6.0;
+
+double bessel_i0(double x) {
+  double sum = 1.0;
+  double term = 1.0;
+  for (int k = 1; term > 1e-12 * sum; ++k) {
+    const double half = x / (2.0 * static_cast<double>(k));
+    term *= half * half;
+    sum += term;
+  }
+  return sum;
+}
+
+// coeffs[p][j] weights window[j] for the point p / Factor past the frame
+// Taps / 2 - 1 before the newest frame of the window.
+template <int Factor, std::size_t Taps>
+struct PolyphaseTable {
+  std::array<std::array<float, Taps>, static_cast<std::size_t>(Factor)> coeffs{};
+  // Largest L1 norm over the interpolated phases, padded for float rounding in
+  // the inner products.
+  float overshoot_bound{1.0f};
+};
+
+template <int Factor, std::size_t Taps>
+const PolyphaseTable<Factor, Taps>& polyphase_table() {
+  static const auto table = [] {
+    PolyphaseTable<Factor, Taps> t;
+    const double half_span = static_cast<double>(Taps) / 2.0;
+    for (std::size_t p = 0; p < t.coeffs.size(); ++p) {
+      for (std::size_t j = 0; j < Taps; ++j) {
+        const double u = half_span - 1.0 - static_cast<double>(j) + static_cast<double>(p) / Factor;
+        const double sinc = u == 0.0 ? 1.0 : std::sin(kPi * u) / (kPi * u);
+        const double r = u / half_span;
+        const double window = bessel_i0(kKaiserBeta * std::sqrt(std::max(0.0, 1.0 - r * r))) / bessel_i0(kKaiserBeta);
+        t.coeffs[p][j] = static_cast<float>(sinc * window);
+      }
+    }
+    double bound = 1.0;
+    for (std::size_t p = 1; p < t.coeffs.size(); ++p) {
+      double l1 = 0.0;
+      for (const float c : t.coeffs[p]) {
+        l1 += std::fabs(static_cast<double>(c));
+      }
+      bound = std::max(bound, l1);
+    }
+    t.overshoot_bound = static_cast<float>(bound * (1.0 + 1e-4));
+    return t;
+  }();
+  return table;
+}
+
+// Largest interpolated magnitude for `frames` consecutive output positions;
+// position i reads window[i .. i + Taps - 1]. Four positions per vector.
+template <int Factor, std::size_t Taps>
+float scan_phases(const float* window, std::size_t frames, float max_abs) {
+  const auto& coeffs = polyphase_table<Factor, Taps>().coeffs;
+  simd::Float4 peak = simd::Float4::zero();
+  std::size_t i = 0;
+  for (; i + 4U <= frames; i += 4U) {
+    for (std::size_t p = 1; p < coeffs.size(); ++p) {
+      simd::Float4 acc = simd::Float4::zero();
+      for (std::size_t j = 0; j < Taps; ++j) {
+        acc = acc + simd::Float4::broadcast(coeffs[p][j]) * simd::Float4::load(window + i + j);
       }
+      peak = max(peak, acc.abs());
     }
   }
+  max_abs = std::max(max_abs, peak.maxLane());
+  for (; i < frames; ++i) {
+    for (std::size_t p = 1; p < coeffs.size(); ++p) {
+      float acc = 0.0f;
+      for (std::size_t j = 0; j < Taps; ++j) {
+        acc += coeffs[p][j] * window[i + j];
+      }
+      max_abs = std::max(max_abs, std::fabs(acc));
+    }
+  }
+  return max_abs;
+}
+
+float sample_peak(const float* samples, std::size_t frames, float max_abs) {
+  simd::Float4 peak = simd::Float4::zero();
+  std::size_t i = 0;
+  for (; i + 4U <= frames; i += 4U) {
+    peak = max(peak, simd::Float4::load(samples + i).abs());
+  }
+  max_abs = std::max(max_abs, peak.maxLane());
+  for (; i < frames; ++i) {
+    max_abs = std::max(max_abs, std::fabs(samples[i]));
+  }
+  return max_abs;
+}
 
-  if (max_abs > 0.0) {
-    out.true_peak_dbfs = 20.0 * std::log10(max_abs);
+}  // namespace
+
+void TruePeakAccumulator::reset(int oversample_factor, bool pruning) {
+  if (!isSupportedFactor(oversample_factor)) {
+    throw std::invalid_argument("true_peak_oversample_factor must be 1, 2, 4 or 8");
+  }
+  oversample_factor_ = oversample_factor;
+  pruning_ = pruning;
+  switch (oversample_factor) {
+    case 2:
+      overshoot_bound_ = polyphase_table<2, kTapsPerPhase>().overshoot_bound;
+      break;
+    case 4:
+      overshoot_bound_ = polyphase_table<4, kTapsPerPhase>().overshoot_bound;
+      break;
+    case 8:
+      overshoot_bound_ = polyphase_table<8, kTapsPerPhase>().overshoot_bound;
+      break;
+    default:
+      overshoot_bound_ = 1.0f;
+      break;
+  }
+  position_ = 0;
+  max_abs_ = 0.0f;
+  left_window_.fill(0.0f);
+  right_window_.fill(0.0f);
+}
+
+float TruePeakAccumulator::scanInterpolated(const float* window, std::size_t frames) const {
+  switch (oversample_factor_) {
+    case 2:
+      return scan_phases<2, kTapsPerPhase>(window, frames, 0.0f);
+    case 4:
+      return scan_phases<4, kTapsPerPhase>(window, frames, 0.0f);
+    case 8:
+      return scan_phases<8, kTapsPerPhase>(window, frames, 0.0f);
+    default:
+      return 0.0f;
+  }
+}
+
+// Output positions [first, end) of `window`; the points of a stretch read only
+// window[start .. start + len + kHistory), so they are bounded by
+// overshoot_bound_ times its sample peak.
+float TruePeakAccumulator::scanChannel(const float* window, std::size_t first, std::size_t end, float max_abs) const {
+  for (std::size_t start = first; start < end; start += kPruneFrames) {
+    const std::size_t len = std::min(kPruneFrames, end - start);
+    if (pruning_ && sample_peak(window + start, len + kHistory, 0.0f) * overshoot_bound_ <= max_abs) {
+      continue;
+    }
+    max_abs = std::max(max_abs, scanInterpolated(window + start, len));
+  }
+  return max_abs;
+}
+
+void TruePeakAccumulator::consume(const float* left, const float* right, std::size_t frames, bool owned) {
+  constexpr std::size_t kLookahead = kTapsPerPhase / 2U;
+  std::size_t done = 0;
+  while (done < frames) {
+    const std::size_t n = std::min(kAnalysisBlockFrames, frames - done);
+    std::copy(left + done, left + done + n, left_window_.begin() + kHistory);
+    std::copy(right + done, right + done + n, right_window_.begin() + kHistory);
+
+    if (owned) {
+      max_abs_ = sample_peak(left + done, n, max_abs_);
+      max_abs_ = sample_peak(right + done, n, max_abs_);
+      // Points before the first frame of the stream are not part of the signal.
+      const std::size_t skip = position_ < kLookahead ? std::min(n, kLookahead - position_) : 0U;
+      if (oversample_factor_ > 1 && skip < n) {
+        max_abs_ = scanChannel(left_window_.data(), skip, n, max_abs_);
+        max_abs_ = scanChannel(right_window_.data(), skip, n, max_abs_);
+      }
+    }
+
+    std::copy(left_window_.begin() + static_cast<std::ptrdiff_t>(n),
+              left_window_.begin() + static_cast<std::ptrdiff_t>(n + kHistory), left_window_.begin());
+    std::copy(right_window_.begin() + static_cast<std::ptrdiff_t>(n),
+              right_window_.begin() + static_cast<std::ptrdiff_t>(n + kHistory), right_window_.begin());
+    position_ += n;
+    done += n;
+  }
+}
+
+void TruePeakAccumulator::prime(const float* left, const float* right, std::size_t frames) {
+  consume(left, right, frames, false);
+}
+
+void TruePeakAccumulator::push(const float* left, const float* right, std::size_t frames) {
+  consume(left, right, frames, true);
+}
+
+void TruePeakAccumulator::merge(const TruePeakAccumulator& later) {
+  max_abs_ = std::max(max_abs_, later.max_abs_);
+  position_ = later.position_;
+  left_window_ = later.left_window_;
+  right_window_ = later.right_window_;
+}
+
+TruePeakMetrics TruePeakAccumulator::finalize() {
+  float max_abs = max_abs_;
+  if (oversample_factor_ > 1 && position_ > 0U) {
+    // The points between the last frames and the silence after the stream.
+    constexpr std::size_t kLookahead = kTapsPerPhase / 2U;
+    std::array<float, kHistory + kLookahead> left_tail{};
+    std::array<float, kHistory + kLookahead> right_tail{};
+    std::copy(left_window_.begin(), left_window_.begin() + kHistory, left_tail.begin());
+    std::copy(right_window_.begin(), right_window_.begin() + kHistory, right_tail.begin());
+    const std::size_t skip = position_ < kLookahead ? kLookahead - position_ : 0U;
+    max_abs = std::max(max_abs, scanInterpolated(left_tail.data() + skip, kLookahead - skip));
+    max_abs = std::max(max_abs, scanInterpolated(right_tail.data() + skip, kLookahead - skip));
+  }
+
+  TruePeakMetrics out;
+  out.oversample_factor = oversample_factor_;
+  if (max_abs > 0.0f) {
+    out.true_peak_dbfs = 20.0 * std::log10(static_cast<double>(max_abs));
   }
   return out;
 }
 
+TruePeakMetrics compute_true_peak_interleaved_stereo(const float* interleaved_stereo,
+                                                     std::size_t frame_count,
+                                                     int oversample_factor) {
+  TruePeakAccumulator acc;
+  acc.reset(oversample_factor);
+  if (interleaved_stereo == nullptr || frame_count == 0) {
+    return acc.finalize();
+  }
+
+  for_each_planar_block(interleaved_stereo, frame_count,
+                        [&](const float* l, const float* r, std::size_t n) { acc.push(l, r, n); });
+  return acc.finalize();
+}
+
+TruePeakMetrics compute_true_peak_planar_stereo(const float* left,
+                                                const float* right,
+                                                std::size_t frame_count,
+                                                int oversample_factor) {
+  TruePeakAccumulator acc;
+  acc.reset(oversample_factor);
+  if (left == nullptr || right == nullptr || frame_count == 0) {
+    return acc.finalize();
+  }
+
+  for_each_planar_block(left, right, frame_count,
+                        [&](const float* l, const float* r, std::size_t n) { acc.push(l, r, n); });
+  return acc.finalize();
+}
+
 }  // namespace aifr3d
@@ -0,0 +1,166 @@
+#include "aifr3d/analyzer.hpp"
+#include "aifr3d/compare.hpp"
+#include "aifr3d/scoring.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+void require(bool cond, const std::string& msg) {
+  if (!cond) {
+    throw std::runtime_error(msg);
+  }
+}
+
+void requireSame(const std::optional<double>& a, const std::optional<double>& b, const std::string& name) {
+  require(a.has_value() == b.has_value(), name + " presence mismatch");
+  if (a.has_value()) {
+    require(*a == *b, name + " value mismatch");
+  }
+}
+
+std::vector<float> makeProgram(std::size_t frames, double sr) {
+  std::vector<float> out(frames * 2U);
+  for (std::size_t i = 0; i < frames; ++i) {
+    const double t = static_cast<double>(i) / sr;
+    const double env = 0.5 + 0.4 * std::sin(2.0 * kPi * 0.5 * t);
+    out[i * 2U] = static_cast<float>(env * 0.7 * std::sin(2.0 * kPi * 90.0 * t));
+    out[i * 2U + 1U] = static_cast<float>(env * 0.5 * std::sin(2.0 * kPi * 2900.0 * t + 0.7));
+  }
+  return out;
+}
+
+aifr3d::MetricGroups only(bool loudness, bool true_peak) {
+  aifr3d::MetricGroups g;
+  g.basic = false;
+  g.loudness = loudness;
+  g.true_peak = true_peak;
+  g.spectral = false;
+  g.stereo = false;
+  g.dynamics = false;
+  return g;
+}
+
+void testSkippedGroupsStayEmpty() {
+  constexpr std::size_t frames = 48000U * 3U + 211U;
+  constexpr double sr = 48000.0;
+  const auto program = makeProgram(frames, sr);
+  const auto full = aifr3d::Analyzer().analyzeInterleavedStereo(program.data(), frames, sr);
+
+  aifr3d::AnalysisOptions compliance;
+  compliance.groups = only(true, true);
+  const auto lean = aifr3d::Analyzer(compliance).analyzeInterleavedStereo(program.data(), frames, sr);
+
+  requireSame(lean.loudness.integrated_lufs, full.loudness.integrated_lufs, "integrated_lufs");
+  requireSame(lean.loudness.short_term_lufs, full.loudness.short_term_lufs, "short_term_lufs");
+  requireSame(lean.true_peak.true_peak_dbfs, full.true_peak.true_peak_dbfs, "true_peak_dbfs");
+  require(!lean.basic.peak_dbfs.has_value(), "basic must be skipped");
+  require(!lean.spectral.sub.has_value() && !lean.spectral.air.has_value(), "spectral must be skipped");
+  require(!lean.stereo.correlation.has_value(), "stereo must be skipped");
+  require(!lean.dynamics.dr_proxy_db.has_value(), "dynamics must be skipped");
+  require(!lean.computed_groups.spectral && lean.computed_groups.loudness, "computed_groups must echo the mask");
+
+  aifr3d::AnalysisOptions basic_only;
+  basic_only.groups = only(false, false);
+  basic_only.groups.basic = true;
+  aifr3d::StreamingAnalyzer streaming;
+  streaming.reset(sr, basic_only);
+  streaming.push(program.data(), frames);
+  const auto basic = streaming.finalize();
+  requireSame(basic.basic.peak_dbfs, full.basic.peak_dbfs, "basic.peak_dbfs without dynamics");
+  requireSame(basic.basic.rms_dbfs, full.basic.rms_dbfs, "basic.rms_dbfs without dynamics");
+  requireSame(basic.basic.crest_db, full.basic.crest_db, "basic.crest_db without dynamics");
+  require(!basic.dynamics.peak_dbfs.has_value(), "dynamics must be skipped with basic only");
+  require(!basic.loudness.integrated_lufs.has_value(), "loudness must be skipped with basic only");
+}
+
+void testStageParameters() {
+  constexpr std::size_t frames = 48000U * 2U;
+  constexpr double sr = 48000.0;
+  const auto program = makeProgram(frames, sr);
+
+  aifr3d::AnalysisOptions options;
+  options.true_peak_oversample_factor = 8;
+  options.fft_size = 4096;
+  const auto tuned = aifr3d::Analyzer(options, 2).analyzeInterleavedStereo(program.data(), frames, sr);
+  require(tuned.true_peak.oversample_factor == 8, "oversample factor must be honored");
+  require(tuned.spectral.sub.has_value() && tuned.spectral.highmid.has_value(), "fft_size 4096 bands missing");
+
+  bool threw = false;
+  try {
+    aifr3d::AnalysisOptions bad;
+    bad.fft_size = 1000;
+    (void)aifr3d::Analyzer(bad);
+  } catch (const std::invalid_argument&) {
+    threw = true;
+  }
+  require(threw, "non power-of-two fft_size must throw");
+
+  threw = false;
+  try {
+    aifr3d::AnalysisOptions bad;
+    bad.true_peak_oversample_factor = 0;
+    aifr3d::StreamingAnalyzer streaming;
+    streaming.reset(sr, bad);
+  } catch (const std::invalid_argument&) {
+    threw = true;
+  }
+  require(threw, "oversample factor 0 must throw");
+
+  threw = false;
+  try {
+    aifr3d::AnalysisOptions bad;
+    bad.true_peak_oversample_factor = 3;
+    (void)aifr3d::Analyzer(bad);
+  } catch (const std::invalid_argument&) {
+    threw = true;
+  }
+  require(threw, "oversample factor 3 must throw");
+}
+
+void testCompareAndScoreTolerateSkippedGroups() {
+  aifr3d::BenchmarkProfile profile;
+  profile.profile_id = "options_v1";
+  profile.metrics.loudness.integrated_lufs = aifr3d::BenchmarkMetricTarget{-14.0, 1.0, std::nullopt, std::nullopt};
+  profile.metrics.spectral.mid = aifr3d::BenchmarkMetricTarget{0.0, 2.0, std::nullopt, std::nullopt};
+  profile.metrics.stereo.correlation = aifr3d::BenchmarkMetricTarget{0.5, 0.2, std::nullopt, std::nullopt};
+
+  aifr3d::AnalysisResult analysis;
+  analysis.computed_groups = only(true, true);
+  analysis.loudness.integrated_lufs = -14.2;
+
+  const auto cmp = aifr3d::compareAgainstBenchmark(analysis, profile);
+  require(cmp.loudness.integrated_lufs.in_range == aifr3d::InRangeClass::IN_RANGE, "loudness must compare");
+  require(cmp.spectral.mid.in_range == aifr3d::InRangeClass::UNKNOWN, "skipped spectral must be UNKNOWN");
+  require(cmp.summary.in_range_count == 1, "in-range count");
+  require(cmp.summary.unknown_count == 2, "only computed groups are tallied");
+
+  const auto score = aifr3d::computeScore(cmp);
+  require(score.subscores.size() == 1U && score.subscores.count("loudness") == 1U,
+          "only computed groups produce subscores");
+  require(std::fabs(score.overall_0_100 - score.subscores.at("loudness")) < 1e-12,
+          "skipped weights must drop out of the overall score");
+}
+
+}  // namespace
+
+int main() {
+  try {
+    testSkippedGroupsStayEmpty();
+    testStageParameters();
+    testCompareAndScoreTolerateSkippedGroups();
+  } catch (const std::exception& ex) {
+    std::cerr << "[FAIL] " << ex.what() << '\n';
+    return 1;
+  }
+
+  std::cout << "[PASS] test_analysis_options\n";
+  return 0;
+}
@@ -1,4 +1,9 @@
 #include "aifr3d/analyzer.hpp"
+#include "aifr3d/dynamics.hpp"
+#include "aifr3d/loudness.hpp"
+#include "aifr3d/spectral.hpp"
+#include "aifr3d/stereo.hpp"
+#include "aifr3d/true_peak.hpp"
 
 #include <cmath>
 #include <cstddef>
@@ -106,6 +111,99 @@ void testDeterminismRepeatedRun() {
   }
 }
 
+void requireSame(const std::optional<double>& a, const std::optional<double>& b, const std::string& name) {
+  require(a.has_value() == b.has_value(), name + " presence mismatch");
+  if (a.has_value()) {
+    require(std::fabs(*a - *b) <= kExactTol, name + " value mismatch");
+  }
+}
+
+void testFusedMatchesPerModule() {
+  // Not a multiple of the fused block size, and long enough for many loudness
+  // windows and STFT frames to straddle block boundaries.
+  constexpr std::size_t frames = 48000U * 3U + 1234U;
+  constexpr double sample_rate = 48000.0;
+
+  std::vector<float> interleaved(frames * 2U);
+  for (std::size_t i = 0; i < frames; ++i) {
+    const double t = static_cast<double>(i) / sample_rate;
+    const double env = 0.5 + 0.4 * std::sin(2.0 * kPi * 0.7 * t);
+    interleaved[i * 2U] = static_cast<float>(env * 0.6 * std::sin(2.0 * kPi * 97.0 * t));
+    interleaved[i * 2U + 1U] = static_cast<float>(env * 0.4 * std::sin(2.0 * kPi * 3003.0 * t + 0.3));
+  }
+
+  const aifr3d::Analyzer analyzer;
+  const auto fused = analyzer.analyzeInterleavedStereo(interleaved.data(), frames, sample_rate);
+
+  const auto loudness = aifr3d::compute_loudness_interleaved_stereo(interleaved.data(), frames, sample_rate);
+  const auto true_peak = aifr3d::compute_true_peak_interleaved_stereo(interleaved.data(), frames, 4);
+  const auto spectral = aifr3d::compute_spectral_bands_interleaved_stereo(interleaved.data(), frames, sample_rate);
+  const auto stereo = aifr3d::compute_stereo_metrics_interleaved_stereo(interleaved.data(), frames);
+  const auto dynamics = aifr3d::compute_dynamics_interleaved_stereo(interleaved.data(), frames, sample_rate);
+
+  requireSame(fused.basic.peak_dbfs, dynamics.peak_dbfs, "basic.peak_dbfs");
+  requireSame(fused.basic.rms_dbfs, dynamics.rms_dbfs, "basic.rms_dbfs");
+  requireSame(fused.loudness.integrated_lufs, loudness.integrated_lufs, "loudness.integrated_lufs");
+  requireSame(fused.loudness.short_term_lufs, loudness.short_term_lufs, "loudness.short_term_lufs");
+  requireSame(fused.true_peak.true_peak_dbfs, true_peak.true_peak_dbfs, "true_peak.true_peak_dbfs");
+  requireSame(fused.spectral.sub, spectral.sub, "spectral.sub");
+  requireSame(fused.spectral.mid, spectral.mid, "spectral.mid");
+  requireSame(fused.spectral.air, spectral.air, "spectral.air");
+  requireSame(fused.stereo.correlation, stereo.correlation, "stereo.correlation");
+  requireSame(fused.stereo.width_proxy, stereo.width_proxy, "stereo.width_proxy");
+  requireSame(fused.dynamics.dr_proxy_db, dynamics.dr_proxy_db, "dynamics.dr_proxy_db");
+}
+
+void testPlanarMatchesInterleaved() {
+  constexpr std::size_t frames = 48000U * 2U + 517U;
+  constexpr double sample_rate = 44100.0;
+
+  std::vector<float> left(frames);
+  std::vector<float> right(frames);
+  std::vector<float> interleaved(frames * 2U);
+  for (std::size_t i = 0; i < frames; ++i) {
+    const double t = static_cast<double>(i) / sample_rate;
+    left[i] = static_cast<float>(0.7 * std::sin(2.0 * kPi * 61.0 * t) * (0.6 + 0.3 * std::sin(2.0 * kPi * 1.3 * t)));
+    right[i] = static_cast<float>(0.3 * std::sin(2.0 * kPi * 5200.0 * t + 0.9));
+    interleaved[i * 2U] = left[i];
+    interleaved[i * 2U + 1U] = right[i];
+  }
+
+  const aifr3d::Analyzer analyzer;
+  const auto from_interleaved = analyzer.analyzeInterleavedStereo(interleaved.data(), frames, sample_rate);
+  const auto from_planar = analyzer.analyzePlanarStereo(left.data(), right.data(), frames, sample_rate);
+
+  require(from_planar.frame_count == frames, "planar frame_count mismatch");
+  requireSame(from_planar.basic.rms_dbfs, from_interleaved.basic.rms_dbfs, "planar basic.rms_dbfs");
+  requireSame(from_planar.loudness.integrated_lufs, from_interleaved.loudness.integrated_lufs,
+              "planar loudness.integrated_lufs");
+  requireSame(from_planar.true_peak.true_peak_dbfs, from_interleaved.true_peak.true_peak_dbfs,
+              "planar true_peak.true_peak_dbfs");
+  requireSame(from_planar.spectral.high, from_interleaved.spectral.high, "planar spectral.high");
+  requireSame(from_planar.stereo.lr_balance_db, from_interleaved.stereo.lr_balance_db, "planar stereo.lr_balance_db");
+  requireSame(from_planar.dynamics.dr_proxy_db, from_interleaved.dynamics.dr_proxy_db, "planar dynamics.dr_proxy_db");
+
+  const auto loudness = aifr3d::compute_loudness_planar_stereo(left.data(), right.data(), frames, sample_rate);
+  const auto true_peak = aifr3d::compute_true_peak_planar_stereo(left.data(), right.data(), frames, 4);
+  const auto spectral = aifr3d::compute_spectral_bands_planar_stereo(left.data(), right.data(), frames, sample_rate);
+  const auto stereo = aifr3d::compute_stereo_metrics_planar_stereo(left.data(), right.data(), frames);
+  const auto dynamics = aifr3d::compute_dynamics_planar_stereo(left.data(), right.data(), frames, sample_rate);
+  requireSame(loudness.short_term_lufs, from_interleaved.loudness.short_term_lufs, "planar short_term_lufs");
+  requireSame(true_peak.true_peak_dbfs, from_interleaved.true_peak.true_peak_dbfs, "planar module true_peak");
+  requireSame(spectral.low, from_interleaved.spectral.low, "planar module spectral.low");
+  requireSame(stereo.correlation, from_interleaved.stereo.correlation, "planar module correlation");
+  requireSame(dynamics.crest_db, from_interleaved.dynamics.crest_db, "planar module crest_db");
+
+  aifr3d::StreamingAnalyzer streaming;
+  streaming.reset(sample_rate);
+  streaming.pushPlanar(left.data(), right.data(), 1000U);
+  streaming.pushPlanar(left.data() + 1000U, right.data() + 1000U, frames - 1000U);
+  const auto streamed = streaming.finalize();
+  requireSame(streamed.loudness.integrated_lufs, from_interleaved.loudness.integrated_lufs,
+              "streamed planar integrated_lufs");
+  requireSame(streamed.spectral.sub, from_interleaved.spectral.sub, "streamed planar spectral.sub");
+}
+
 void testInvalidInputHandling() {
   const aifr3d::Analyzer analyzer;
   bool threw = false;
@@ -125,6 +223,14 @@ void testInvalidInputHandling() {
     threw = true;
   }
   require(threw, "expected throw for non-positive sample_rate_hz");
+
+  threw = false;
+  try {
+    (void)analyzer.analyzePlanarStereo(interleaved.data(), nullptr, 1, 48000.0);
+  } catch (const std::invalid_argument&) {
+    threw = true;
+  }
+  require(threw, "expected throw for null right channel with nonzero frame_count");
 }
 
 }  // namespace
@@ -134,6 +240,8 @@ int main() {
     testSineWaveMetrics();
     testSilenceContract();
     testDeterminismRepeatedRun();
+    testFusedMatchesPerModule();
+    testPlanarMatchesInterleaved();
     testInvalidInputHandling();
   } catch (const std::exception& ex) {
     std::cerr << "[FAIL] " << ex.what() << '\n';
@@ -0,0 +1,149 @@
+#include "aifr3d/analyzer.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::atomic<bool> g_counting{false};
+std::atomic<std::size_t> g_allocations{0};
+
+void* countedAlloc(std::size_t size) {
+  if (g_counting.load(std::memory_order_relaxed)) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void* countedAlignedAlloc(std::size_t size, std::align_val_t align) {
+  if (g_counting.load(std::memory_order_relaxed)) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+  }
+  const auto a = static_cast<std::size_t>(align);
+  const std::size_t rounded = ((size == 0 ? 1 : size) + a - 1U) / a * a;
+  if (void* p = std::aligned_alloc(a, rounded)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) { return countedAlloc(size); }
+void* operator new[](std::size_t size) { return countedAlloc(size); }
+void* operator new(std::size_t size, std::align_val_t align) { return countedAlignedAlloc(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align) { return countedAlignedAlloc(size, align); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+void require(bool cond, const std::string& msg) {
+  if (!cond) {
+    throw std::runtime_error(msg);
+  }
+}
+
+void requireSame(const std::optional<double>& a, const std::optional<double>& b, const std::string& name) {
+  require(a.has_value() == b.has_value(), name + " presence mismatch");
+  if (a.has_value()) {
+    require(*a == *b, name + " value mismatch");
+  }
+}
+
+std::vector<float> makeStem(std::size_t frames, double sr, double freq) {
+  std::vector<float> out(frames * 2U);
+  for (std::size_t i = 0; i < frames; ++i) {
+    const double t = static_cast<double>(i) / sr;
+    out[i * 2U] = static_cast<float>(0.6 * std::sin(2.0 * kPi * freq * t));
+    out[i * 2U + 1U] = static_cast<float>(0.4 * std::sin(2.0 * kPi * freq * 1.5 * t + 0.2));
+  }
+  return out;
+}
+
+// Allocations made by materializing a result (the generated_at_utc string),
+// which the caller owns and is outside the workspace's control.
+std::size_t resultAllocations(const aifr3d::AnalysisResult& r) {
+  g_allocations.store(0);
+  g_counting.store(true);
+  const aifr3d::AnalysisResult copy = r;
+  g_counting.store(false);
+  (void)copy;
+  return g_allocations.load();
+}
+
+void testSteadyStateIsAllocationFree(std::size_t threads, std::size_t frames) {
+  constexpr double sr = 48000.0;
+  const aifr3d::Analyzer analyzer(threads);
+  aifr3d::AnalyzerWorkspace workspace;
+
+  const auto first = makeStem(frames, sr, 220.0);
+  const auto second = makeStem(frames - 999U, sr, 1760.0);
+  const auto warm = analyzer.analyzeInterleavedStereo(first.data(), frames, sr, workspace);
+  const std::size_t budget = resultAllocations(warm);
+
+  g_allocations.store(0);
+  g_counting.store(true);
+  const auto steady = analyzer.analyzeInterleavedStereo(second.data(), frames - 999U, sr, workspace);
+  g_counting.store(false);
+  require(g_allocations.load() <= budget,
+          "steady-state analysis allocated " + std::to_string(g_allocations.load()) + " times");
+
+  const auto fresh = analyzer.analyzeInterleavedStereo(second.data(), frames - 999U, sr);
+  requireSame(steady.loudness.integrated_lufs, fresh.loudness.integrated_lufs, "reused integrated_lufs");
+  requireSame(steady.spectral.highmid, fresh.spectral.highmid, "reused spectral.highmid");
+  requireSame(steady.dynamics.dr_proxy_db, fresh.dynamics.dr_proxy_db, "reused dr_proxy_db");
+  requireSame(steady.true_peak.true_peak_dbfs, fresh.true_peak.true_peak_dbfs, "reused true_peak_dbfs");
+}
+
+void testShorterInputAfterLongerReusesPartials() {
+  constexpr double sr = 44100.0;
+  const aifr3d::Analyzer analyzer;
+  aifr3d::AnalyzerWorkspace workspace;
+
+  const auto long_stem = makeStem(44100U * 8U, sr, 330.0);
+  const auto short_stem = makeStem(3000U, sr, 660.0);
+  (void)analyzer.analyzeInterleavedStereo(long_stem.data(), 44100U * 8U, sr, workspace);
+  const auto reused = analyzer.analyzeInterleavedStereo(short_stem.data(), 3000U, sr, workspace);
+  const auto fresh = analyzer.analyzeInterleavedStereo(short_stem.data(), 3000U, sr);
+
+  require(reused.frame_count == 3000U, "reused frame_count");
+  requireSame(reused.basic.rms_dbfs, fresh.basic.rms_dbfs, "short basic.rms_dbfs");
+  requireSame(reused.loudness.short_term_lufs, fresh.loudness.short_term_lufs, "short short_term_lufs");
+  requireSame(reused.spectral.sub, fresh.spectral.sub, "short spectral.sub");
+  requireSame(reused.stereo.correlation, fresh.stereo.correlation, "short stereo.correlation");
+}
+
+}  // namespace
+
+int main() {
+  try {
+    testSteadyStateIsAllocationFree(1, 48000U * 2U);
+    testSteadyStateIsAllocationFree(3, 48000U * 12U);
+    testShorterInputAfterLongerReusesPartials();
+  } catch (const std::exception& ex) {
+    std::cerr << "[FAIL] " << ex.what() << '\n';
+    return 1;
+  }
+
+  std::cout << "[PASS] test_analyzer_workspace\n";
+  return 0;
+}
@@ -1,5 +1,8 @@
 #include "aifr3d/dynamics.hpp"
 
+#include "aifr3d/analyzer.hpp"
+
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <stdexcept>
@@ -14,6 +17,140 @@ void require(bool cond, const std::string& msg) {
   }
 }
 
+constexpr double kPi = 3.14159265358979323846;
+
+double sortedDrProxy(const std::vector<float>& interleaved) {
+  std::vector<float> abs_values;
+  for (float s : interleaved) {
+    abs_values.push_back(std::fabs(s));
+  }
+  std::sort(abs_values.begin(), abs_values.end());
+  const auto n = static_cast<double>(abs_values.size() - 1U);
+  const double p10 = static_cast<double>(abs_values[static_cast<std::size_t>(n * 0.10)]);
+  const double p95 = static_cast<double>(abs_values[static_cast<std::size_t>(n * 0.95)]);
+  return 20.0 * std::log10(p95) - 20.0 * std::log10(p10);
+}
+
+void testExactModeMatchesSortAndBoundsHistogram() {
+  constexpr std::size_t frames = 48000U * 3U + 17U;
+  std::vector<float> program(frames * 2U);
+  for (std::size_t i = 0; i < frames; ++i) {
+    const double t = static_cast<double>(i) / 48000.0;
+    const double env = 0.02 + 0.7 * std::fabs(std::sin(2.0 * kPi * 0.4 * t));
+    program[i * 2U] = static_cast<float>(env * std::sin(2.0 * kPi * 97.0 * t));
+    program[i * 2U + 1U] = static_cast<float>(env * 0.6 * std::sin(2.0 * kPi * 3100.0 * t + 0.4));
+  }
+  const double sorted = sortedDrProxy(program);
+
+  aifr3d::DynamicsAccumulator exact;
+  exact.reset(48000.0, true, true);
+  aifr3d::DynamicsAccumulator histogram;
+  histogram.reset(48000.0);
+  for (std::size_t pos = 0; pos < frames; pos += 1000U) {
+    const std::size_t n = std::min<std::size_t>(1000U, frames - pos);
+    std::vector<float> l(n);
+    std::vector<float> r(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      l[i] = program[(pos + i) * 2U];
+      r[i] = program[(pos + i) * 2U + 1U];
+    }
+    exact.push(l.data(), r.data(), n);
+    histogram.push(l.data(), r.data(), n);
+  }
+  const auto e = exact.finalize();
+  const auto h = histogram.finalize();
+  require(e.dr_proxy_db.has_value() && *e.dr_proxy_db == sorted, "exact mode must equal the sorted percentiles");
+  require(h.dr_proxy_db.has_value() && std::fabs(*h.dr_proxy_db - sorted) <= 0.03,
+          "histogram dr_proxy_db outside documented tolerance");
+  require(*e.peak_dbfs == *h.peak_dbfs && *e.rms_dbfs == *h.rms_dbfs, "mode must not change peak/rms");
+
+  aifr3d::AnalysisOptions options;
+  options.dynamics_exact_percentiles = true;
+  const auto chunked = aifr3d::Analyzer(options, 4).analyzeInterleavedStereo(program.data(), frames, 48000.0);
+  require(chunked.dynamics.dr_proxy_db.has_value() && *chunked.dynamics.dr_proxy_db == sorted,
+          "exact mode must survive chunked merges");
+}
+
+// Ten 3 s blocks of a quiet tone, two of them loud, with a click in two of the
+// quiet blocks: the loudest 20% are the loud blocks and the second-highest
+// block peak is the smaller click.
+std::vector<float> makeBlockProgram(double sr) {
+  const auto block = static_cast<std::size_t>(3.0 * sr);
+  std::vector<float> out(block * 10U * 2U);
+  for (std::size_t i = 0; i < block * 10U; ++i) {
+    const std::size_t b = i / block;
+    const double amp = (b == 2U || b == 6U) ? 0.5 : 0.05;
+    const auto x = static_cast<float>(amp * std::sin(2.0 * kPi * 1000.0 * static_cast<double>(i) / sr));
+    out[i * 2U] = x;
+    out[i * 2U + 1U] = x;
+  }
+  for (std::size_t c = 0; c < 2U; ++c) {
+    out[(3U * block + 1000U) * 2U + c] = 0.9f;
+    out[(7U * block + 1000U) * 2U + c] = 0.8f;
+  }
+  return out;
+}
+
+void testDr14AndLoudnessRatios() {
+  constexpr double sr = 48000.0;
+  const auto program = makeBlockProgram(sr);
+  const std::size_t frames = program.size() / 2U;
+
+  const auto serial = aifr3d::compute_dynamics_interleaved_stereo(program.data(), frames, sr);
+  const double expected = 20.0 * std::log10(static_cast<double>(0.8f) / 0.5);
+  require(serial.dr_db.has_value() && std::fabs(*serial.dr_db - expected) < 1e-3, "dr_db off the DR14 definition");
+  require(serial.psr_series_db.empty() && !serial.plr_db.has_value(), "ratios need the loudness group");
+
+  const auto chunked = aifr3d::Analyzer(4).analyzeInterleavedStereo(program.data(), frames, sr);
+  require(chunked.dynamics.dr_db.has_value() && std::fabs(*chunked.dynamics.dr_db - *serial.dr_db) < 1e-9,
+          "chunked dr_db must match the serial pass");
+
+  const auto& st = chunked.loudness.short_term_series_lufs;
+  const auto& psr = chunked.dynamics.psr_series_db;
+  require(psr.size() == st.size(), "psr series must align with the short-term series");
+  // Window w spans hops [w, w + 30); the 0.9 click sits in hop 90.
+  const double click_db = 20.0 * std::log10(static_cast<double>(0.9f));
+  for (const std::size_t w : {61U, 75U, 90U}) {
+    require(psr[w].has_value() && std::fabs(*psr[w] - (click_db - *st[w])) < 1e-12, "psr window with click");
+  }
+  require(psr[91].has_value() && *psr[91] < click_db - *st[91], "psr window past the click");
+  require(chunked.true_peak.true_peak_dbfs.has_value() && chunked.dynamics.plr_db.has_value() &&
+              std::fabs(*chunked.dynamics.plr_db -
+                        (*chunked.true_peak.true_peak_dbfs - *chunked.loudness.integrated_lufs)) < 1e-12,
+          "plr_db must be true peak minus integrated loudness");
+
+  aifr3d::AnalysisOptions no_true_peak;
+  no_true_peak.groups.true_peak = false;
+  const auto fallback = aifr3d::Analyzer(no_true_peak, 4).analyzeInterleavedStereo(program.data(), frames, sr);
+  require(fallback.dynamics.plr_db.has_value() &&
+              std::fabs(*fallback.dynamics.plr_db - (click_db - *fallback.loudness.integrated_lufs)) < 1e-12,
+          "plr_db must fall back to the sample peak without the true_peak group");
+}
+
+// A quarter-rate sine sampled 45 degrees off its crests reads about 3 dB
+// higher as a true peak, which PLR must follow.
+void testPlrUsesTruePeak() {
+  constexpr double sr = 48000.0;
+  const std::size_t frames = static_cast<std::size_t>(sr) * 4U;
+  std::vector<float> program(frames * 2U);
+  for (std::size_t i = 0; i < frames; ++i) {
+    const auto x = static_cast<float>(0.5 * std::sin(0.5 * kPi * static_cast<double>(i) + 0.25 * kPi));
+    program[i * 2U] = x;
+    program[i * 2U + 1U] = x;
+  }
+  aifr3d::AnalysisOptions no_true_peak;
+  no_true_peak.groups.true_peak = false;
+  const auto with_tp = aifr3d::Analyzer().analyzeInterleavedStereo(program.data(), frames, sr);
+  const auto without_tp = aifr3d::Analyzer(no_true_peak).analyzeInterleavedStereo(program.data(), frames, sr);
+  require(with_tp.dynamics.plr_db.has_value() && without_tp.dynamics.plr_db.has_value() &&
+              with_tp.true_peak.true_peak_dbfs.has_value() && with_tp.basic.peak_dbfs.has_value(),
+          "plr_db must be defined");
+  const double overshoot = *with_tp.true_peak.true_peak_dbfs - *with_tp.basic.peak_dbfs;
+  require(overshoot > 2.9, "the sine must peak between samples");
+  require(std::fabs(*with_tp.dynamics.plr_db - *without_tp.dynamics.plr_db - overshoot) < 1e-9,
+          "plr_db must read the inter-sample peak");
+}
+
 }  // namespace
 
 int main() {
@@ -21,17 +158,21 @@ int main() {
     constexpr std::size_t frames = 4096;
 
     std::vector<float> silence(frames * 2U, 0.0f);
-    const auto ds = aifr3d::compute_dynamics_interleaved_stereo(silence.data(), frames);
+    const auto ds = aifr3d::compute_dynamics_interleaved_stereo(silence.data(), frames, 48000.0);
     require(!ds.peak_dbfs.has_value(), "silence peak must be nullopt");
     require(!ds.rms_dbfs.has_value(), "silence rms must be nullopt");
     require(!ds.crest_db.has_value(), "silence crest must be nullopt");
 
     std::vector<float> tone(frames * 2U, 0.25f);
-    const auto dt = aifr3d::compute_dynamics_interleaved_stereo(tone.data(), frames);
+    const auto dt = aifr3d::compute_dynamics_interleaved_stereo(tone.data(), frames, 48000.0);
     require(dt.peak_dbfs.has_value(), "tone peak missing");
     require(dt.rms_dbfs.has_value(), "tone rms missing");
     require(dt.crest_db.has_value(), "tone crest missing");
     require(std::fabs(*dt.crest_db) < 1e-9, "constant tone should have near-zero crest");
+
+    testExactModeMatchesSortAndBoundsHistogram();
+    testDr14AndLoudnessRatios();
+    testPlrUsesTruePeak();
   } catch (const std::exception& ex) {
     std::cerr << "[FAIL] " << ex.what() << '\n';
     return 1;
@@ -0,0 +1,136 @@
+#include "aifr3d/fft.hpp"
+
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+void require(bool cond, const std::string& msg) {
+  if (!cond) {
+    throw std::runtime_error(msg);
+  }
+}
+
+std::vector<double> makeSignal(std::size_t n) {
+  std::vector<double> x(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    const double t = static_cast<double>(i);
+    x[i] = 0.7 * std::sin(0.31 * t) + 0.2 * std::cos(2.3 * t + 0.4) + (i % 7U == 0U ? 0.5 : -0.1);
+  }
+  return x;
+}
+
+// Direct O(n^2) DFT in long double as the reference.
+std::vector<std::complex<double>> naiveDft(const std::vector<std::complex<double>>& x) {
+  const std::size_t n = x.size();
+  std::vector<std::complex<double>> out(n);
+  for (std::size_t k = 0; k < n; ++k) {
+    long double re = 0.0L;
+    long double im = 0.0L;
+    for (std::size_t j = 0; j < n; ++j) {
+      const long double angle = -2.0L * static_cast<long double>(kPi) * static_cast<long double>((j * k) % n) /
+                                static_cast<long double>(n);
+      const long double c = std::cos(angle);
+      const long double s = std::sin(angle);
+      re += static_cast<long double>(x[j].real()) * c - static_cast<long double>(x[j].imag()) * s;
+      im += static_cast<long double>(x[j].real()) * s + static_cast<long double>(x[j].imag()) * c;
+    }
+    out[k] = {static_cast<double>(re), static_cast<double>(im)};
+  }
+  return out;
+}
+
+double maxError(const std::vector<std::complex<double>>& a, const std::vector<std::complex<double>>& b,
+                std::size_t count) {
+  double err = 0.0;
+  for (std::size_t k = 0; k < count; ++k) {
+    err = std::max(err, std::abs(a[k] - b[k]));
+  }
+  return err;
+}
+
+void testComplexAndRealMatchDft() {
+  for (const std::size_t n : {2U, 4U, 16U, 256U, 1024U}) {
+    const auto signal = makeSignal(n);
+    std::vector<std::complex<double>> x(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      x[i] = {signal[i], 0.3 * signal[(i * 5U) % n]};
+    }
+    const auto expected = naiveDft(x);
+    const double scale = static_cast<double>(n);
+
+    const auto plan = aifr3d::FftPlan<double>::forSize(n);
+    auto data = x;
+    plan->forward(data.data());
+    require(maxError(data, expected, n) < 1e-12 * scale, "complex FFT off the DFT at n=" + std::to_string(n));
+
+    auto legacy = x;
+    aifr3d::fft_inplace(legacy);
+    require(maxError(legacy, data, n) == 0.0, "fft_inplace must run the cached plan");
+
+    std::vector<std::complex<double>> real_in(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      real_in[i] = {signal[i], 0.0};
+    }
+    const auto real_expected = naiveDft(real_in);
+    std::vector<std::complex<double>> half(n / 2U + 1U);
+    plan->forwardReal(signal.data(), half.data());
+    require(maxError(half, real_expected, n / 2U + 1U) < 1e-12 * scale,
+            "real FFT off the DFT at n=" + std::to_string(n));
+
+    const aifr3d::FftPlan<float> plan_f(n);
+    std::vector<float> signal_f(signal.begin(), signal.end());
+    std::vector<std::complex<float>> half_f(n / 2U + 1U);
+    plan_f.forwardReal(signal_f.data(), half_f.data());
+    std::vector<std::complex<double>> widened(half_f.begin(), half_f.end());
+    require(maxError(widened, real_expected, n / 2U + 1U) < 1e-5 * scale,
+            "float real FFT off the DFT at n=" + std::to_string(n));
+  }
+}
+
+void testCacheIsSharedAcrossThreads() {
+  std::vector<std::shared_ptr<const aifr3d::FftPlan<float>>> seen(8);
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < seen.size(); ++t) {
+    threads.emplace_back([&seen, t] { seen[t] = aifr3d::FftPlan<float>::forSize(4096); });
+  }
+  for (auto& th : threads) {
+    th.join();
+  }
+  for (const auto& plan : seen) {
+    require(plan == seen.front() && plan->size() == 4096U, "one plan per size");
+  }
+  require(aifr3d::FftPlan<float>::forSize(2048) != seen.front(), "sizes must not share a plan");
+
+  bool threw = false;
+  try {
+    (void)aifr3d::FftPlan<double>::forSize(1000);
+  } catch (const std::invalid_argument&) {
+    threw = true;
+  }
+  require(threw, "non power-of-two size must throw");
+}
+
+}  // namespace
+
+int main() {
+  try {
+    testComplexAndRealMatchDft();
+    testCacheIsSharedAcrossThreads();
+  } catch (const std::exception& ex) {
+    std::cerr << "[FAIL] " << ex.what() << '\n';
+    return 1;
+  }
+
+  std::cout << "[PASS] test_fft\n";
+  return 0;
+}
@@ -1,9 +1,12 @@
 #include "aifr3d/loudness.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace {
@@ -27,6 +30,161 @@ std::vector<float> make_sine(double amp, double hz, std::size_t frames, double s
   return out;
 }
 
+// Scalar direct form I reference for the K-weighted power of each frame.
+std::vector<double> kWeightedPower(const std::vector<float>& interleaved, double sr) {
+  const auto stages = aifr3d::k_weighting_coefficients(sr);
+  const std::size_t frames = interleaved.size() / 2U;
+  std::vector<double> power(frames, 0.0);
+  for (std::size_t ch = 0; ch < 2U; ++ch) {
+    double x1[2] = {0.0, 0.0};
+    double x2[2] = {0.0, 0.0};
+    double y1[2] = {0.0, 0.0};
+    double y2[2] = {0.0, 0.0};
+    for (std::size_t i = 0; i < frames; ++i) {
+      double x = static_cast<double>(interleaved[i * 2U + ch]);
+      for (std::size_t s = 0; s < 2U; ++s) {
+        const auto& c = stages[s];
+        const double y = c.b0 * x + c.b1 * x1[s] + c.b2 * x2[s] - c.a1 * y1[s] - c.a2 * y2[s];
+        x2[s] = x1[s];
+        x1[s] = x;
+        y2[s] = y1[s];
+        y1[s] = y;
+        x = y;
+      }
+      power[i] += x * x;
+    }
+  }
+  return power;
+}
+
+double windowLufs(const std::vector<double>& power, std::size_t first, std::size_t frames) {
+  double sum = 0.0;
+  for (std::size_t i = first; i < first + frames; ++i) {
+    sum += power[i];
+  }
+  return -0.691 + 10.0 * std::log10(sum / static_cast<double>(frames));
+}
+
+void appendSine(std::vector<float>& out, double dbfs, double seconds, double sr) {
+  const double amp = std::pow(10.0, dbfs / 20.0);
+  const auto frames = static_cast<std::size_t>(seconds * sr);
+  for (std::size_t i = 0; i < frames; ++i) {
+    const float s = static_cast<float>(amp * std::sin(2.0 * kPi * 1000.0 * static_cast<double>(i) / sr));
+    out.push_back(s);
+    out.push_back(s);
+  }
+}
+
+void testKWeightingCoefficientsAt48k() {
+  const auto k = aifr3d::k_weighting_coefficients(48000.0);
+  const double expected[2][5] = {
+      {1.53512485958697, -2.69169618940638, 1.19839281085285, -1.69065929318241, 0.73248077421585},
+      {1.0, -2.0, 1.0, -1.99004745483398, 0.99007225036621},
+  };
+  for (std::size_t s = 0; s < 2U; ++s) {
+    const double got[5] = {k[s].b0, k[s].b1, k[s].b2, k[s].a1, k[s].a2};
+    for (std::size_t c = 0; c < 5U; ++c) {
+      require(std::fabs(got[c] - expected[s][c]) < 1e-8, "K-weighting coefficient mismatch at 48 kHz");
+    }
+  }
+}
+
+// EBU Tech 3341 minimum requirements, cases 1-4 (stereo 1 kHz sine, +-0.1 LU).
+void testTech3341IntegratedCases() {
+  for (const double sr : {44100.0, 48000.0, 96000.0}) {
+    std::vector<float> a;
+    appendSine(a, -23.0, 20.0, sr);
+    std::vector<float> b;
+    appendSine(b, -33.0, 20.0, sr);
+    std::vector<float> c;
+    appendSine(c, -36.0, 10.0, sr);
+    appendSine(c, -23.0, 60.0, sr);
+    appendSine(c, -36.0, 10.0, sr);
+    std::vector<float> d;
+    appendSine(d, -72.0, 10.0, sr);
+    appendSine(d, -36.0, 10.0, sr);
+    appendSine(d, -23.0, 60.0, sr);
+    appendSine(d, -36.0, 10.0, sr);
+    appendSine(d, -72.0, 10.0, sr);
+
+    const std::pair<const std::vector<float>*, double> cases[] = {{&a, -23.0}, {&b, -33.0}, {&c, -23.0}, {&d, -23.0}};
+    for (const auto& [program, expected] : cases) {
+      const auto m = aifr3d::compute_loudness_interleaved_stereo(program->data(), program->size() / 2U, sr);
+      require(m.integrated_lufs.has_value() && std::fabs(*m.integrated_lufs - expected) < 0.1,
+              "Tech 3341 integrated loudness out of tolerance at " + std::to_string(sr) + " Hz");
+    }
+  }
+}
+
+void testSlidingWindowsMatchBruteForce() {
+  constexpr double sr = 44100.0;
+  constexpr std::size_t hop = 4410;
+  constexpr std::size_t frames = hop * 73U + 1234U;
+  std::vector<float> program(frames * 2U);
+  for (std::size_t i = 0; i < frames; ++i) {
+    const double t = static_cast<double>(i) / sr;
+    const double env = 0.05 + 0.6 * std::fabs(std::sin(2.0 * kPi * 0.21 * t));
+    program[i * 2U] = static_cast<float>(env * std::sin(2.0 * kPi * 300.0 * t));
+    program[i * 2U + 1U] = static_cast<float>(env * 0.8 * std::sin(2.0 * kPi * 450.0 * t));
+  }
+
+  const auto power = kWeightedPower(program, sr);
+  const auto m = aifr3d::compute_loudness_interleaved_stereo(program.data(), frames, sr);
+  require(m.short_term_series_lufs.size() == 73U - 29U, "one short-term value per hop once 3 s are available");
+
+  double max_short = -1e9;
+  for (std::size_t w = 0; w < m.short_term_series_lufs.size(); ++w) {
+    const double expected = windowLufs(power, w * hop, 30U * hop);
+    require(m.short_term_series_lufs[w].has_value(), "short-term value missing");
+    require(std::fabs(*m.short_term_series_lufs[w] - expected) < 1e-9, "short-term window mismatch");
+    max_short = std::max(max_short, expected);
+  }
+  require(m.short_term_lufs.has_value() && std::fabs(*m.short_term_lufs - max_short) < 1e-9,
+          "short_term_lufs must be the series maximum");
+
+  double max_momentary = -1e9;
+  for (std::size_t w = 0; w + 4U <= 73U; ++w) {
+    max_momentary = std::max(max_momentary, windowLufs(power, w * hop, 4U * hop));
+  }
+  require(m.momentary_max_lufs.has_value() && std::fabs(*m.momentary_max_lufs - max_momentary) < 1e-9,
+          "momentary maximum mismatch");
+
+  const auto short_clip = aifr3d::compute_loudness_interleaved_stereo(program.data(), hop * 12U, sr);
+  require(short_clip.short_term_series_lufs.empty(), "no complete short-term window under 3 s");
+  require(short_clip.short_term_lufs.has_value() &&
+              std::fabs(*short_clip.short_term_lufs - windowLufs(power, 0, hop * 12U)) < 1e-9,
+          "short clip reports the window over every complete hop");
+}
+
+// EBU Tech 3342 minimum requirements, cases 1-4 (stereo 1 kHz sine, +-1 LU).
+void testTech3342LoudnessRange() {
+  constexpr double sr = 48000.0;
+  const std::vector<std::pair<std::vector<double>, double>> cases = {
+      {{-20.0, -30.0}, 10.0},
+      {{-20.0, -15.0}, 5.0},
+      {{-40.0, -20.0}, 20.0},
+      {{-50.0, -35.0, -20.0, -35.0, -50.0}, 15.0},
+  };
+  for (const auto& [levels, expected] : cases) {
+    std::vector<float> program;
+    for (const double dbfs : levels) {
+      appendSine(program, dbfs, 20.0, sr);
+    }
+    const auto m = aifr3d::compute_loudness_interleaved_stereo(program.data(), program.size() / 2U, sr);
+    require(m.loudness_range_lu.has_value() && std::fabs(*m.loudness_range_lu - expected) < 1.0,
+            "Tech 3342 loudness range out of tolerance, expected " + std::to_string(expected));
+  }
+
+  std::vector<float> steady;
+  appendSine(steady, -23.0, 10.0, sr);
+  const auto flat = aifr3d::compute_loudness_interleaved_stereo(steady.data(), steady.size() / 2U, sr);
+  require(flat.loudness_range_lu.has_value() && std::fabs(*flat.loudness_range_lu) < 0.02,
+          "steady tone must have no loudness range");
+
+  const auto short_clip = aifr3d::compute_loudness_interleaved_stereo(steady.data(), 48000U * 2U, sr);
+  require(!short_clip.loudness_range_lu.has_value(), "loudness range needs a complete short-term window");
+}
+
 }  // namespace
 
 int main() {
@@ -49,6 +207,13 @@ int main() {
     std::vector<float> silence(frames * 2U, 0.0f);
     const auto sil = aifr3d::compute_loudness_interleaved_stereo(silence.data(), frames, sr);
     require(!sil.integrated_lufs.has_value(), "silence integrated_lufs should be nullopt");
+    require(!sil.short_term_lufs.has_value() && !sil.momentary_max_lufs.has_value(),
+            "silence windows should be nullopt");
+
+    testSlidingWindowsMatchBruteForce();
+    testKWeightingCoefficientsAt48k();
+    testTech3341IntegratedCases();
+    testTech3342LoudnessRange();
   } catch (const std::exception& ex) {
     std::cerr << "[FAIL] " << ex.what() << '\n';
     return 1;
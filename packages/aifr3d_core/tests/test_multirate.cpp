@@ -0,0 +1,98 @@
+#include "aifr3d/multirate.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+void require(bool cond, const std::string& msg) {
+  if (!cond) {
+    throw std::runtime_error(msg);
+  }
+}
+
+// Decimated output of a sine fed in uneven blocks, with absolute indices.
+std::vector<double> decimate(int stages, double cycles_per_sample, std::size_t first, std::size_t count,
+                             std::vector<std::size_t>& indices) {
+  aifr3d::HalfBandCascade cascade;
+  cascade.reset(stages);
+  cascade.startAt(first);
+  std::vector<double> out;
+  indices.clear();
+  std::vector<double> block;
+  std::size_t step = 1;
+  for (std::size_t n = first; n < first + count;) {
+    const std::size_t len = std::min(step, first + count - n);
+    block.resize(len);
+    for (std::size_t i = 0; i < len; ++i) {
+      block[i] = std::sin(2.0 * kPi * cycles_per_sample * static_cast<double>(n + i));
+    }
+    std::size_t first_index = 0;
+    const std::size_t produced = cascade.process(block.data(), len, first_index);
+    for (std::size_t i = 0; i < produced; ++i) {
+      out.push_back(block[i]);
+      indices.push_back(first_index + i);
+    }
+    n += len;
+    step = (step * 5U + 3U) % 977U;
+  }
+  return out;
+}
+
+double rmsAfter(const std::vector<double>& x, std::size_t skip) {
+  double sum = 0.0;
+  for (std::size_t i = skip; i < x.size(); ++i) {
+    sum += x[i] * x[i];
+  }
+  return std::sqrt(sum / static_cast<double>(x.size() - skip));
+}
+
+void testPassbandAndStopband() {
+  std::vector<std::size_t> indices;
+  // 0.01 cycles/sample is well inside the passband of the last of 3 stages.
+  const auto pass = decimate(3, 0.01, 0, 80000, indices);
+  require(indices.size() == 10000U && indices.front() == 0U && indices.back() == 9999U, "one output per 8 inputs");
+  for (std::size_t i = 1; i < indices.size(); ++i) {
+    require(indices[i] == indices[i - 1U] + 1U, "indices must be consecutive across blocks");
+  }
+  require(std::fabs(rmsAfter(pass, 100) - std::sqrt(0.5)) < 1e-3, "passband must be flat");
+
+  // 0.45 cycles/sample would alias to 0.05 after the first halving.
+  const auto stop = decimate(1, 0.45, 0, 20000, indices);
+  require(rmsAfter(stop, 100) < 1e-4, "stopband must reach 80 dB");
+}
+
+void testAbsoluteGrid() {
+  std::vector<std::size_t> from_zero;
+  std::vector<std::size_t> late;
+  const auto serial = decimate(2, 0.03, 0, 40000, from_zero);
+  const std::size_t first = 12345;
+  const auto resumed = decimate(2, 0.03, first, 40000 - first, late);
+  require(late.front() == (first + 3U) / 4U, "first index must follow the absolute grid");
+  const std::size_t settled = aifr3d::HalfBandCascade::historyFramesFor(2) / 4U + 1U;
+  for (std::size_t i = settled; i < late.size(); ++i) {
+    require(resumed[i] == serial[late[i]], "settled outputs must not depend on the start frame");
+  }
+}
+
+}  // namespace
+
+int main() {
+  try {
+    testPassbandAndStopband();
+    testAbsoluteGrid();
+  } catch (const std::exception& ex) {
+    std::cerr << "[FAIL] " << ex.what() << '\n';
+    return 1;
+  }
+
+  std::cout << "[PASS] test_multirate\n";
+  return 0;
+}
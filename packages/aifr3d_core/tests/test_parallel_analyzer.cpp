@@ -0,0 +1,184 @@
+#include "aifr3d/analyzer.hpp"
+#include "aifr3d/thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kMergeTol = 1e-9;
+
+void require(bool cond, const std::string& msg) {
+  if (!cond) {
+    throw std::runtime_error(msg);
+  }
+}
+
+void requireSame(const std::optional<double>& a, const std::optional<double>& b, const std::string& name) {
+  require(a.has_value() == b.has_value(), name + " presence mismatch");
+  if (a.has_value()) {
+    require(*a == *b, name + " value mismatch");
+  }
+}
+
+void requireClose(const std::optional<double>& a, const std::optional<double>& b, const std::string& name) {
+  require(a.has_value() == b.has_value(), name + " presence mismatch");
+  if (a.has_value()) {
+    require(std::fabs(*a - *b) <= kMergeTol, name + " outside merge tolerance");
+  }
+}
+
+std::vector<float> makeProgram(std::size_t frames, double sr) {
+  std::vector<float> out(frames * 2U);
+  std::uint32_t seed = 12345U;
+  for (std::size_t i = 0; i < frames; ++i) {
+    seed = seed * 1664525U + 1013904223U;
+    const double noise = (static_cast<double>(seed >> 8U) / 16777216.0 - 0.5) * 0.05;
+    const double t = static_cast<double>(i) / sr;
+    const double env = 0.5 + 0.45 * std::sin(2.0 * kPi * 0.11 * t);
+    out[i * 2U] = static_cast<float>(env * 0.6 * std::sin(2.0 * kPi * 70.0 * t) + noise);
+    out[i * 2U + 1U] = static_cast<float>(env * 0.5 * std::sin(2.0 * kPi * 2500.0 * t + 0.4) - noise);
+  }
+  return out;
+}
+
+void requireAllSame(const aifr3d::AnalysisResult& a, const aifr3d::AnalysisResult& b) {
+  require(a.frame_count == b.frame_count, "frame_count mismatch");
+  requireSame(a.basic.peak_dbfs, b.basic.peak_dbfs, "basic.peak_dbfs");
+  requireSame(a.basic.rms_dbfs, b.basic.rms_dbfs, "basic.rms_dbfs");
+  requireSame(a.loudness.integrated_lufs, b.loudness.integrated_lufs, "integrated_lufs");
+  requireSame(a.loudness.short_term_lufs, b.loudness.short_term_lufs, "short_term_lufs");
+  requireSame(a.loudness.momentary_max_lufs, b.loudness.momentary_max_lufs, "momentary_max_lufs");
+  requireSame(a.loudness.loudness_range_lu, b.loudness.loudness_range_lu, "loudness_range_lu");
+  require(a.loudness.short_term_series_lufs == b.loudness.short_term_series_lufs, "short_term_series_lufs");
+  requireSame(a.true_peak.true_peak_dbfs, b.true_peak.true_peak_dbfs, "true_peak_dbfs");
+  requireSame(a.spectral.sub, b.spectral.sub, "spectral.sub");
+  requireSame(a.spectral.mid, b.spectral.mid, "spectral.mid");
+  requireSame(a.spectral.highmid, b.spectral.highmid, "spectral.highmid");
+  requireSame(a.stereo.correlation, b.stereo.correlation, "stereo.correlation");
+  requireSame(a.stereo.width_proxy, b.stereo.width_proxy, "stereo.width_proxy");
+  requireSame(a.dynamics.dr_proxy_db, b.dynamics.dr_proxy_db, "dr_proxy_db");
+}
+
+void testBitReproducibleAcrossThreadCounts() {
+  constexpr double sr = 48000.0;
+  constexpr std::size_t frames = 48000U * 12U + 4321U;  // three chunks, ragged tail
+  const auto program = makeProgram(frames, sr);
+
+  const aifr3d::Analyzer single(1);
+  const auto baseline = single.analyzeInterleavedStereo(program.data(), frames, sr);
+  for (std::size_t threads : {2U, 3U, 8U}) {
+    const aifr3d::Analyzer parallel(threads);
+    requireAllSame(parallel.analyzeInterleavedStereo(program.data(), frames, sr), baseline);
+  }
+
+  std::vector<float> left(frames);
+  std::vector<float> right(frames);
+  for (std::size_t i = 0; i < frames; ++i) {
+    left[i] = program[i * 2U];
+    right[i] = program[i * 2U + 1U];
+  }
+  requireAllSame(aifr3d::Analyzer(3).analyzePlanarStereo(left.data(), right.data(), frames, sr), baseline);
+
+  // Pulled block by block, as from a file decoder.
+  const aifr3d::Analyzer::PlanarBlockReader read = [&](std::size_t first, std::size_t n, float* l, float* r) {
+    require(n <= 2048U, "reader blocks are at most kAnalysisBlockFrames");
+    std::copy(left.begin() + static_cast<std::ptrdiff_t>(first),
+              left.begin() + static_cast<std::ptrdiff_t>(first + n), l);
+    std::copy(right.begin() + static_cast<std::ptrdiff_t>(first),
+              right.begin() + static_cast<std::ptrdiff_t>(first + n), r);
+  };
+  requireAllSame(aifr3d::Analyzer(3).analyzeBlocks(read, frames, sr), baseline);
+
+  // Chunked merge only reorders sums; window maxima and histograms are exact.
+  aifr3d::StreamingAnalyzer streaming;
+  streaming.reset(sr);
+  streaming.push(program.data(), frames);
+  const auto serial = streaming.finalize();
+  requireSame(baseline.basic.peak_dbfs, serial.basic.peak_dbfs, "serial peak_dbfs");
+  requireClose(baseline.basic.rms_dbfs, serial.basic.rms_dbfs, "serial rms_dbfs");
+  requireClose(baseline.loudness.integrated_lufs, serial.loudness.integrated_lufs, "serial integrated_lufs");
+  requireClose(baseline.loudness.short_term_lufs, serial.loudness.short_term_lufs, "serial short_term_lufs");
+  requireSame(baseline.true_peak.true_peak_dbfs, serial.true_peak.true_peak_dbfs, "serial true_peak_dbfs");
+  requireClose(baseline.spectral.sub, serial.spectral.sub, "serial spectral.sub");
+  requireClose(baseline.spectral.air, serial.spectral.air, "serial spectral.air");
+  requireClose(baseline.stereo.correlation, serial.stereo.correlation, "serial correlation");
+  requireSame(baseline.dynamics.dr_proxy_db, serial.dynamics.dr_proxy_db, "serial dr_proxy_db");
+}
+
+void testShortTermSeriesAcrossChunks() {
+  // At 192 kHz a chunk holds fewer hops than one 3 s window, so most windows
+  // are completed by merge() from more than one partial.
+  constexpr double sr = 192000.0;
+  constexpr std::size_t frames = (std::size_t{1} << 18U) * 3U + 5000U;
+  const auto program = makeProgram(frames, sr);
+
+  aifr3d::AnalysisOptions options;
+  options.groups.spectral = false;
+  options.groups.dynamics = false;
+  const auto chunked = aifr3d::Analyzer(options, 2).analyzeInterleavedStereo(program.data(), frames, sr);
+
+  aifr3d::StreamingAnalyzer streaming;
+  streaming.reset(sr, options);
+  streaming.push(program.data(), frames);
+  const auto serial = streaming.finalize();
+
+  const auto& a = chunked.loudness.short_term_series_lufs;
+  const auto& b = serial.loudness.short_term_series_lufs;
+  require(a.size() == frames / 19200U - 29U, "short-term series length");
+  require(a.size() == b.size(), "chunked and serial series length mismatch");
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    requireClose(a[i], b[i], "short-term series value");
+  }
+  requireClose(chunked.loudness.short_term_lufs, serial.loudness.short_term_lufs, "chunked short_term_lufs");
+  requireClose(chunked.loudness.momentary_max_lufs, serial.loudness.momentary_max_lufs, "chunked momentary_max_lufs");
+}
+
+void testThreadPoolCoversEveryIndexAndRethrows() {
+  aifr3d::ThreadPool pool(4);
+  std::vector<std::atomic<int>> hits(1000);
+  pool.parallelFor(hits.size(), [&](std::size_t i) { hits[i].fetch_add(1); });
+  for (const auto& h : hits) {
+    require(h.load() == 1, "each index must run exactly once");
+  }
+
+  bool threw = false;
+  try {
+    pool.parallelFor(64, [](std::size_t i) {
+      if (i == 17U) {
+        throw std::invalid_argument("boom");
+      }
+    });
+  } catch (const std::invalid_argument&) {
+    threw = true;
+  }
+  require(threw, "task exception must propagate");
+
+  std::atomic<std::size_t> sum{0};
+  pool.parallelFor(10, [&](std::size_t i) { sum.fetch_add(i); });
+  require(sum.load() == 45U, "pool must stay usable after an exception");
+}
+
+}  // namespace
+
+int main() {
+  try {
+    testBitReproducibleAcrossThreadCounts();
+    testShortTermSeriesAcrossChunks();
+    testThreadPoolCoversEveryIndexAndRethrows();
+  } catch (const std::exception& ex) {
+    std::cerr << "[FAIL] " << ex.what() << '\n';
+    return 1;
+  }
+
+  std::cout << "[PASS] test_parallel_analyzer\n";
+  return 0;
+}
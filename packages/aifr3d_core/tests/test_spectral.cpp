@@ -1,9 +1,15 @@
 #include "aifr3d/spectral.hpp"
 
+#include "aifr3d/analyzer.hpp"
+#include "aifr3d/spectral_plan.hpp"
+#include "aifr3d/thread_pool.hpp"
+
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace {
@@ -34,8 +40,230 @@ double value(const std::optional<double>& v) {
   return *v;
 }
 
+void testPlanTables() {
+  constexpr double sr = 44100.0;
+  const auto plan = aifr3d::SpectralPlan::get(2048, 1024, sr);
+  require(plan == aifr3d::SpectralPlan::get(2048, 1024, sr), "plans must be cached per key");
+  require(plan != aifr3d::SpectralPlan::get(2048, 1024, 48000.0), "sample rate is part of the key");
+  require(plan->bandCount() == 7U && plan->window().size() == 2048U, "broad layout shape");
+  require(plan->window()[0] == 0.0 && std::fabs(plan->window()[1023] - plan->window()[1024]) < 1e-15,
+          "window must be the symmetric Hann");
+
+  const auto& bands = plan->bands();
+  const auto& band_of_bin = plan->bandOfBin();
+  for (std::size_t bi = 0; bi < bands.size(); ++bi) {
+    require(bands[bi].begin < bands[bi].end, "every band must own bins at 2048/44.1k");
+    if (bi > 0U) {
+      require(bands[bi].begin == bands[bi - 1U].end, "adjacent bands must tile the bins");
+    }
+    for (std::size_t b = bands[bi].begin; b < bands[bi].end; ++b) {
+      require(band_of_bin[b] == bi && plan->weights()[bands[bi].offset + b - bands[bi].begin] == 1.0,
+              "broad bands must own whole bins");
+    }
+  }
+  const double first_hz = static_cast<double>(bands.front().begin) * sr / 2048.0;
+  require(first_hz >= 20.0 && first_hz - sr / 2048.0 < 20.0, "sub must start at the first bin >= 20 Hz");
+  require(band_of_bin[0] == aifr3d::SpectralPlan::kNoBand && band_of_bin[1024] == aifr3d::SpectralPlan::kNoBand,
+          "DC and Nyquist are not banded");
+}
+
+void testBandLayoutsFromOneStft() {
+  constexpr std::size_t frames = 48000;
+  constexpr double sr = 48000.0;
+  const auto wave = make_sine(0.5, 1000.0, frames, sr);
+
+  aifr3d::AnalysisOptions options;
+  options.spectral_band_layouts = {aifr3d::BandLayout::kThirdOctave, aifr3d::BandLayout::kSixthOctave,
+                                   aifr3d::BandLayout::kBark, aifr3d::BandLayout::kErb};
+  const auto multi = aifr3d::Analyzer(options, 2).analyzeInterleavedStereo(wave.data(), frames, sr);
+  const auto plain = aifr3d::Analyzer(2).analyzeInterleavedStereo(wave.data(), frames, sr);
+  require(plain.band_spectra.empty(), "no layouts requested, no spectra");
+  require(*multi.spectral.mid == *plain.spectral.mid && *multi.spectral.sub == *plain.spectral.sub,
+          "extra layouts must not change the 7-band view");
+
+  const std::size_t expected_counts[] = {31U, 61U, 24U, 41U};
+  require(multi.band_spectra.size() == 4U, "one spectrum per layout");
+  for (std::size_t i = 0; i < 4U; ++i) {
+    const auto& spectrum = multi.band_spectra[i];
+    require(spectrum.layout == options.spectral_band_layouts[i], "layout order");
+    require(spectrum.energy_db.size() == expected_counts[i] && spectrum.lower_hz.size() == expected_counts[i],
+            "band count for layout " + std::to_string(i));
+    std::size_t loudest = 0;
+    for (std::size_t b = 0; b < spectrum.energy_db.size(); ++b) {
+      if (value(spectrum.energy_db[b]) > value(spectrum.energy_db[loudest])) {
+        loudest = b;
+      }
+    }
+    require(spectrum.lower_hz[loudest] <= 1000.0 && spectrum.upper_hz[loudest] > 1000.0,
+            "1 kHz must peak in its own band for layout " + std::to_string(i));
+  }
+
+  // Fractional weights tile the spectrum, so the third-octave bands hold all
+  // of the tone's energy, as the 500-2000 Hz band does.
+  double third_total = 0.0;
+  for (const auto& e : multi.band_spectra[0].energy_db) {
+    third_total += e.has_value() ? std::pow(10.0, *e / 10.0) : 0.0;
+  }
+  require(std::fabs(10.0 * std::log10(third_total) - *plain.spectral.mid) < 0.01, "third-octave energy must add up");
+
+  const auto plan = aifr3d::SpectralPlan::get(1024, 512, sr, aifr3d::BandLayout::kThirdOctave);
+  std::vector<double> coverage(513U, 0.0);
+  for (std::size_t bi = 0; bi < plan->bandCount(); ++bi) {
+    const auto& band = plan->bands()[bi];
+    for (std::size_t b = band.begin; b < band.end; ++b) {
+      coverage[b] += plan->weights()[band.offset + b - band.begin];
+    }
+  }
+  for (std::size_t b = 2; b < 420U; ++b) {
+    require(std::fabs(coverage[b] - 1.0) < 1e-12, "bins inside 20 Hz..20 kHz must be fully weighted");
+  }
+}
+
+void testLowPathResolvesLowBands() {
+  constexpr double sr = 48000.0;
+  constexpr std::size_t frames = 48000U * 10U;
+  aifr3d::AnalysisOptions plain_options;
+  aifr3d::AnalysisOptions low_options;
+  low_options.spectral_low_path = true;
+  low_options.spectral_band_layouts = {aifr3d::BandLayout::kThirdOctave};
+
+  // 70 Hz sits one 1024-point bin above the sub/low edge.
+  const auto tone70 = make_sine(0.5, 70.0, frames, sr);
+  const auto plain = aifr3d::Analyzer(plain_options, 1).analyzeInterleavedStereo(tone70.data(), frames, sr);
+  const auto low = aifr3d::Analyzer(low_options, 1).analyzeInterleavedStereo(tone70.data(), frames, sr);
+  require(value(plain.spectral.sub) > value(plain.spectral.low) - 3.0, "full-rate sub should smear 70 Hz");
+  require(value(low.spectral.sub) < value(low.spectral.low) - 50.0, "low path must separate 70 Hz from sub");
+  const double plain_total = 10.0 * std::log10(std::pow(10.0, value(plain.spectral.sub) / 10.0) +
+                                               std::pow(10.0, value(plain.spectral.low) / 10.0));
+  require(std::fabs(value(low.spectral.low) - plain_total) < 0.5, "low path must stay on the full-rate energy scale");
+  require(*low.spectral.high == *plain.spectral.high, "bands above the crossover are untouched");
+
+  const auto chunked = aifr3d::Analyzer(low_options, 4).analyzeInterleavedStereo(tone70.data(), frames, sr);
+  require(*chunked.spectral.sub == *low.spectral.sub && *chunked.spectral.lowmid == *low.spectral.lowmid,
+          "chunked low path must match serial");
+  require(chunked.band_spectra[0].energy_db == low.band_spectra[0].energy_db, "chunked low path layouts");
+
+  // Shorter than one low-path frame: falls back to the full-rate bands.
+  const auto short_tone = make_sine(0.5, 70.0, 8000U, sr);
+  const auto short_low = aifr3d::Analyzer(low_options).analyzeInterleavedStereo(short_tone.data(), 8000U, sr);
+  const auto short_plain = aifr3d::Analyzer().analyzeInterleavedStereo(short_tone.data(), 8000U, sr);
+  require(*short_low.spectral.sub == *short_plain.spectral.sub, "short input must fall back to full rate");
+}
+
 }  // namespace
 
+// Seven broad bands as a vector, for whole-spectrum comparisons.
+std::vector<std::optional<double>> broad(const aifr3d::SpectralBands& b) {
+  return {b.sub, b.low, b.lowmid, b.mid, b.highmid, b.high, b.air};
+}
+
+bool close_bands(const aifr3d::SpectralBands& a, const aifr3d::SpectralBands& b, double tolerance_db) {
+  const auto x = broad(a);
+  const auto y = broad(b);
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    if (x[i].has_value() != y[i].has_value() || std::fabs(value(x[i]) - value(y[i])) > tolerance_db) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void testChannelSpectraFromOneFft() {
+  constexpr double sr = 48000.0;
+  constexpr std::size_t frames = 600000;
+  // 1 kHz on the left, 100 Hz on the right.
+  std::vector<float> wave(frames * 2U);
+  std::vector<float> left_only(frames * 2U);
+  std::vector<float> right_only(frames * 2U);
+  for (std::size_t i = 0; i < frames; ++i) {
+    const double t = static_cast<double>(i) / sr;
+    const auto l = static_cast<float>(0.5 * std::sin(2.0 * kPi * 1000.0 * t));
+    const auto r = static_cast<float>(0.5 * std::sin(2.0 * kPi * 100.0 * t));
+    wave[i * 2U] = l;
+    wave[i * 2U + 1U] = r;
+    left_only[i * 2U] = l;
+    left_only[i * 2U + 1U] = l;
+    right_only[i * 2U] = r;
+    right_only[i * 2U + 1U] = r;
+  }
+
+  aifr3d::AnalysisOptions options;
+  options.spectral_channels = true;
+  const auto plain = aifr3d::Analyzer(1).analyzeInterleavedStereo(wave.data(), frames, sr);
+  require(!plain.channel_spectra.has_value(), "channel spectra are opt-in");
+  const auto split = aifr3d::Analyzer(options, 1).analyzeInterleavedStereo(wave.data(), frames, sr);
+  require(split.channel_spectra.has_value(), "channel spectra requested");
+  const aifr3d::ChannelSpectra& ch = *split.channel_spectra;
+
+  // Each separated channel equals the mono analysis of that channel alone.
+  const auto l_ref = aifr3d::Analyzer(1).analyzeInterleavedStereo(left_only.data(), frames, sr);
+  const auto r_ref = aifr3d::Analyzer(1).analyzeInterleavedStereo(right_only.data(), frames, sr);
+  require(close_bands(ch.left, l_ref.spectral, 1e-6), "left spectrum must match a left-only analysis");
+  require(close_bands(ch.right, r_ref.spectral, 1e-6), "right spectrum must match a right-only analysis");
+  require(value(ch.left.mid) > value(ch.left.low) + 40.0, "1 kHz stays on the left");
+  require(value(ch.right.low) > value(ch.right.mid) + 40.0, "100 Hz stays on the right");
+  require(close_bands(ch.mid, plain.spectral, 1e-9), "mid must match the default mono bands");
+  require(close_bands(split.spectral, plain.spectral, 1e-9), "mono bands must match the default path");
+  // Tones in disjoint bands put the same energy into mid and side.
+  require(std::fabs(value(ch.side.low) - value(ch.mid.low)) < 0.01 &&
+              std::fabs(value(ch.side.mid) - value(ch.mid.mid)) < 0.01,
+          "disjoint tones must split evenly between mid and side");
+
+  // Identical channels leave side empty up to rounding.
+  const auto mono = aifr3d::Analyzer(options, 1).analyzeInterleavedStereo(left_only.data(), frames, sr);
+  require(value(mono.channel_spectra->side.mid) < value(mono.channel_spectra->mid.mid) - 200.0,
+          "identical channels must have no side energy");
+
+  const auto chunked = aifr3d::Analyzer(options, 4).analyzeInterleavedStereo(wave.data(), frames, sr);
+  for (const auto& [a, b] : {std::pair{chunked.channel_spectra->left, ch.left},
+                             std::pair{chunked.channel_spectra->side, ch.side}}) {
+    require(broad(a) == broad(b), "chunked channel spectra must match serial");
+  }
+}
+
+void testParallelSegmentsAreDeterministic() {
+  constexpr double sr = 44100.0;
+  // Several segments with a ragged tail, and content that differs per segment.
+  const std::size_t frames = 3U * aifr3d::kParallelSpectralSegmentFrames + 12345U;
+  std::vector<float> wave(frames * 2U);
+  for (std::size_t i = 0; i < frames; ++i) {
+    const double t = static_cast<double>(i) / sr;
+    wave[i * 2U] = static_cast<float>(0.4 * std::sin(2.0 * kPi * (80.0 + 3.0 * t) * t));
+    wave[i * 2U + 1U] = static_cast<float>(0.3 * std::sin(2.0 * kPi * 5000.0 * t));
+  }
+
+  const auto serial = aifr3d::compute_spectral_bands_interleaved_stereo(wave.data(), frames, sr);
+  aifr3d::ThreadPool one(1);
+  aifr3d::ThreadPool three(3);
+  const auto a = aifr3d::compute_spectral_bands_interleaved_stereo(wave.data(), frames, sr, one);
+  const auto b = aifr3d::compute_spectral_bands_interleaved_stereo(wave.data(), frames, sr, three);
+
+  std::vector<float> left(frames);
+  std::vector<float> right(frames);
+  for (std::size_t i = 0; i < frames; ++i) {
+    left[i] = wave[i * 2U];
+    right[i] = wave[i * 2U + 1U];
+  }
+  const auto c = aifr3d::compute_spectral_bands_planar_stereo(left.data(), right.data(), frames, sr, three);
+
+  const std::vector<std::pair<std::optional<double>, std::optional<double>>> serial_vs_a{
+      {serial.sub, a.sub},       {serial.low, a.low},   {serial.lowmid, a.lowmid}, {serial.mid, a.mid},
+      {serial.highmid, a.highmid}, {serial.high, a.high}, {serial.air, a.air}};
+  for (const auto& [s, p] : serial_vs_a) {
+    require(std::abs(value(s) - value(p)) < 1e-9, "parallel bands should match serial to rounding");
+  }
+  const std::vector<std::pair<std::optional<double>, std::optional<double>>> a_vs_b{
+      {a.sub, b.sub}, {a.low, b.low}, {a.lowmid, b.lowmid}, {a.mid, b.mid},
+      {a.highmid, b.highmid}, {a.high, b.high}, {a.air, b.air}};
+  for (const auto& [x, y] : a_vs_b) {
+    require(value(x) == value(y), "parallel bands should not depend on the thread count");
+  }
+  require(value(b.mid) == value(c.mid) && value(b.sub) == value(c.sub), "planar and interleaved should agree");
+
+  const auto empty = aifr3d::compute_spectral_bands_planar_stereo(left.data(), right.data(), 0, sr, three);
+  require(!empty.mid.has_value(), "empty input should yield no bands");
+}
+
 int main() {
   try {
     constexpr std::size_t frames = 16384;
@@ -57,6 +285,11 @@ int main() {
       const auto b = aifr3d::compute_spectral_bands_interleaved_stereo(wave.data(), frames, sr);
       require(value(b.high) > value(b.mid), "8kHz should favor high over mid");
     }
+    testPlanTables();
+    testBandLayoutsFromOneStft();
+    testLowPathResolvesLowBands();
+    testChannelSpectraFromOneFft();
+    testParallelSegmentsAreDeterministic();
   } catch (const std::exception& ex) {
     std::cerr << "[FAIL] " << ex.what() << '\n';
     return 1;
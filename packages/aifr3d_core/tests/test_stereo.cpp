@@ -1,6 +1,11 @@
 #include "aifr3d/stereo.hpp"
 
+#include "aifr3d/compare.hpp"
+#include "aifr3d/scoring.hpp"
+
 #include <cmath>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <stdexcept>
 #include <string>
@@ -16,6 +21,73 @@ void require(bool cond, const std::string& msg) {
   }
 }
 
+// An anti-phase 80 Hz tone under an in-phase 3 kHz tone of equal power: the
+// broadband correlation is near zero while each band is fully (anti)correlated.
+void testBandCorrelationFromCrossSpectrum() {
+  constexpr double sr = 48000.0;
+  constexpr std::size_t frames = 48000U * 8U;
+  std::vector<float> wave(frames * 2U);
+  for (std::size_t i = 0; i < frames; ++i) {
+    const double t = static_cast<double>(i) / sr;
+    const double low = 0.3 * std::sin(2.0 * kPi * 80.0 * t);
+    const double high = 0.3 * std::sin(2.0 * kPi * 3000.0 * t);
+    wave[i * 2U] = static_cast<float>(high + low);
+    wave[i * 2U + 1U] = static_cast<float>(high - low);
+  }
+
+  const auto plain = aifr3d::Analyzer(1).analyzeInterleavedStereo(wave.data(), frames, sr);
+  require(!plain.stereo.band_correlation.low.has_value(), "per-band stereo needs spectral_channels");
+
+  aifr3d::AnalysisOptions options;
+  options.spectral_channels = true;
+  const auto result = aifr3d::Analyzer(options, 1).analyzeInterleavedStereo(wave.data(), frames, sr);
+  const aifr3d::StereoMetrics& st = result.stereo;
+  require(std::fabs(*st.correlation) < 0.05, "broadband correlation should hide the low-end problem");
+  require(*st.band_correlation.low < -0.99, "80 Hz band must read anti-phase");
+  require(*st.band_correlation.highmid > 0.99, "3 kHz band must read in phase");
+  require(*st.band_width.low > 0.99, "anti-phase band is all side");
+  require(*st.band_width.highmid < 0.01, "in-phase band is all mid");
+
+  const auto chunked = aifr3d::Analyzer(options, 4).analyzeInterleavedStereo(wave.data(), frames, sr);
+  require(*chunked.stereo.band_correlation.low == *st.band_correlation.low &&
+              *chunked.stereo.band_width.highmid == *st.band_width.highmid,
+          "chunked per-band stereo must match serial");
+
+  // Per-band targets load from flat correlation_<band> / width_<band> keys.
+  const auto path = std::filesystem::temp_directory_path() / "aifr3d_test_stereo_profile.json";
+  {
+    std::ofstream out(path);
+    out << R"({"schema_version": "1.0.0", "genre": "test", "profile_id": "bands_v1",
+              "created_at_utc": "2024-01-01T00:00:00Z", "track_count": 1,
+              "metrics": {"stereo": {
+                "correlation": {"mean": 0.0, "stddev": 0.2},
+                "correlation_low": {"mean": 0.9, "stddev": 0.1, "target_min": 0.7, "target_max": 1.0},
+                "width_highmid": {"mean": 0.0, "stddev": 0.1}}}})";
+  }
+  const auto profile = aifr3d::loadBenchmarkProfileFromJson(path.string());
+  std::filesystem::remove(path);
+  require(profile.metrics.stereo.band_correlation.low.has_value() &&
+              !profile.metrics.stereo.band_correlation.mid.has_value(),
+          "band targets must load by key");
+
+  const auto cmp = aifr3d::compareAgainstBenchmark(result, profile);
+  require(cmp.stereo.band_correlation.low.in_range == aifr3d::InRangeClass::NEEDS_ATTENTION,
+          "anti-phase low end must need attention");
+  require(cmp.stereo.band_width.highmid.in_range == aifr3d::InRangeClass::IN_RANGE, "in-phase highmid width");
+  // basic, loudness, spectral, stereo (three broadband + two targeted bands), dynamics.
+  const auto& sum = cmp.summary;
+  require(sum.in_range_count + sum.slightly_off_count + sum.needs_attention_count + sum.unknown_count ==
+              3 + 3 + 7 + (3 + 2) + 4,
+          "only targeted bands are tallied");
+
+  const auto without_bands = aifr3d::compareAgainstBenchmark(plain, profile);
+  require(without_bands.stereo.band_correlation.low.in_range == aifr3d::InRangeClass::UNKNOWN,
+          "unmeasured band must be UNKNOWN");
+  require(aifr3d::computeScore(cmp).subscores.at("stereo") <
+              aifr3d::computeScore(without_bands).subscores.at("stereo"),
+          "a failing band must lower the stereo subscore");
+}
+
 }  // namespace
 
 int main() {
@@ -49,6 +121,8 @@ int main() {
     require(*mo.correlation < -0.999, "L=-R should be highly anti-correlated");
     require(mo.width_proxy.has_value(), "opp width missing");
     require(*mo.width_proxy > 0.99, "L=-R should have high width");
+
+    testBandCorrelationFromCrossSpectrum();
   } catch (const std::exception& ex) {
     std::cerr << "[FAIL] " << ex.what() << '\n';
     return 1;
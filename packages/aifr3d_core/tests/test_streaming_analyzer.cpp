@@ -0,0 +1,160 @@
+#include "aifr3d/analyzer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kDrHistogramTol = 0.03;
+
+void require(bool cond, const std::string& msg) {
+  if (!cond) {
+    throw std::runtime_error(msg);
+  }
+}
+
+void requireSame(const std::optional<double>& a, const std::optional<double>& b, const std::string& name) {
+  require(a.has_value() == b.has_value(), name + " presence mismatch");
+  if (a.has_value()) {
+    require(*a == *b, name + " value mismatch");
+  }
+}
+
+std::vector<float> makeProgram(std::size_t frames, double sr) {
+  std::vector<float> out(frames * 2U);
+  for (std::size_t i = 0; i < frames; ++i) {
+    const double t = static_cast<double>(i) / sr;
+    const double env = 0.55 + 0.4 * std::sin(2.0 * kPi * 0.3 * t);
+    out[i * 2U] = static_cast<float>(env * 0.7 * std::sin(2.0 * kPi * 55.0 * t));
+    out[i * 2U + 1U] = static_cast<float>(env * 0.5 * std::sin(2.0 * kPi * 4400.0 * t + 1.0));
+  }
+  return out;
+}
+
+std::optional<double> exactDrProxy(const std::vector<float>& interleaved) {
+  std::vector<double> abs_values;
+  abs_values.reserve(interleaved.size());
+  for (float s : interleaved) {
+    abs_values.push_back(std::fabs(static_cast<double>(s)));
+  }
+  std::sort(abs_values.begin(), abs_values.end());
+  const auto n = static_cast<double>(abs_values.size() - 1U);
+  const double p10 = abs_values[static_cast<std::size_t>(n * 0.10)];
+  const double p95 = abs_values[static_cast<std::size_t>(n * 0.95)];
+  if (!(p10 > 0.0) || !(p95 > 0.0)) {
+    return std::nullopt;
+  }
+  return 20.0 * std::log10(p95) - 20.0 * std::log10(p10);
+}
+
+void testIrregularPushesMatchOneShot() {
+  constexpr std::size_t frames = 48000U * 4U + 777U;
+  constexpr double sr = 48000.0;
+  const auto program = makeProgram(frames, sr);
+
+  const aifr3d::Analyzer analyzer;
+  const auto one_shot = analyzer.analyzeInterleavedStereo(program.data(), frames, sr);
+
+  aifr3d::StreamingAnalyzer streaming;
+  streaming.reset(sr);
+  const std::size_t pattern[] = {1U, 7U, 511U, 4096U, 2400U, 3U, 10000U};
+  std::size_t pos = 0;
+  std::size_t k = 0;
+  while (pos < frames) {
+    const std::size_t n = std::min(pattern[k % std::size(pattern)], frames - pos);
+    streaming.push(program.data() + pos * 2U, n);
+    pos += n;
+    ++k;
+  }
+  const auto streamed = streaming.finalize();
+
+  require(streamed.frame_count == frames, "frame_count mismatch");
+  requireSame(streamed.basic.peak_dbfs, one_shot.basic.peak_dbfs, "basic.peak_dbfs");
+  requireSame(streamed.basic.rms_dbfs, one_shot.basic.rms_dbfs, "basic.rms_dbfs");
+  requireSame(streamed.loudness.integrated_lufs, one_shot.loudness.integrated_lufs, "integrated_lufs");
+  requireSame(streamed.loudness.short_term_lufs, one_shot.loudness.short_term_lufs, "short_term_lufs");
+  requireSame(streamed.true_peak.true_peak_dbfs, one_shot.true_peak.true_peak_dbfs, "true_peak_dbfs");
+  requireSame(streamed.spectral.sub, one_shot.spectral.sub, "spectral.sub");
+  requireSame(streamed.spectral.highmid, one_shot.spectral.highmid, "spectral.highmid");
+  requireSame(streamed.stereo.correlation, one_shot.stereo.correlation, "stereo.correlation");
+  requireSame(streamed.dynamics.dr_proxy_db, one_shot.dynamics.dr_proxy_db, "dr_proxy_db");
+
+  const auto exact_dr = exactDrProxy(program);
+  require(exact_dr.has_value() && streamed.dynamics.dr_proxy_db.has_value(), "dr_proxy_db missing");
+  require(std::fabs(*streamed.dynamics.dr_proxy_db - *exact_dr) <= kDrHistogramTol,
+          "histogram dr_proxy_db outside documented tolerance");
+}
+
+void testResetStartsNewStream() {
+  constexpr std::size_t frames = 8192;
+  constexpr double sr = 44100.0;
+  const auto program = makeProgram(frames, sr);
+
+  aifr3d::StreamingAnalyzer streaming;
+  streaming.reset(sr);
+  streaming.push(program.data(), frames);
+  const auto first = streaming.finalize();
+
+  streaming.reset(sr);
+  streaming.push(program.data(), frames);
+  const auto second = streaming.finalize();
+
+  require(first.frame_count == second.frame_count, "frame_count drift after reset");
+  requireSame(first.loudness.integrated_lufs, second.loudness.integrated_lufs, "integrated_lufs after reset");
+  requireSame(first.dynamics.dr_proxy_db, second.dynamics.dr_proxy_db, "dr_proxy_db after reset");
+}
+
+void testInvalidUsage() {
+  aifr3d::StreamingAnalyzer streaming;
+  bool threw = false;
+  try {
+    streaming.push(nullptr, 0);
+  } catch (const std::logic_error&) {
+    threw = true;
+  }
+  require(threw, "push before reset must throw");
+
+  threw = false;
+  try {
+    streaming.reset(0.0);
+  } catch (const std::invalid_argument&) {
+    threw = true;
+  }
+  require(threw, "non-positive sample rate must throw");
+
+  streaming.reset(48000.0);
+  threw = false;
+  try {
+    streaming.push(nullptr, 16);
+  } catch (const std::invalid_argument&) {
+    threw = true;
+  }
+  require(threw, "null input with frames must throw");
+
+  const auto empty = streaming.finalize();
+  require(empty.frame_count == 0U, "empty stream frame_count");
+  require(!empty.basic.peak_dbfs.has_value(), "empty stream peak must be nullopt");
+}
+
+}  // namespace
+
+int main() {
+  try {
+    testIrregularPushesMatchOneShot();
+    testResetStartsNewStream();
+    testInvalidUsage();
+  } catch (const std::exception& ex) {
+    std::cerr << "[FAIL] " << ex.what() << '\n';
+    return 1;
+  }
+
+  std::cout << "[PASS] test_streaming_analyzer\n";
+  return 0;
+}
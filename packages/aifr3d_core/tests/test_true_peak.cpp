@@ -1,6 +1,10 @@
 #include "aifr3d/true_peak.hpp"
 
+#include "aifr3d/analyzer.hpp"
+
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <iostream>
 #include <stdexcept>
 #include <string>
@@ -8,6 +12,8 @@
 
 namespace {
 
+constexpr double kPi = 3.14159265358979323846;
+
 void require(bool cond, const std::string& msg) {
   if (!cond) {
     throw std::runtime_error(msg);
@@ -25,25 +31,184 @@ std::optional<double> sample_peak_db(const std::vector<float>& interleaved) {
   return 20.0 * std::log10(peak);
 }
 
-}  // namespace
+void testAlternatingStaysAboveSamplePeak() {
+  constexpr std::size_t frames = 1024;
+  std::vector<float> interleaved(frames * 2U, 0.0f);
 
-int main() {
-  try {
-    constexpr std::size_t frames = 1024;
-    std::vector<float> interleaved(frames * 2U, 0.0f);
+  for (std::size_t i = 0; i < frames; ++i) {
+    const float l = (i % 2U == 0U) ? 0.9f : -0.9f;
+    const float r = (i % 2U == 0U) ? -0.9f : 0.9f;
+    interleaved[i * 2U] = l;
+    interleaved[i * 2U + 1U] = r;
+  }
+
+  const auto tp = aifr3d::compute_true_peak_interleaved_stereo(interleaved.data(), frames, 4);
+  const auto sp = sample_peak_db(interleaved);
+  require(tp.true_peak_dbfs.has_value(), "true peak should exist");
+  require(sp.has_value(), "sample peak should exist");
+  require(*tp.true_peak_dbfs + 1e-12 >= *sp, "true peak must be >= sample peak");
+}
+
+// A quarter-rate sine sampled 45 degrees off its crests: every sample sits
+// 3 dB below the real peak, which lies exactly halfway between samples. The
+// ends are faded so the onset adds no overshoot of its own.
+void testFindsInterSamplePeaks() {
+  constexpr std::size_t frames = 4800;
+  constexpr std::size_t fade = 480;
+  std::vector<float> left(frames);
+  std::vector<float> right(frames, 0.0f);
+  for (std::size_t i = 0; i < frames; ++i) {
+    const std::size_t edge = std::min(i, frames - 1U - i);
+    const double gain =
+        edge < fade ? 0.5 - 0.5 * std::cos(kPi * static_cast<double>(edge) / static_cast<double>(fade)) : 1.0;
+    left[i] = static_cast<float>(gain * 0.5 * std::sin(0.5 * kPi * static_cast<double>(i) + 0.25 * kPi));
+  }
+  const double expected = 20.0 * std::log10(0.5);
+
+  const auto sample_only = aifr3d::compute_true_peak_planar_stereo(left.data(), right.data(), frames, 1);
+  require(sample_only.true_peak_dbfs.has_value() && std::fabs(*sample_only.true_peak_dbfs - (expected - 3.0103)) < 0.01,
+          "factor 1 must report the sample peak");
 
+  for (const int factor : {2, 4, 8}) {
+    const auto tp = aifr3d::compute_true_peak_planar_stereo(left.data(), right.data(), frames, factor);
+    require(tp.oversample_factor == factor, "factor must be reported");
+    require(tp.true_peak_dbfs.has_value() && std::fabs(*tp.true_peak_dbfs - expected) < 0.05,
+            "inter-sample peak missed at x" + std::to_string(factor));
+  }
+}
+
+// High-frequency tones whose crests fall halfway between samples, where the
+// interpolator's passband error is largest. The documented bound is 0.01 dB
+// up to 0.4 fs.
+void testHighFrequencyCrestsWithinPassband() {
+  constexpr std::size_t frames = 9600;
+  constexpr std::size_t fade = 960;
+  std::vector<float> left(frames);
+  std::vector<float> right(frames, 0.0f);
+  const double expected = 20.0 * std::log10(0.5);
+  for (const double cycles_per_frame : {0.375, 0.4}) {
+    // A crest at i = 0.5, so every sample misses it.
+    const double phase = 0.5 * kPi - kPi * cycles_per_frame;
     for (std::size_t i = 0; i < frames; ++i) {
-      const float l = (i % 2U == 0U) ? 0.9f : -0.9f;
-      const float r = (i % 2U == 0U) ? -0.9f : 0.9f;
-      interleaved[i * 2U] = l;
-      interleaved[i * 2U + 1U] = r;
+      const std::size_t edge = std::min(i, frames - 1U - i);
+      const double gain =
+          edge < fade ? 0.5 - 0.5 * std::cos(kPi * static_cast<double>(edge) / static_cast<double>(fade)) : 1.0;
+      left[i] = static_cast<float>(gain * 0.5 * std::sin(2.0 * kPi * cycles_per_frame * static_cast<double>(i) + phase));
     }
+    for (const int factor : {2, 4, 8}) {
+      const auto tp = aifr3d::compute_true_peak_planar_stereo(left.data(), right.data(), frames, factor);
+      require(tp.true_peak_dbfs.has_value() && std::fabs(*tp.true_peak_dbfs - expected) < 0.01,
+              "crest at " + std::to_string(cycles_per_frame) + " fs off by more than 0.01 dB at x" +
+                  std::to_string(factor));
+    }
+  }
+}
+
+void testBlockSplitsDoNotChangeResult() {
+  constexpr std::size_t frames = 9000;
+  std::vector<float> left(frames);
+  std::vector<float> right(frames);
+  for (std::size_t i = 0; i < frames; ++i) {
+    const double t = static_cast<double>(i);
+    left[i] = static_cast<float>(0.7 * std::sin(0.37 * t) * std::sin(0.001 * t));
+    right[i] = static_cast<float>(0.6 * std::sin(1.9 * t + 0.3));
+  }
+  const auto one_shot = aifr3d::compute_true_peak_planar_stereo(left.data(), right.data(), frames, 4);
 
-    const auto tp = aifr3d::compute_true_peak_interleaved_stereo(interleaved.data(), frames, 4);
-    const auto sp = sample_peak_db(interleaved);
-    require(tp.true_peak_dbfs.has_value(), "true peak should exist");
-    require(sp.has_value(), "sample peak should exist");
-    require(*tp.true_peak_dbfs + 1e-12 >= *sp, "true peak must be >= sample peak");
+  aifr3d::TruePeakAccumulator acc;
+  acc.reset(4);
+  std::size_t pos = 0;
+  std::size_t step = 1;
+  while (pos < frames) {
+    const std::size_t n = std::min(step, frames - pos);
+    acc.push(left.data() + pos, right.data() + pos, n);
+    pos += n;
+    step = (step * 7U + 3U) % 3001U;
+  }
+  const auto split = acc.finalize();
+  require(split.true_peak_dbfs.has_value() && *split.true_peak_dbfs == *one_shot.true_peak_dbfs,
+          "push boundaries must not change the true peak");
+}
+
+// Dense program with a quiet passage, then a late quarter-rate burst whose
+// samples stay below the earlier sample peak while its true peak exceeds it.
+std::vector<float> makeMaster(std::size_t frames, bool right_channel) {
+  std::vector<float> out(frames);
+  std::uint32_t state = right_channel ? 0x9E3779B9U : 0x12345678U;
+  for (std::size_t i = 0; i < frames; ++i) {
+    state = state * 1664525U + 1013904223U;
+    const double noise = static_cast<double>(state >> 8U) / static_cast<double>(1U << 24U) - 0.5;
+    const double t = static_cast<double>(i) / 48000.0;
+    const double env = (t > 4.0 && t < 6.0) ? 0.05 : 0.4 + 0.2 * std::sin(2.0 * kPi * 0.7 * t);
+    out[i] = static_cast<float>(env * (noise + 0.8 * std::sin(2.0 * kPi * 110.0 * t)));
+  }
+  const std::size_t burst = frames - 20000U;
+  for (std::size_t i = 0; i < 4000U; ++i) {
+    const double fade = std::sin(kPi * static_cast<double>(i) / 4000.0);
+    out[burst + i] =
+        static_cast<float>(0.9 * fade * std::sin(0.5 * kPi * static_cast<double>(i) + 0.25 * kPi));
+  }
+  return out;
+}
+
+void testPruningMatchesExhaustive() {
+  constexpr std::size_t frames = 48000U * 10U;
+  const auto left = makeMaster(frames, false);
+  const auto right = makeMaster(frames, true);
+  std::vector<float> interleaved(frames * 2U);
+  for (std::size_t i = 0; i < frames; ++i) {
+    interleaved[i * 2U] = left[i];
+    interleaved[i * 2U + 1U] = right[i];
+  }
+
+  for (const int factor : {2, 4, 8}) {
+    aifr3d::TruePeakAccumulator pruned;
+    aifr3d::TruePeakAccumulator exhaustive;
+    pruned.reset(factor, true);
+    exhaustive.reset(factor, false);
+    for (std::size_t pos = 0; pos < frames; pos += 2048U) {
+      const std::size_t n = std::min<std::size_t>(2048U, frames - pos);
+      pruned.push(left.data() + pos, right.data() + pos, n);
+      exhaustive.push(left.data() + pos, right.data() + pos, n);
+    }
+    const auto a = pruned.finalize();
+    const auto b = exhaustive.finalize();
+    require(a.true_peak_dbfs.has_value() && b.true_peak_dbfs.has_value() && *a.true_peak_dbfs == *b.true_peak_dbfs,
+            "pruned true peak differs at x" + std::to_string(factor));
+    require(*b.true_peak_dbfs > 20.0 * std::log10(0.9) - 0.1, "the late burst must set the true peak");
+
+    aifr3d::AnalysisOptions options;
+    options.true_peak_oversample_factor = factor;
+    options.true_peak_pruning = false;
+    const auto full = aifr3d::Analyzer(options, 3).analyzeInterleavedStereo(interleaved.data(), frames, 48000.0);
+    options.true_peak_pruning = true;
+    const auto fast = aifr3d::Analyzer(options, 3).analyzeInterleavedStereo(interleaved.data(), frames, 48000.0);
+    require(*fast.true_peak.true_peak_dbfs == *full.true_peak.true_peak_dbfs,
+            "pruned chunked true peak differs at x" + std::to_string(factor));
+  }
+}
+
+void testUnsupportedFactorThrows() {
+  bool threw = false;
+  try {
+    aifr3d::TruePeakAccumulator acc;
+    acc.reset(3);
+  } catch (const std::invalid_argument&) {
+    threw = true;
+  }
+  require(threw, "factor 3 must throw");
+}
+
+}  // namespace
+
+int main() {
+  try {
+    testAlternatingStaysAboveSamplePeak();
+    testFindsInterSamplePeaks();
+    testHighFrequencyCrestsWithinPassband();
+    testBlockSplitsDoNotChangeResult();
+    testPruningMatchesExhaustive();
+    testUnsupportedFactorThrows();
   } catch (const std::exception& ex) {
     std::cerr << "[FAIL] " << ex.what() << '\n';
     return 1;
@@ -1,13 +1,15 @@
 #include "aifr3d/analyzer.hpp"
 #include "aifr3d/benchmark_profile.hpp"
 #include "aifr3d/compare.hpp"
+#include "aifr3d/io/flac_reader.hpp"
+#include "aifr3d/io/read_ahead.hpp"
+#include "aifr3d/io/wav_reader.hpp"
+#include "aifr3d/io/wav_stream.hpp"
 #include "aifr3d/issues.hpp"
 #include "aifr3d/reference_compare.hpp"
 #include "aifr3d/scoring.hpp"
 
-#include <algorithm>
-#include <cstdint>
-#include <cstring>
+#include <cstddef>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
@@ -17,135 +19,65 @@
 #include <string>
 #include <vector>
 
-namespace {
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#endif
 
-struct WavData {
-  double sample_rate_hz{0.0};
-  std::size_t frame_count{0};
-  std::vector<float> interleaved_stereo;
-};
+namespace {
 
-std::uint16_t read_u16_le(const std::vector<std::uint8_t>& d, std::size_t off) {
-  return static_cast<std::uint16_t>(d[off] | (static_cast<std::uint16_t>(d[off + 1]) << 8));
+// Decodes straight from the mapped file, one analysis block at a time.
+aifr3d::AnalysisResult analyze_wav_file(const aifr3d::Analyzer& analyzer,
+                                        const std::string& path,
+                                        aifr3d::AnalyzerWorkspace& workspace) {
+  const aifr3d::io::WavReader wav(path);
+  return analyzer.analyzeBlocks(
+      [&](std::size_t first, std::size_t frames, float* left, float* right) {
+        wav.readStereo(first, frames, left, right);
+      },
+      wav.frameCount(), wav.sampleRateHz(), workspace);
 }
 
-std::uint32_t read_u32_le(const std::vector<std::uint8_t>& d, std::size_t off) {
-  return static_cast<std::uint32_t>(d[off] | (static_cast<std::uint32_t>(d[off + 1]) << 8) |
-                                    (static_cast<std::uint32_t>(d[off + 2]) << 16) |
-                                    (static_cast<std::uint32_t>(d[off + 3]) << 24));
+// FLAC blocks are located up front, so analysis chunks decode in parallel.
+aifr3d::AnalysisResult analyze_flac_file(const aifr3d::Analyzer& analyzer,
+                                         const std::string& path,
+                                         aifr3d::AnalyzerWorkspace& workspace) {
+  const aifr3d::io::FlacReader flac(path);
+  return analyzer.analyzeBlocks(
+      [&](std::size_t first, std::size_t frames, float* left, float* right) {
+        flac.readStereo(first, frames, left, right);
+      },
+      flac.frameCount(), flac.sampleRateHz(), workspace);
 }
 
-float decode_sample_pcm(const std::uint8_t* p, int bits_per_sample) {
-  if (bits_per_sample == 16) {
-    const std::int16_t v = static_cast<std::int16_t>(p[0] | (static_cast<std::int16_t>(p[1]) << 8));
-    return static_cast<float>(static_cast<double>(v) / 32768.0);
-  }
-  if (bits_per_sample == 24) {
-    std::int32_t v = (static_cast<std::int32_t>(p[2]) << 24) | (static_cast<std::int32_t>(p[1]) << 16) |
-                     (static_cast<std::int32_t>(p[0]) << 8);
-    v >>= 8;
-    return static_cast<float>(static_cast<double>(v) / 8388608.0);
+// Reads ahead on I/O threads and decodes on another while this thread
+// analyzes, for storage where reads rather than analysis are the bottleneck.
+aifr3d::AnalysisResult analyze_wav_read_ahead(const std::string& path) {
+  aifr3d::io::ReadAheadWavReader wav(path);
+  aifr3d::StreamingAnalyzer analyzer;
+  analyzer.reset(wav.sampleRateHz());
+  for (auto block = wav.next(); block.frames > 0; block = wav.next()) {
+    analyzer.pushPlanar(block.left, block.right, block.frames);
   }
-  if (bits_per_sample == 32) {
-    const std::int32_t v = static_cast<std::int32_t>(p[0] | (static_cast<std::int32_t>(p[1]) << 8) |
-                                                     (static_cast<std::int32_t>(p[2]) << 16) |
-                                                     (static_cast<std::int32_t>(p[3]) << 24));
-    return static_cast<float>(static_cast<double>(v) / 2147483648.0);
-  }
-  throw std::invalid_argument("Unsupported PCM bit depth");
+  return analyzer.finalize();
 }
 
-float decode_sample_float32(const std::uint8_t* p) {
-  std::uint32_t bits = static_cast<std::uint32_t>(p[0] | (static_cast<std::uint32_t>(p[1]) << 8) |
-                                                  (static_cast<std::uint32_t>(p[2]) << 16) |
-                                                  (static_cast<std::uint32_t>(p[3]) << 24));
-  float out = 0.0F;
-  std::memcpy(&out, &bits, sizeof(float));
-  return out;
-}
-
-WavData load_wav_stereo(const std::string& path) {
-  std::ifstream in(path, std::ios::binary);
-  if (!in) {
-    throw std::invalid_argument("cannot open wav: " + path);
-  }
-  std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
-  if (bytes.size() < 44U) {
-    throw std::invalid_argument("wav too small");
-  }
-  if (std::string(reinterpret_cast<const char*>(bytes.data()), 4) != "RIFF" ||
-      std::string(reinterpret_cast<const char*>(bytes.data() + 8), 4) != "WAVE") {
-    throw std::invalid_argument("not a RIFF/WAVE file");
-  }
-
-  std::uint16_t audio_format = 0;
-  std::uint16_t channels = 0;
-  std::uint32_t sample_rate = 0;
-  std::uint16_t bits_per_sample = 0;
-  std::size_t data_off = 0;
-  std::size_t data_size = 0;
-
-  std::size_t off = 12;
-  while (off + 8 <= bytes.size()) {
-    const auto chunk_id = std::string(reinterpret_cast<const char*>(bytes.data() + off), 4);
-    const auto chunk_size = static_cast<std::size_t>(read_u32_le(bytes, off + 4));
-    const std::size_t chunk_data = off + 8;
-    if (chunk_data + chunk_size > bytes.size()) {
-      throw std::invalid_argument("invalid wav chunk bounds");
-    }
-    if (chunk_id == "fmt ") {
-      if (chunk_size < 16) {
-        throw std::invalid_argument("invalid fmt chunk");
-      }
-      audio_format = read_u16_le(bytes, chunk_data);
-      channels = read_u16_le(bytes, chunk_data + 2);
-      sample_rate = read_u32_le(bytes, chunk_data + 4);
-      bits_per_sample = read_u16_le(bytes, chunk_data + 14);
-    } else if (chunk_id == "data") {
-      data_off = chunk_data;
-      data_size = chunk_size;
-      break;
-    }
-    off = chunk_data + chunk_size + (chunk_size % 2U);
-  }
-
-  if (data_off == 0 || sample_rate == 0 || channels == 0 || bits_per_sample == 0) {
-    throw std::invalid_argument("wav missing required fmt/data fields");
-  }
-
-  const int bytes_per_sample = bits_per_sample / 8;
-  const int bytes_per_frame = bytes_per_sample * static_cast<int>(channels);
-  if (bytes_per_sample <= 0 || bytes_per_frame <= 0) {
-    throw std::invalid_argument("invalid wav format geometry");
-  }
-
-  const std::size_t frame_count = data_size / static_cast<std::size_t>(bytes_per_frame);
-  WavData out;
-  out.sample_rate_hz = static_cast<double>(sample_rate);
-  out.frame_count = frame_count;
-  out.interleaved_stereo.resize(frame_count * 2U, 0.0F);
-
-  for (std::size_t f = 0; f < frame_count; ++f) {
-    const std::size_t frame_off = data_off + f * static_cast<std::size_t>(bytes_per_frame);
-    auto read_channel = [&](std::size_t ch) {
-      const std::size_t sample_off = frame_off + ch * static_cast<std::size_t>(bytes_per_sample);
-      const auto* p = bytes.data() + sample_off;
-      if (audio_format == 1) {
-        return decode_sample_pcm(p, bits_per_sample);
-      }
-      if (audio_format == 3 && bits_per_sample == 32) {
-        return decode_sample_float32(p);
-      }
-      throw std::invalid_argument("unsupported wav encoding (only PCM/float32)");
-    };
-
-    const float l = read_channel(0);
-    const float r = read_channel(std::min<std::size_t>(1, static_cast<std::size_t>(channels - 1)));
-    out.interleaved_stereo[f * 2U] = l;
-    out.interleaved_stereo[f * 2U + 1U] = r;
-  }
-
-  return out;
+// Decodes stdin block by block into a streaming pass, for WAV piped from
+// another tool. Memory is one block; the length need not be known up front.
+aifr3d::AnalysisResult analyze_wav_stdin() {
+#if defined(_WIN32)
+  _setmode(_fileno(stdin), _O_BINARY);
+#endif
+  aifr3d::io::WavStream wav(std::cin);
+  std::vector<float> left(wav.blockFrames());
+  std::vector<float> right(wav.blockFrames());
+  aifr3d::StreamingAnalyzer analyzer;
+  analyzer.reset(wav.sampleRateHz());
+  for (std::size_t frames = wav.next(left.data(), right.data()); frames > 0;
+       frames = wav.next(left.data(), right.data())) {
+    analyzer.pushPlanar(left.data(), right.data(), frames);
+  }
+  return analyzer.finalize();
 }
 
 std::string json_num_or_null(const std::optional<double>& v) {
@@ -205,7 +137,9 @@ std::string to_json(const aifr3d::AnalysisResult& a,
   o << "    \"peak_dbfs\": " << json_num_or_null(a.dynamics.peak_dbfs) << ",\n";
   o << "    \"rms_dbfs\": " << json_num_or_null(a.dynamics.rms_dbfs) << ",\n";
   o << "    \"crest_db\": " << json_num_or_null(a.dynamics.crest_db) << ",\n";
-  o << "    \"dr_proxy_db\": " << json_num_or_null(a.dynamics.dr_proxy_db) << "\n";
+  o << "    \"dr_proxy_db\": " << json_num_or_null(a.dynamics.dr_proxy_db) << ",\n";
+  o << "    \"dr_db\": " << json_num_or_null(a.dynamics.dr_db) << ",\n";
+  o << "    \"plr_db\": " << json_num_or_null(a.dynamics.plr_db) << "\n";
   o << "  },\n";
 
   if (s.has_value()) {
@@ -241,21 +175,39 @@ std::string to_json(const aifr3d::AnalysisResult& a,
 }  // namespace
 
 int main(int argc, char** argv) {
-  if (argc < 3) {
-    std::cerr << "Usage: aifr3d_core_cli <input.wav> <output.json> [benchmark.json] [reference.wav]\n";
+  bool read_ahead = false;
+  std::vector<std::string> args;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--read-ahead") {
+      read_ahead = true;
+    } else {
+      args.push_back(arg);
+    }
+  }
+  if (args.size() < 2U) {
+    std::cerr << "Usage: aifr3d_core_cli [--read-ahead] <input.wav|input.flac|-> <output.json> "
+                 "[benchmark.json] [reference.wav|reference.flac]\n";
     return 2;
   }
 
   try {
-    const std::string input_wav = argv[1];
-    const std::string out_json = argv[2];
-    const std::optional<std::string> benchmark_path = (argc >= 4) ? std::optional<std::string>(argv[3]) : std::nullopt;
-    const std::optional<std::string> reference_path = (argc >= 5) ? std::optional<std::string>(argv[4]) : std::nullopt;
-
-    const auto wav = load_wav_stereo(input_wav);
-
-    aifr3d::Analyzer analyzer;
-    auto analysis = analyzer.analyzeInterleavedStereo(wav.interleaved_stereo.data(), wav.frame_count, wav.sample_rate_hz);
+    const std::string input_wav = args[0];
+    const std::string out_json = args[1];
+    const std::optional<std::string> benchmark_path =
+        (args.size() >= 3U) ? std::optional<std::string>(args[2]) : std::nullopt;
+    const std::optional<std::string> reference_path =
+        (args.size() >= 4U) ? std::optional<std::string>(args[3]) : std::nullopt;
+
+    const aifr3d::Analyzer analyzer(0);  // batch tool: use every hardware thread
+    aifr3d::AnalyzerWorkspace workspace;
+    const auto analyze = [&](const std::string& path) {
+      if (aifr3d::io::is_flac_file(path)) {
+        return analyze_flac_file(analyzer, path, workspace);
+      }
+      return read_ahead ? analyze_wav_read_ahead(path) : analyze_wav_file(analyzer, path, workspace);
+    };
+    auto analysis = input_wav == "-" ? analyze_wav_stdin() : analyze(input_wav);
 
     std::optional<aifr3d::BenchmarkCompareResult> bench;
     std::optional<aifr3d::ReferenceCompareResult> refs;
@@ -268,10 +220,7 @@ int main(int argc, char** argv) {
     }
 
     if (reference_path.has_value()) {
-      const auto ref_wav = load_wav_stereo(*reference_path);
-      auto ref_analysis = analyzer.analyzeInterleavedStereo(ref_wav.interleaved_stereo.data(),
-                                                            ref_wav.frame_count,
-                                                            ref_wav.sample_rate_hz);
+      auto ref_analysis = analyze(*reference_path);
       ref_analysis.schema_version = analysis.schema_version;
       refs = aifr3d::compareToReferences(analysis, {ref_analysis});
     }
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "aifr3d/io/mapped_file.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace aifr3d::io {
+
+// True when `path` starts with the FLAC stream marker (optionally behind an
+// ID3v2 tag). False for unreadable files.
+bool is_flac_file(const std::string& path);
+
+// Native FLAC decoder over a memory-mapped file; no external library.
+// Supports CONSTANT, VERBATIM, FIXED and LPC subframes with Rice-coded
+// residuals (including escaped partitions), wasted bits, and every stereo
+// decorrelation mode, for 4 to 24 bits per sample.
+//
+// Opening scans the stream once for frame sync codes and records where each
+// FLAC block starts, accepting a sync only when its header CRC-8 is valid, its
+// frame or sample number continues the sequence and the block before it ends
+// in a matching CRC-16. A stream whose blocks do not add up to the STREAMINFO
+// sample count, such as a truncated file, is rejected. readStereo() then seeks
+// straight to the blocks covering a range, so disjoint ranges decode in
+// parallel; each thread keeps its last decoded block, so consecutive reads do
+// not decode a block twice. Every block is checked against its CRC-16.
+class FlacReader {
+ public:
+  // Throws std::invalid_argument for unreadable, malformed or unsupported
+  // streams.
+  explicit FlacReader(const std::string& path);
+
+  unsigned channels() const { return channels_; }
+  unsigned bitsPerSample() const { return bits_per_sample_; }
+  double sampleRateHz() const { return static_cast<double>(sample_rate_hz_); }
+  std::size_t frameCount() const { return frame_count_; }
+  // Number of FLAC blocks (coded frames) in the stream.
+  std::size_t blockCount() const { return blocks_.size(); }
+
+  // Decodes frames [first_frame, first_frame + frames) to [-1, 1] floats with
+  // the same scaling as PCM WAV. Mono is copied to both outputs; channels
+  // past the second are ignored. Throws std::out_of_range past frameCount()
+  // and std::invalid_argument for a corrupt block.
+  void readStereo(std::size_t first_frame, std::size_t frames, float* left, float* right) const;
+
+ private:
+  struct Block {
+    std::size_t offset{0};
+    std::size_t first_frame{0};
+  };
+  struct DecodedBlock;
+
+  void indexBlocks(std::size_t audio_offset);
+  void decodeBlock(std::size_t index, DecodedBlock& out) const;
+
+  MappedFile file_;
+  std::uint64_t id_{0};
+  unsigned channels_{0};
+  unsigned bits_per_sample_{0};
+  std::uint32_t sample_rate_hz_{0};
+  std::uint32_t min_frame_bytes_{0};
+  std::uint32_t max_frame_bytes_{0};
+  std::size_t frame_count_{0};
+  std::vector<Block> blocks_;
+};
+
+}  // namespace aifr3d::io
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace aifr3d::io {
+
+// Read-only memory mapping of a whole file. Pages are faulted in on first
+// touch and stay reclaimable page cache, so mapping a large file costs address
+// space rather than heap. Move-only; the mapping is released on destruction.
+class MappedFile {
+ public:
+  MappedFile() = default;
+  // Throws std::invalid_argument when the file cannot be opened or mapped.
+  explicit MappedFile(const std::string& path);
+  ~MappedFile();
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const unsigned char* data() const { return data_; }
+  std::size_t size() const { return size_; }
+
+  // Hints that [offset, offset + length) will not be read again soon, so its
+  // pages may be dropped from this process. Reading them later is still valid.
+  void release(std::size_t offset, std::size_t length) const;
+
+ private:
+  void unmap() noexcept;
+
+  const unsigned char* data_{nullptr};
+  std::size_t size_{0};
+#if defined(_WIN32)
+  void* mapping_{nullptr};
+#endif
+};
+
+}  // namespace aifr3d::io
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+
+namespace aifr3d::io {
+
+enum class SampleFormat {
+  kPcm16,
+  kPcm24,
+  kPcm32,
+  kFloat32,
+  kFloat64,
+};
+
+std::size_t bytes_per_sample(SampleFormat format);
+
+// Bulk converters from little-endian interleaved frames to planar [-1, 1]
+// floats. Integers scale by 2^-(bits - 1) and doubles round once to float, so
+// every format decodes bit-identically to a per-sample conversion.
+//
+// decode_channel_pair() reads channels `first_channel` and `first_channel + 1`
+// of `frames` frames of `channels` samples each, de-interleaving both in one
+// pass over the source. On SSE2 and NEON targets it converts four frames per
+// step; packed 24-bit uses a byte shuffle where SSSE3 is enabled. Requires
+// first_channel + 1 < channels.
+void decode_channel_pair(SampleFormat format,
+                         const unsigned char* src,
+                         std::size_t channels,
+                         std::size_t first_channel,
+                         std::size_t frames,
+                         float* out_first,
+                         float* out_second);
+
+// Single-channel variant of decode_channel_pair(), for mono sources.
+void decode_channel(SampleFormat format,
+                    const unsigned char* src,
+                    std::size_t channels,
+                    std::size_t channel,
+                    std::size_t frames,
+                    float* out);
+
+}  // namespace aifr3d::io
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "aifr3d/io/wav_header.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace aifr3d::io {
+
+struct ReadAheadOptions {
+  std::size_t block_frames{16384};
+  // Blocks held between the stages. Memory is about
+  // queue_depth * block_frames * (block_align + 2 * sizeof(float)) bytes.
+  std::size_t queue_depth{8};
+  // Concurrent pread calls when io_uring is not in use.
+  std::size_t io_threads{2};
+  // Builds configured with AIFR3D_IO_URING=ON that found liburing submit
+  // reads through io_uring, and fall back to pread threads when the kernel
+  // refuses a ring.
+  bool use_io_uring{true};
+};
+
+struct PlanarBlockView {
+  const float* left{nullptr};
+  const float* right{nullptr};
+  std::size_t frames{0};
+};
+
+// Three-stage WAV reader for storage where reads are slow compared with
+// analysis, such as network mounts. I/O threads read raw blocks ahead into a
+// ring of recycled buffers, a decode thread converts each block to planar
+// float, and the caller takes blocks in order from next(). A stage waits when
+// the ring is full, so memory stays bounded and a slow consumer throttles the
+// reads. With I/O, decode and analysis overlapping, throughput approaches the
+// slowest stage rather than the sum of all three.
+//
+// Accepts everything parse_wav_header() does. Mono is copied to both outputs;
+// channels past the second are ignored.
+class ReadAheadWavReader {
+ public:
+  // Throws std::invalid_argument for unreadable or malformed files, or when
+  // block_frames, queue_depth or io_threads is zero.
+  explicit ReadAheadWavReader(const std::string& path, const ReadAheadOptions& options = {});
+  // Stops the stages and waits for reads in flight.
+  ~ReadAheadWavReader();
+  ReadAheadWavReader(const ReadAheadWavReader&) = delete;
+  ReadAheadWavReader& operator=(const ReadAheadWavReader&) = delete;
+
+  const WavFormat& format() const;
+  double sampleRateHz() const { return static_cast<double>(format().sample_rate_hz); }
+  std::size_t frameCount() const;
+  // "io_uring" or "pread".
+  const char* backend() const;
+
+  // Waits for the next block of up to block_frames frames; frames is 0 once
+  // the data is exhausted. The view stays valid until the next call, after
+  // which its buffers are recycled. Rethrows the first error of a stage.
+  PlanarBlockView next();
+
+ private:
+  struct State;
+  std::unique_ptr<State> state_;
+};
+
+}  // namespace aifr3d::io
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "aifr3d/io/pcm_decode.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace aifr3d::io {
+
+struct WavFormat {
+  SampleFormat sample_format{SampleFormat::kPcm16};
+  std::uint16_t channels{0};
+  std::uint32_t sample_rate_hz{0};
+  // Bytes per interleaved frame (channels * bytes per sample).
+  std::uint16_t block_align{0};
+};
+
+struct WavLayout {
+  WavFormat format;
+  // Byte offset of the first sample from the start of the file.
+  std::uint64_t data_offset{0};
+  std::uint64_t data_bytes{0};
+  // False when a plain RIFF header leaves the data size at 0xFFFFFFFF, as
+  // writers on a pipe do: the samples then run to the end of the input.
+  bool data_bytes_known{true};
+};
+
+// Fills `bytes` bytes of `dst` with the next header bytes, or skips them when
+// `dst` is null. Returns false at end of input.
+using WavHeaderReader = std::function<bool(unsigned char* dst, std::size_t bytes)>;
+
+// Parses a RIFF/WAVE, RF64 or BW64 header up to the start of the data chunk,
+// reading strictly forward. RF64/BW64 take the 64-bit data size from the
+// ds64 chunk, so data chunks past 4 GiB are described exactly. Accepts the
+// sample formats of SampleFormat, plain or as a WAVE_FORMAT_EXTENSIBLE
+// sub-format. Throws std::invalid_argument for malformed or unsupported
+// headers.
+WavLayout parse_wav_header(const WavHeaderReader& read);
+
+}  // namespace aifr3d::io
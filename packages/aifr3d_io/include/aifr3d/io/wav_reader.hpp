@@ -0,0 +1,59 @@
+#pragma once
+
+#include "aifr3d/io/mapped_file.hpp"
+#include "aifr3d/io/pcm_decode.hpp"
+#include "aifr3d/io/wav_header.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace aifr3d::io {
+
+// RIFF/WAVE reader over a memory-mapped file. Chunks are parsed in place and
+// the data chunk is never copied: dataBytes() is a view into the mapping, and
+// readStereo() decodes any frame range straight from it into the caller's
+// planar buffers. Memory is therefore one decoded block, whatever the file
+// size. Reads are const and may run concurrently.
+//
+// Accepts everything parse_wav_header() does, RF64/BW64 files past 4 GiB
+// included.
+class WavReader {
+ public:
+  // Throws std::invalid_argument for unreadable, malformed or unsupported files.
+  explicit WavReader(const std::string& path);
+
+  const WavFormat& format() const { return format_; }
+  double sampleRateHz() const { return static_cast<double>(format_.sample_rate_hz); }
+  std::size_t frameCount() const { return frame_count_; }
+
+  // Interleaved sample bytes of the data chunk (frameCount() * block_align).
+  const unsigned char* dataBytes() const { return file_.data() + data_offset_; }
+
+  // Decodes frames [first_frame, first_frame + frames) to [-1, 1] floats.
+  // Mono is copied to both outputs; channels past the second are ignored.
+  // Throws std::out_of_range past frameCount().
+  void readStereo(std::size_t first_frame, std::size_t frames, float* left, float* right) const;
+
+  // Decodes channels first_channel and first_channel + 1 (say the surround
+  // pair of a 5.1 file) in one pass. Throws std::out_of_range when the pair or
+  // the frame range does not exist.
+  void readChannelPair(std::size_t first_frame,
+                       std::size_t frames,
+                       std::size_t first_channel,
+                       float* left,
+                       float* right) const;
+
+  // Lets the OS drop the mapped pages of frames already consumed.
+  void releaseFrames(std::size_t first_frame, std::size_t frames) const;
+
+ private:
+  void checkRange(std::size_t first_frame, std::size_t frames) const;
+
+  MappedFile file_;
+  WavFormat format_;
+  std::size_t data_offset_{0};
+  std::size_t frame_count_{0};
+};
+
+}  // namespace aifr3d::io
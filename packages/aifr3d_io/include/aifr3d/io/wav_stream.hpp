@@ -0,0 +1,56 @@
+#pragma once
+
+#include "aifr3d/io/wav_header.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace aifr3d::io {
+
+// Forward-only WAV decoder for inputs that cannot be mapped whole: pipes,
+// stdin, or multi-hour RF64/BW64 deliverables on storage where a mapping is
+// unwelcome. Each next() call reads one block of raw frames and decodes it to
+// planar float, so memory is one block whatever the length, and a
+// StreamingAnalyzer can consume each block before the next is read.
+//
+// Accepts everything parse_wav_header() does. A plain RIFF header with an
+// unknown data size streams to the end of the input.
+class WavStream {
+ public:
+  static constexpr std::size_t kDefaultBlockFrames = 16384;
+
+  // Throws std::invalid_argument when the file cannot be opened, the header
+  // is malformed or block_frames is zero.
+  explicit WavStream(const std::string& path, std::size_t block_frames = kDefaultBlockFrames);
+  // Reads from `in`, which must outlive the stream.
+  explicit WavStream(std::istream& in, std::size_t block_frames = kDefaultBlockFrames);
+
+  const WavFormat& format() const { return layout_.format; }
+  double sampleRateHz() const { return static_cast<double>(layout_.format.sample_rate_hz); }
+  std::size_t blockFrames() const { return block_frames_; }
+  // Frames declared by the header; nullopt when the input runs to its end.
+  std::optional<std::uint64_t> frameCount() const;
+
+  // Decodes the next blockFrames() frames (fewer at the end of the data) to
+  // [-1, 1] floats and returns how many; 0 once the data is exhausted. Mono
+  // is copied to both outputs; channels past the second are ignored.
+  std::size_t next(float* left, float* right);
+
+ private:
+  void open(std::size_t block_frames);
+
+  std::unique_ptr<std::ifstream> file_;
+  std::istream* in_{nullptr};
+  WavLayout layout_;
+  std::size_t block_frames_{0};
+  std::uint64_t remaining_bytes_{0};
+  std::vector<unsigned char> raw_;
+};
+
+}  // namespace aifr3d::io
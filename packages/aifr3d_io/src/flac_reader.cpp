@@ -0,0 +1,646 @@
+#include "aifr3d/io/flac_reader.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace aifr3d::io {
+
+namespace {
+
+constexpr std::size_t kStreamInfoBytes = 34;
+constexpr unsigned kMetadataStreamInfo = 0;
+constexpr unsigned kMetadataInvalid = 127;
+// Channel assignments 8..10 store one channel as a side (difference) signal.
+constexpr unsigned kLeftSide = 8;
+constexpr unsigned kRightSide = 9;
+constexpr unsigned kMidSide = 10;
+constexpr unsigned kMinBitsPerSample = 4;
+constexpr unsigned kMaxBitsPerSample = 24;
+
+constexpr std::array<std::uint8_t, 256> make_crc8_table() {
+  std::array<std::uint8_t, 256> table{};
+  for (unsigned i = 0; i < 256U; ++i) {
+    unsigned crc = i;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc & 0x80U) != 0U ? ((crc << 1U) ^ 0x07U) & 0xFFU : (crc << 1U) & 0xFFU;
+    }
+    table[i] = static_cast<std::uint8_t>(crc);
+  }
+  return table;
+}
+
+constexpr std::array<std::uint16_t, 256> make_crc16_table() {
+  std::array<std::uint16_t, 256> table{};
+  for (unsigned i = 0; i < 256U; ++i) {
+    unsigned crc = i << 8U;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc & 0x8000U) != 0U ? ((crc << 1U) ^ 0x8005U) & 0xFFFFU : (crc << 1U) & 0xFFFFU;
+    }
+    table[i] = static_cast<std::uint16_t>(crc);
+  }
+  return table;
+}
+
+constexpr auto kCrc8Table = make_crc8_table();
+constexpr auto kCrc16Table = make_crc16_table();
+
+// CRC-8 (poly 0x07) over a frame header, CRC-16 (poly 0x8005) over a frame.
+std::uint8_t crc8(const unsigned char* p, std::size_t n) {
+  std::uint8_t crc = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    crc = kCrc8Table[crc ^ p[i]];
+  }
+  return crc;
+}
+
+std::uint16_t crc16(const unsigned char* p, std::size_t n) {
+  unsigned crc = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    crc = ((crc << 8U) & 0xFFFFU) ^ kCrc16Table[(crc >> 8U) ^ p[i]];
+  }
+  return static_cast<std::uint16_t>(crc);
+}
+
+std::uint32_t read_u16_be(const unsigned char* p) {
+  return (static_cast<std::uint32_t>(p[0]) << 8U) | p[1];
+}
+
+std::uint32_t read_u24_be(const unsigned char* p) {
+  return (static_cast<std::uint32_t>(p[0]) << 16U) | (static_cast<std::uint32_t>(p[1]) << 8U) | p[2];
+}
+
+// Bytes taken by a leading ID3v2 tag, which some taggers put before "fLaC".
+std::size_t id3v2_size(const unsigned char* p, std::size_t avail) {
+  if (avail < 10 || std::memcmp(p, "ID3", 3) != 0) {
+    return 0;
+  }
+  const std::size_t body = (static_cast<std::size_t>(p[6] & 0x7FU) << 21U) |
+                           (static_cast<std::size_t>(p[7] & 0x7FU) << 14U) |
+                           (static_cast<std::size_t>(p[8] & 0x7FU) << 7U) | (p[9] & 0x7FU);
+  const bool footer = (p[5] & 0x10U) != 0U;
+  return 10U + body + (footer ? 10U : 0U);
+}
+
+struct FrameHeader {
+  std::uint32_t block_size{0};
+  unsigned channel_assignment{0};
+  unsigned channels{0};
+  unsigned bits_per_sample{0};
+  bool variable_block_size{false};
+  // Frame number for fixed-size blocks, first sample number otherwise.
+  std::uint64_t number{0};
+  // Header length including its CRC-8.
+  std::size_t bytes{0};
+};
+
+// Parses the frame header at p. False when the bytes are not a valid header,
+// which is how sync codes inside compressed data are told apart.
+bool parse_frame_header(const unsigned char* p, std::size_t avail, unsigned stream_bits, FrameHeader& out) {
+  if (avail < 6 || p[0] != 0xFFU || (p[1] & 0xFEU) != 0xF8U) {
+    return false;
+  }
+  out.variable_block_size = (p[1] & 0x01U) != 0U;
+  const unsigned block_code = p[2] >> 4U;
+  const unsigned rate_code = p[2] & 0x0FU;
+  out.channel_assignment = p[3] >> 4U;
+  const unsigned size_code = (p[3] >> 1U) & 0x07U;
+  if (block_code == 0U || rate_code == 0x0FU || (p[3] & 0x01U) != 0U) {
+    return false;
+  }
+  if (out.channel_assignment < 8U) {
+    out.channels = out.channel_assignment + 1U;
+  } else if (out.channel_assignment <= kMidSide) {
+    out.channels = 2;
+  } else {
+    return false;
+  }
+  static constexpr std::array<unsigned, 8> kSizeBits{0, 8, 12, 0, 16, 20, 24, 32};
+  if (size_code == 3U) {
+    return false;
+  }
+  out.bits_per_sample = size_code == 0U ? stream_bits : kSizeBits[size_code];
+
+  // UTF-8 style coded number: up to 31 bits (6 bytes) for frame numbers and
+  // 36 bits (7 bytes) for sample numbers.
+  std::size_t pos = 4;
+  const unsigned lead = p[pos++];
+  std::size_t extra = 0;
+  if (lead < 0x80U) {
+    out.number = lead;
+  } else if (lead >= 0xC0U && lead < 0xFFU) {
+    extra = static_cast<std::size_t>(std::countl_one(static_cast<std::uint8_t>(lead))) - 1U;
+    out.number = lead & (0x3FU >> extra);
+  } else {
+    return false;
+  }
+  if (extra > (out.variable_block_size ? 6U : 5U) || avail < pos + extra + 1U) {
+    return false;
+  }
+  for (std::size_t i = 0; i < extra; ++i) {
+    const unsigned byte = p[pos++];
+    if ((byte & 0xC0U) != 0x80U) {
+      return false;
+    }
+    out.number = (out.number << 6U) | (byte & 0x3FU);
+  }
+
+  const std::size_t tail = (block_code == 6U ? 1U : block_code == 7U ? 2U : 0U) +
+                           (rate_code == 12U ? 1U : rate_code >= 13U ? 2U : 0U);
+  if (avail < pos + tail + 1U) {
+    return false;
+  }
+  if (block_code == 1U) {
+    out.block_size = 192;
+  } else if (block_code <= 5U) {
+    out.block_size = 576U << (block_code - 2U);
+  } else if (block_code == 6U) {
+    out.block_size = p[pos] + 1U;
+    pos += 1;
+  } else if (block_code == 7U) {
+    out.block_size = read_u16_be(p + pos) + 1U;
+    pos += 2;
+  } else {
+    out.block_size = 256U << (block_code - 8U);
+  }
+  pos += rate_code == 12U ? 1U : rate_code >= 13U ? 2U : 0U;
+  if (crc8(p, pos) != p[pos]) {
+    return false;
+  }
+  out.bytes = pos + 1U;
+  return true;
+}
+
+// Upper bound on the length of the frame starting with `header`: the
+// STREAMINFO maximum when the encoder recorded one, otherwise the frame with
+// every subframe stored verbatim at the side-channel width, plus a byte of
+// slack per subframe for its header and wasted-bits flag.
+std::size_t max_frame_bytes(const FrameHeader& header, std::uint32_t stream_max) {
+  if (stream_max != 0U) {
+    return stream_max;
+  }
+  const std::size_t subframe_bytes = (std::size_t{header.block_size} * (header.bits_per_sample + 1U) + 7U) / 8U;
+  return header.bytes + header.channels * (subframe_bytes + 2U) + 2U;
+}
+
+// MSB-first bit reader over a frame. Reads past `size` return zero bits;
+// callers check overran() once the frame is consumed.
+class BitReader {
+ public:
+  BitReader(const unsigned char* data, std::size_t size, std::size_t pos) : data_(data), size_(size), pos_(pos) {}
+
+  std::uint32_t bits(unsigned n) {
+    if (n == 0U) {
+      return 0;
+    }
+    refill();
+    const auto v = static_cast<std::uint32_t>(cache_ >> (64U - n));
+    cache_ <<= n;
+    count_ -= n;
+    return v;
+  }
+
+  std::int32_t signedBits(unsigned n) {
+    if (n == 0U) {
+      return 0;
+    }
+    const std::uint32_t v = bits(n);
+    return static_cast<std::int32_t>(v << (32U - n)) >> (32U - n);
+  }
+
+  // Counts zero bits up to and including the terminating one bit.
+  std::uint32_t unary() {
+    std::uint32_t zeros = 0;
+    while (true) {
+      refill();
+      if (cache_ != 0U) {
+        const auto z = static_cast<unsigned>(std::countl_zero(cache_));
+        cache_ <<= z;
+        cache_ <<= 1U;
+        count_ -= z + 1U;
+        return zeros + z;
+      }
+      zeros += count_;
+      count_ = 0;
+      if (overran()) {
+        throw std::invalid_argument("corrupt FLAC block (unterminated unary code)");
+      }
+    }
+  }
+
+  std::int32_t rice(unsigned parameter) {
+    const std::uint32_t quotient = unary();
+    const std::uint32_t folded = (quotient << parameter) | bits(parameter);
+    return static_cast<std::int32_t>((folded >> 1U) ^ (0U - (folded & 1U)));
+  }
+
+  void alignToByte() {
+    const unsigned drop = count_ % 8U;
+    cache_ <<= drop;
+    count_ -= drop;
+  }
+
+  // Offset of the next unread byte; only meaningful when byte aligned.
+  std::size_t bytePosition() const { return pos_ - count_ / 8U; }
+  bool overran() const { return pos_ * 8U - count_ > size_ * 8U; }
+
+ private:
+  // Keeps at least 57 bits cached. Bits below the cached ones stay zero, which
+  // unary() relies on.
+  void refill() {
+    if (count_ > 56U) {
+      return;
+    }
+    if (pos_ + 8U <= size_) {
+      std::uint64_t word = 0;
+      for (std::size_t i = 0; i < 8U; ++i) {
+        word = (word << 8U) | data_[pos_ + i];
+      }
+      const unsigned take = (64U - count_) / 8U;
+      cache_ |= word >> count_;
+      count_ += take * 8U;
+      pos_ += take;
+      if (count_ < 64U) {
+        cache_ &= ~(~std::uint64_t{0} >> count_);
+      }
+      return;
+    }
+    while (count_ <= 56U) {
+      const std::uint64_t byte = pos_ < size_ ? data_[pos_] : 0U;
+      cache_ |= byte << (56U - count_);
+      count_ += 8U;
+      ++pos_;
+    }
+  }
+
+  const unsigned char* data_;
+  std::size_t size_;
+  std::size_t pos_;
+  std::uint64_t cache_{0};
+  unsigned count_{0};
+};
+
+[[noreturn]] void corrupt_block() { throw std::invalid_argument("corrupt FLAC block"); }
+
+void decode_residual(BitReader& bits, std::uint32_t block_size, unsigned predictor_order, std::int32_t* out) {
+  const std::uint32_t method = bits.bits(2);
+  if (method > 1U) {
+    corrupt_block();
+  }
+  const unsigned parameter_bits = method == 0U ? 4U : 5U;
+  const std::uint32_t escape = (1U << parameter_bits) - 1U;
+  const unsigned partition_order = bits.bits(4);
+  const std::uint32_t partition_size = block_size >> partition_order;
+  if ((partition_size << partition_order) != block_size || partition_size < predictor_order) {
+    corrupt_block();
+  }
+  std::size_t i = predictor_order;
+  for (std::uint32_t partition = 0; partition < (1U << partition_order); ++partition) {
+    const std::size_t end = static_cast<std::size_t>(partition + 1U) * partition_size;
+    const std::uint32_t parameter = bits.bits(parameter_bits);
+    if (parameter == escape) {
+      const unsigned raw_bits = bits.bits(5);
+      for (; i < end; ++i) {
+        out[i] = bits.signedBits(raw_bits);
+      }
+    } else {
+      for (; i < end; ++i) {
+        out[i] = bits.rice(parameter);
+      }
+    }
+  }
+}
+
+void restore_fixed(unsigned order, std::uint32_t block_size, std::int32_t* s) {
+  for (std::size_t i = order; i < block_size; ++i) {
+    std::int64_t prediction = 0;
+    switch (order) {
+      case 1:
+        prediction = s[i - 1];
+        break;
+      case 2:
+        prediction = 2 * std::int64_t{s[i - 1]} - s[i - 2];
+        break;
+      case 3:
+        prediction = 3 * (std::int64_t{s[i - 1]} - s[i - 2]) + s[i - 3];
+        break;
+      case 4:
+        prediction = 4 * (std::int64_t{s[i - 1]} + s[i - 3]) - 6 * std::int64_t{s[i - 2]} - s[i - 4];
+        break;
+      default:
+        break;
+    }
+    s[i] = static_cast<std::int32_t>(s[i] + prediction);
+  }
+}
+
+void restore_lpc(const std::int32_t* coefs, unsigned order, unsigned shift, std::uint32_t block_size,
+                 std::int32_t* s) {
+  for (std::size_t i = order; i < block_size; ++i) {
+    std::int64_t sum = 0;
+    for (std::size_t j = 0; j < order; ++j) {
+      sum += std::int64_t{coefs[j]} * s[i - 1 - j];
+    }
+    s[i] = static_cast<std::int32_t>(s[i] + (sum >> shift));
+  }
+}
+
+void decode_subframe(BitReader& bits, unsigned sample_bits, std::uint32_t block_size, std::int32_t* out) {
+  if (bits.bits(1) != 0U) {
+    corrupt_block();
+  }
+  const std::uint32_t type = bits.bits(6);
+  unsigned wasted = 0;
+  if (bits.bits(1) != 0U) {
+    wasted = bits.unary() + 1U;
+    if (wasted >= sample_bits) {
+      corrupt_block();
+    }
+    sample_bits -= wasted;
+  }
+
+  if (type == 0U) {
+    std::fill(out, out + block_size, bits.signedBits(sample_bits));
+  } else if (type == 1U) {
+    for (std::size_t i = 0; i < block_size; ++i) {
+      out[i] = bits.signedBits(sample_bits);
+    }
+  } else if (type >= 8U && type <= 12U) {
+    const unsigned order = type - 8U;
+    if (order > block_size) {
+      corrupt_block();
+    }
+    for (std::size_t i = 0; i < order; ++i) {
+      out[i] = bits.signedBits(sample_bits);
+    }
+    decode_residual(bits, block_size, order, out);
+    restore_fixed(order, block_size, out);
+  } else if (type >= 32U) {
+    const unsigned order = type - 31U;
+    if (order > block_size) {
+      corrupt_block();
+    }
+    for (std::size_t i = 0; i < order; ++i) {
+      out[i] = bits.signedBits(sample_bits);
+    }
+    const unsigned precision = bits.bits(4) + 1U;
+    const std::int32_t shift = bits.signedBits(5);
+    if (precision == 16U || shift < 0) {
+      corrupt_block();
+    }
+    std::array<std::int32_t, 32> coefs{};
+    for (std::size_t j = 0; j < order; ++j) {
+      coefs[j] = bits.signedBits(precision);
+    }
+    decode_residual(bits, block_size, order, out);
+    restore_lpc(coefs.data(), order, static_cast<unsigned>(shift), block_size, out);
+  } else {
+    corrupt_block();
+  }
+
+  if (wasted > 0U) {
+    for (std::size_t i = 0; i < block_size; ++i) {
+      out[i] = static_cast<std::int32_t>(static_cast<std::uint32_t>(out[i]) << wasted);
+    }
+  }
+}
+
+std::uint64_t next_reader_id() {
+  static std::atomic<std::uint64_t> counter{0};
+  return counter.fetch_add(1, std::memory_order_relaxed) + 1U;
+}
+
+}  // namespace
+
+struct FlacReader::DecodedBlock {
+  std::uint64_t reader{0};
+  std::size_t index{0};
+  std::vector<std::int32_t> samples;
+  std::vector<float> left;
+  std::vector<float> right;
+};
+
+bool is_flac_file(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  std::array<unsigned char, 10> head{};
+  if (!in.read(reinterpret_cast<char*>(head.data()), head.size())) {
+    return false;
+  }
+  const std::size_t skip = id3v2_size(head.data(), head.size());
+  if (skip > 0U) {
+    in.seekg(static_cast<std::streamoff>(skip));
+    if (!in.read(reinterpret_cast<char*>(head.data()), 4)) {
+      return false;
+    }
+  }
+  return std::memcmp(head.data(), "fLaC", 4) == 0;
+}
+
+FlacReader::FlacReader(const std::string& path) : file_(path), id_(next_reader_id()) {
+  const unsigned char* data = file_.data();
+  const std::size_t size = file_.size();
+  std::size_t pos = id3v2_size(data, size);
+  if (pos > size || size - pos < 4 || std::memcmp(data + pos, "fLaC", 4) != 0) {
+    throw std::invalid_argument("not a FLAC file: " + path);
+  }
+  pos += 4;
+
+  bool have_stream_info = false;
+  // Total samples per channel from STREAMINFO; 0 when the encoder left it out.
+  std::uint64_t declared_frames = 0;
+  bool last = false;
+  while (!last) {
+    if (size - pos < 4) {
+      throw std::invalid_argument("truncated FLAC metadata in " + path);
+    }
+    last = (data[pos] & 0x80U) != 0U;
+    const unsigned type = data[pos] & 0x7FU;
+    const std::size_t length = read_u24_be(data + pos + 1);
+    pos += 4;
+    if (length > size - pos || type == kMetadataInvalid) {
+      throw std::invalid_argument("malformed FLAC metadata in " + path);
+    }
+    if (type == kMetadataStreamInfo) {
+      if (length < kStreamInfoBytes) {
+        throw std::invalid_argument("malformed FLAC STREAMINFO in " + path);
+      }
+      const unsigned char* info = data + pos;
+      min_frame_bytes_ = read_u24_be(info + 4);
+      max_frame_bytes_ = read_u24_be(info + 7);
+      sample_rate_hz_ = (read_u24_be(info + 10) >> 4U) & 0xFFFFFU;
+      channels_ = ((info[12] >> 1U) & 0x07U) + 1U;
+      bits_per_sample_ = (((info[12] & 0x01U) << 4U) | (info[13] >> 4U)) + 1U;
+      declared_frames = (std::uint64_t{info[13] & 0x0FU} << 32U) | (std::uint64_t{read_u16_be(info + 14)} << 16U) |
+                        read_u16_be(info + 16);
+      have_stream_info = true;
+    }
+    pos += length;
+  }
+  if (!have_stream_info) {
+    throw std::invalid_argument("FLAC stream without STREAMINFO: " + path);
+  }
+  if (sample_rate_hz_ == 0U) {
+    throw std::invalid_argument("FLAC stream without a sample rate: " + path);
+  }
+  if (bits_per_sample_ < kMinBitsPerSample || bits_per_sample_ > kMaxBitsPerSample) {
+    throw std::invalid_argument("unsupported FLAC bit depth (4 to 24 bits): " + path);
+  }
+  indexBlocks(pos);
+  if (declared_frames != 0U && declared_frames != frame_count_) {
+    throw std::invalid_argument("FLAC stream holds " + std::to_string(frame_count_) + " of the " +
+                                std::to_string(declared_frames) + " frames its STREAMINFO declares: " + path);
+  }
+}
+
+void FlacReader::indexBlocks(std::size_t audio_offset) {
+  const unsigned char* data = file_.data();
+  const std::size_t size = file_.size();
+  bool variable_block_size = false;
+  std::size_t total = 0;
+  std::size_t search = audio_offset;
+  // A sync that passes the header checks is confirmed by the CRC-16 ending
+  // the block before it. One that is not is kept as `fallback` and taken only
+  // once the scan passes `limit`, the furthest the previous block can reach:
+  // then that block is damaged (decoding it throws) rather than the sync
+  // false. When the stream ends first, the previous block may be the last
+  // one, so the fallback is dropped.
+  std::size_t limit = size;
+  std::size_t fallback = 0;
+  FrameHeader fallback_header;
+  const auto accept = [&](std::size_t at, const FrameHeader& header) {
+    variable_block_size = header.variable_block_size;
+    blocks_.push_back({at, total});
+    total += header.block_size;
+    // No frame is shorter than its header, one byte per subframe and the
+    // CRC-16, nor than the STREAMINFO minimum.
+    search = at + std::max<std::size_t>(header.bytes + header.channels + 2U, min_frame_bytes_);
+    limit = at + max_frame_bytes(header, max_frame_bytes_);
+    fallback = 0;
+  };
+  while (true) {
+    const std::size_t end = fallback != 0U && limit < size - 2U ? limit + 2U : size;
+    const auto* hit = search + 1U < end
+                          ? static_cast<const unsigned char*>(std::memchr(data + search, 0xFF, end - search - 1U))
+                          : nullptr;
+    if (hit == nullptr) {
+      if (fallback == 0U || end == size) {
+        break;
+      }
+      accept(fallback, fallback_header);
+      continue;
+    }
+    const auto at = static_cast<std::size_t>(hit - data);
+    FrameHeader header;
+    const bool valid = parse_frame_header(hit, size - at, bits_per_sample_, header) &&
+                       header.channels == channels_ && header.bits_per_sample == bits_per_sample_ &&
+                       (blocks_.empty() || header.variable_block_size == variable_block_size) &&
+                       header.number == (header.variable_block_size ? total : blocks_.size());
+    if (!valid) {
+      search = at + 1U;
+      continue;
+    }
+    if (!blocks_.empty()) {
+      const std::size_t previous = blocks_.back().offset;
+      if (read_u16_be(data + at - 2U) != crc16(data + previous, at - 2U - previous)) {
+        if (fallback == 0U) {
+          fallback = at;
+          fallback_header = header;
+        }
+        search = at + 1U;
+        continue;
+      }
+    }
+    accept(at, header);
+  }
+  frame_count_ = total;
+}
+
+void FlacReader::decodeBlock(std::size_t index, DecodedBlock& out) const {
+  const unsigned char* data = file_.data();
+  const std::size_t offset = blocks_[index].offset;
+  const std::size_t end = index + 1U < blocks_.size() ? blocks_[index + 1U].offset : file_.size();
+  FrameHeader header;
+  parse_frame_header(data + offset, end - offset, bits_per_sample_, header);
+  const std::uint32_t n = header.block_size;
+
+  out.reader = 0;
+  out.samples.resize(static_cast<std::size_t>(n) * header.channels);
+  BitReader bits(data, end, offset + header.bytes);
+  for (unsigned c = 0; c < header.channels; ++c) {
+    const bool side = (header.channel_assignment == kLeftSide && c == 1U) ||
+                      (header.channel_assignment == kRightSide && c == 0U) ||
+                      (header.channel_assignment == kMidSide && c == 1U);
+    decode_subframe(bits, header.bits_per_sample + (side ? 1U : 0U), n, out.samples.data() + std::size_t{c} * n);
+  }
+  bits.alignToByte();
+  const std::size_t body_end = bits.bytePosition();
+  const std::uint32_t stored_crc = bits.bits(16);
+  if (bits.overran() || stored_crc != crc16(data + offset, body_end - offset)) {
+    corrupt_block();
+  }
+
+  std::int32_t* first = out.samples.data();
+  std::int32_t* second = header.channels > 1U ? first + n : first;
+  for (std::size_t i = 0; i < n; ++i) {
+    switch (header.channel_assignment) {
+      case kLeftSide:
+        second[i] = first[i] - second[i];
+        break;
+      case kRightSide:
+        first[i] += second[i];
+        break;
+      case kMidSide: {
+        const std::int32_t side = second[i];
+        const auto mid = static_cast<std::int32_t>((static_cast<std::uint32_t>(first[i]) << 1U) |
+                                                   (static_cast<std::uint32_t>(side) & 1U));
+        first[i] = (mid + side) >> 1;
+        second[i] = (mid - side) >> 1;
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  // Same scaling as PCM WAV: value * 2^-(bits - 1).
+  const float scale = 1.0F / static_cast<float>(std::uint32_t{1} << (header.bits_per_sample - 1U));
+  out.left.resize(n);
+  out.right.resize(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    out.left[i] = static_cast<float>(first[i]) * scale;
+    out.right[i] = static_cast<float>(second[i]) * scale;
+  }
+  out.index = index;
+  out.reader = id_;
+}
+
+void FlacReader::readStereo(std::size_t first_frame, std::size_t frames, float* left, float* right) const {
+  if (first_frame > frame_count_ || frames > frame_count_ - first_frame) {
+    throw std::out_of_range("flac frame range out of bounds");
+  }
+  // Readers on a thread pool each walk a contiguous range, so the last block
+  // decoded on this thread is usually the one the next read starts in.
+  thread_local DecodedBlock cache;
+  while (frames > 0U) {
+    const auto it = std::upper_bound(blocks_.begin(), blocks_.end(), first_frame,
+                                     [](std::size_t frame, const Block& block) { return frame < block.first_frame; });
+    const auto index = static_cast<std::size_t>(it - blocks_.begin()) - 1U;
+    if (cache.reader != id_ || cache.index != index) {
+      decodeBlock(index, cache);
+    }
+    const std::size_t skip = first_frame - blocks_[index].first_frame;
+    const std::size_t take = std::min(frames, cache.left.size() - skip);
+    std::memcpy(left, cache.left.data() + skip, take * sizeof(float));
+    std::memcpy(right, cache.right.data() + skip, take * sizeof(float));
+    left += take;
+    right += take;
+    first_frame += take;
+    frames -= take;
+  }
+}
+
+}  // namespace aifr3d::io
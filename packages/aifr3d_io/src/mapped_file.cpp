@@ -0,0 +1,145 @@
+#include "aifr3d/io/mapped_file.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace aifr3d::io {
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const std::string& path) {
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    throw std::invalid_argument("cannot open file: " + path);
+  }
+  LARGE_INTEGER size{};
+  if (GetFileSizeEx(file, &size) == 0) {
+    CloseHandle(file);
+    throw std::invalid_argument("cannot stat file: " + path);
+  }
+  size_ = static_cast<std::size_t>(size.QuadPart);
+  if (size_ > 0U) {
+    mapping_ = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_ != nullptr) {
+      data_ = static_cast<const unsigned char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    }
+  }
+  CloseHandle(file);
+  if (size_ > 0U && data_ == nullptr) {
+    unmap();
+    throw std::invalid_argument("cannot map file: " + path);
+  }
+}
+
+void MappedFile::unmap() noexcept {
+  if (data_ != nullptr) {
+    UnmapViewOfFile(data_);
+  }
+  if (mapping_ != nullptr) {
+    CloseHandle(mapping_);
+  }
+  data_ = nullptr;
+  mapping_ = nullptr;
+  size_ = 0;
+}
+
+void MappedFile::release(std::size_t /*offset*/, std::size_t /*length*/) const {
+  // The working set trimmer reclaims clean mapped pages on its own.
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      mapping_(std::exchange(other.mapping_, nullptr)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    unmap();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    mapping_ = std::exchange(other.mapping_, nullptr);
+  }
+  return *this;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw std::invalid_argument("cannot open file: " + path);
+  }
+  struct stat st {};
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw std::invalid_argument("cannot stat file: " + path);
+  }
+  size_ = static_cast<std::size_t>(st.st_size);
+  if (size_ > 0U) {
+    void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+      ::close(fd);
+      size_ = 0;
+      throw std::invalid_argument("cannot map file: " + path);
+    }
+    data_ = static_cast<const unsigned char*>(p);
+    // Readers walk each region front to back: read ahead, drop behind.
+    ::madvise(p, size_, MADV_SEQUENTIAL);
+  }
+  // The mapping keeps its own reference to the file.
+  ::close(fd);
+}
+
+void MappedFile::unmap() noexcept {
+  if (data_ != nullptr) {
+    ::munmap(const_cast<unsigned char*>(data_), size_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+}
+
+void MappedFile::release(std::size_t offset, std::size_t length) const {
+  if (data_ == nullptr || offset >= size_) {
+    return;
+  }
+  length = std::min(length, size_ - offset);
+  // Only whole pages inside the range may be dropped.
+  const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  const std::size_t begin = (offset + page - 1U) / page * page;
+  const std::size_t end = (offset + length) / page * page;
+  if (end > begin) {
+    ::madvise(const_cast<unsigned char*>(data_) + begin, end - begin, MADV_DONTNEED);
+  }
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    unmap();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+  }
+  return *this;
+}
+
+#endif
+
+MappedFile::~MappedFile() { unmap(); }
+
+}  // namespace aifr3d::io
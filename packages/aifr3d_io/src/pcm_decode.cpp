@@ -0,0 +1,372 @@
+#include "aifr3d/io/pcm_decode.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AIFR3D_IO_SSE2 1
+#include <emmintrin.h>
+#if defined(__SSSE3__)
+#define AIFR3D_IO_SSSE3 1
+#include <tmmintrin.h>
+#endif
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define AIFR3D_IO_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace aifr3d::io {
+
+namespace {
+
+constexpr float kScale16 = 1.0F / 32768.0F;
+constexpr float kScale24 = 1.0F / 8388608.0F;
+constexpr float kScale32 = 1.0F / 2147483648.0F;
+
+std::uint32_t read_u32_le(const unsigned char* p) {
+  return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8U) |
+         (static_cast<std::uint32_t>(p[2]) << 16U) | (static_cast<std::uint32_t>(p[3]) << 24U);
+}
+
+// Per-sample conversions; the vector kernels below must match them exactly.
+float pcm16_sample(const unsigned char* p) {
+  const auto v = static_cast<std::int16_t>(static_cast<std::uint16_t>(p[0] | (p[1] << 8U)));
+  return static_cast<float>(v) * kScale16;
+}
+
+float pcm24_sample(const unsigned char* p) {
+  // Sign-extend by placing the 24 bits at the top of an int32.
+  const auto v = static_cast<std::int32_t>((static_cast<std::uint32_t>(p[0]) << 8U) |
+                                           (static_cast<std::uint32_t>(p[1]) << 16U) |
+                                           (static_cast<std::uint32_t>(p[2]) << 24U));
+  return static_cast<float>(v >> 8) * kScale24;
+}
+
+float pcm32_sample(const unsigned char* p) {
+  return static_cast<float>(static_cast<std::int32_t>(read_u32_le(p))) * kScale32;
+}
+
+float float32_sample(const unsigned char* p) {
+  const std::uint32_t bits = read_u32_le(p);
+  float v = 0.0F;
+  std::memcpy(&v, &bits, sizeof(float));
+  return v;
+}
+
+float float64_sample(const unsigned char* p) {
+  const std::uint64_t bits =
+      static_cast<std::uint64_t>(read_u32_le(p)) | (static_cast<std::uint64_t>(read_u32_le(p + 4)) << 32U);
+  double v = 0.0;
+  std::memcpy(&v, &bits, sizeof(double));
+  return static_cast<float>(v);
+}
+
+using SampleFn = float (*)(const unsigned char*);
+
+template <SampleFn Sample>
+void pair_scalar(const unsigned char* src,
+                 std::size_t stride,
+                 std::size_t sample_bytes,
+                 std::size_t begin,
+                 std::size_t frames,
+                 float* a,
+                 float* b) {
+  src += begin * stride;
+  for (std::size_t i = begin; i < frames; ++i, src += stride) {
+    a[i] = Sample(src);
+    b[i] = Sample(src + sample_bytes);
+  }
+}
+
+template <SampleFn Sample>
+void channel_scalar(const unsigned char* src, std::size_t stride, std::size_t frames, float* out) {
+  for (std::size_t i = 0; i < frames; ++i, src += stride) {
+    out[i] = Sample(src);
+  }
+}
+
+// Vector kernels: each converts whole groups of four frames from `src` (the
+// first sample of the pair in frame 0) and returns how many frames it did.
+// The scalar loops finish the tail. `stride` is the frame size in bytes; a
+// stride equal to the pair size means plain stereo, read with full-width loads.
+
+#if defined(AIFR3D_IO_SSE2)
+
+std::int32_t load_i32(const unsigned char* p) {
+  std::int32_t v = 0;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+// Four 32-bit words, one per frame, starting `offset` bytes into each frame.
+__m128i gather_words(const unsigned char* p, std::size_t stride, std::size_t offset) {
+  p += offset;
+  return _mm_set_epi32(load_i32(p + 3U * stride), load_i32(p + 2U * stride), load_i32(p + stride), load_i32(p));
+}
+
+void store_scaled(float* out, __m128i v, __m128 scale) {
+  _mm_storeu_ps(out, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+}
+
+std::size_t pair_pcm16(const unsigned char* src, std::size_t stride, std::size_t frames, float* a, float* b) {
+  const __m128 scale = _mm_set1_ps(kScale16);
+  std::size_t i = 0;
+  for (; i + 4U <= frames; i += 4U) {
+    const unsigned char* p = src + i * stride;
+    // Each 32-bit lane holds one frame's pair: first sample low, second high.
+    const __m128i x =
+        stride == 4U ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)) : gather_words(p, stride, 0);
+    store_scaled(a + i, _mm_srai_epi32(_mm_slli_epi32(x, 16), 16), scale);
+    store_scaled(b + i, _mm_srai_epi32(x, 16), scale);
+  }
+  return i;
+}
+
+std::size_t pair_pcm24(const unsigned char* src, std::size_t stride, std::size_t frames, float* a, float* b) {
+  const __m128 scale = _mm_set1_ps(kScale24);
+  std::size_t i = 0;
+#if defined(AIFR3D_IO_SSSE3)
+  if (stride == 6U) {
+    // Four frames are 24 bytes: bytes 0..15 and 8..23. Each shuffle moves one
+    // sample's three bytes to the top of a 32-bit lane (0x80 lanes read as zero).
+    const __m128i first_lo =
+        _mm_setr_epi8(-128, 0, 1, 2, -128, 6, 7, 8, -128, -128, -128, -128, -128, -128, -128, -128);
+    const __m128i first_hi =
+        _mm_setr_epi8(-128, -128, -128, -128, -128, -128, -128, -128, -128, 4, 5, 6, -128, 10, 11, 12);
+    const __m128i second_lo =
+        _mm_setr_epi8(-128, 3, 4, 5, -128, 9, 10, 11, -128, -128, -128, -128, -128, -128, -128, -128);
+    const __m128i second_hi =
+        _mm_setr_epi8(-128, -128, -128, -128, -128, -128, -128, -128, -128, 7, 8, 9, -128, 13, 14, 15);
+    for (; i + 4U <= frames; i += 4U) {
+      const unsigned char* p = src + i * 6U;
+      const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 8));
+      const __m128i x = _mm_or_si128(_mm_shuffle_epi8(lo, first_lo), _mm_shuffle_epi8(hi, first_hi));
+      const __m128i y = _mm_or_si128(_mm_shuffle_epi8(lo, second_lo), _mm_shuffle_epi8(hi, second_hi));
+      store_scaled(a + i, _mm_srai_epi32(x, 8), scale);
+      store_scaled(b + i, _mm_srai_epi32(y, 8), scale);
+    }
+    return i;
+  }
+#endif
+  for (; i + 4U <= frames; i += 4U) {
+    const unsigned char* p = src + i * stride;
+    // Bytes 0..3 carry the first sample low; bytes 2..5 the second sample high.
+    // Both words stay inside the six-byte pair.
+    const __m128i x = gather_words(p, stride, 0);
+    const __m128i y = gather_words(p, stride, 2);
+    store_scaled(a + i, _mm_srai_epi32(_mm_slli_epi32(x, 8), 8), scale);
+    store_scaled(b + i, _mm_srai_epi32(y, 8), scale);
+  }
+  return i;
+}
+
+// Two frames of 32-bit pairs per register: [a0 b0 a1 b1], [a2 b2 a3 b3].
+void load_pairs32(const unsigned char* p, std::size_t stride, __m128& x0, __m128& x1) {
+  if (stride == 8U) {
+    x0 = _mm_loadu_ps(reinterpret_cast<const float*>(p));
+    x1 = _mm_loadu_ps(reinterpret_cast<const float*>(p + 16));
+    return;
+  }
+  const auto pair = [](const unsigned char* q) { return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(q)); };
+  x0 = _mm_castsi128_ps(_mm_unpacklo_epi64(pair(p), pair(p + stride)));
+  x1 = _mm_castsi128_ps(_mm_unpacklo_epi64(pair(p + 2U * stride), pair(p + 3U * stride)));
+}
+
+std::size_t pair_pcm32(const unsigned char* src, std::size_t stride, std::size_t frames, float* a, float* b) {
+  const __m128 scale = _mm_set1_ps(kScale32);
+  std::size_t i = 0;
+  for (; i + 4U <= frames; i += 4U) {
+    __m128 x0;
+    __m128 x1;
+    load_pairs32(src + i * stride, stride, x0, x1);
+    store_scaled(a + i, _mm_castps_si128(_mm_shuffle_ps(x0, x1, _MM_SHUFFLE(2, 0, 2, 0))), scale);
+    store_scaled(b + i, _mm_castps_si128(_mm_shuffle_ps(x0, x1, _MM_SHUFFLE(3, 1, 3, 1))), scale);
+  }
+  return i;
+}
+
+std::size_t pair_float32(const unsigned char* src, std::size_t stride, std::size_t frames, float* a, float* b) {
+  std::size_t i = 0;
+  for (; i + 4U <= frames; i += 4U) {
+    __m128 x0;
+    __m128 x1;
+    load_pairs32(src + i * stride, stride, x0, x1);
+    _mm_storeu_ps(a + i, _mm_shuffle_ps(x0, x1, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(b + i, _mm_shuffle_ps(x0, x1, _MM_SHUFFLE(3, 1, 3, 1)));
+  }
+  return i;
+}
+
+std::size_t pair_float64(const unsigned char* src, std::size_t stride, std::size_t frames, float* a, float* b) {
+  const auto frame = [&](std::size_t i) { return _mm_loadu_pd(reinterpret_cast<const double*>(src + i * stride)); };
+  std::size_t i = 0;
+  for (; i + 4U <= frames; i += 4U) {
+    const __m128d f0 = frame(i);
+    const __m128d f1 = frame(i + 1U);
+    const __m128d f2 = frame(i + 2U);
+    const __m128d f3 = frame(i + 3U);
+    _mm_storeu_ps(a + i, _mm_movelh_ps(_mm_cvtpd_ps(_mm_unpacklo_pd(f0, f1)), _mm_cvtpd_ps(_mm_unpacklo_pd(f2, f3))));
+    _mm_storeu_ps(b + i, _mm_movelh_ps(_mm_cvtpd_ps(_mm_unpackhi_pd(f0, f1)), _mm_cvtpd_ps(_mm_unpackhi_pd(f2, f3))));
+  }
+  return i;
+}
+
+#elif defined(AIFR3D_IO_NEON)
+
+// NEON de-interleaves plain stereo with structured loads; other layouts and
+// packed 24-bit take the scalar loop.
+
+std::size_t pair_pcm16(const unsigned char* src, std::size_t stride, std::size_t frames, float* a, float* b) {
+  if (stride != 4U) {
+    return 0;
+  }
+  std::size_t i = 0;
+  for (; i + 4U <= frames; i += 4U) {
+    const int16x4x2_t x = vld2_s16(reinterpret_cast<const std::int16_t*>(src + i * 4U));
+    vst1q_f32(a + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(x.val[0])), kScale16));
+    vst1q_f32(b + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(x.val[1])), kScale16));
+  }
+  return i;
+}
+
+std::size_t pair_pcm24(const unsigned char*, std::size_t, std::size_t, float*, float*) { return 0; }
+
+std::size_t pair_pcm32(const unsigned char* src, std::size_t stride, std::size_t frames, float* a, float* b) {
+  if (stride != 8U) {
+    return 0;
+  }
+  std::size_t i = 0;
+  for (; i + 4U <= frames; i += 4U) {
+    const int32x4x2_t x = vld2q_s32(reinterpret_cast<const std::int32_t*>(src + i * 8U));
+    vst1q_f32(a + i, vmulq_n_f32(vcvtq_f32_s32(x.val[0]), kScale32));
+    vst1q_f32(b + i, vmulq_n_f32(vcvtq_f32_s32(x.val[1]), kScale32));
+  }
+  return i;
+}
+
+std::size_t pair_float32(const unsigned char* src, std::size_t stride, std::size_t frames, float* a, float* b) {
+  if (stride != 8U) {
+    return 0;
+  }
+  std::size_t i = 0;
+  for (; i + 4U <= frames; i += 4U) {
+    const float32x4x2_t x = vld2q_f32(reinterpret_cast<const float*>(src + i * 8U));
+    vst1q_f32(a + i, x.val[0]);
+    vst1q_f32(b + i, x.val[1]);
+  }
+  return i;
+}
+
+std::size_t pair_float64(const unsigned char* src, std::size_t stride, std::size_t frames, float* a, float* b) {
+  if (stride != 16U) {
+    return 0;
+  }
+  std::size_t i = 0;
+  for (; i + 4U <= frames; i += 4U) {
+    const float64x2x2_t x0 = vld2q_f64(reinterpret_cast<const double*>(src + i * 16U));
+    const float64x2x2_t x1 = vld2q_f64(reinterpret_cast<const double*>(src + (i + 2U) * 16U));
+    vst1q_f32(a + i, vcombine_f32(vcvt_f32_f64(x0.val[0]), vcvt_f32_f64(x1.val[0])));
+    vst1q_f32(b + i, vcombine_f32(vcvt_f32_f64(x0.val[1]), vcvt_f32_f64(x1.val[1])));
+  }
+  return i;
+}
+
+#else
+
+std::size_t pair_pcm16(const unsigned char*, std::size_t, std::size_t, float*, float*) { return 0; }
+std::size_t pair_pcm24(const unsigned char*, std::size_t, std::size_t, float*, float*) { return 0; }
+std::size_t pair_pcm32(const unsigned char*, std::size_t, std::size_t, float*, float*) { return 0; }
+std::size_t pair_float32(const unsigned char*, std::size_t, std::size_t, float*, float*) { return 0; }
+std::size_t pair_float64(const unsigned char*, std::size_t, std::size_t, float*, float*) { return 0; }
+
+#endif
+
+using PairKernel = std::size_t (*)(const unsigned char*, std::size_t, std::size_t, float*, float*);
+
+template <SampleFn Sample>
+void run_pair(PairKernel kernel,
+              const unsigned char* src,
+              std::size_t stride,
+              std::size_t sample_bytes,
+              std::size_t frames,
+              float* a,
+              float* b) {
+  pair_scalar<Sample>(src, stride, sample_bytes, kernel(src, stride, frames, a, b), frames, a, b);
+}
+
+}  // namespace
+
+std::size_t bytes_per_sample(SampleFormat format) {
+  switch (format) {
+    case SampleFormat::kPcm16:
+      return 2;
+    case SampleFormat::kPcm24:
+      return 3;
+    case SampleFormat::kPcm32:
+    case SampleFormat::kFloat32:
+      return 4;
+    case SampleFormat::kFloat64:
+      break;
+  }
+  return 8;
+}
+
+void decode_channel_pair(SampleFormat format,
+                         const unsigned char* src,
+                         std::size_t channels,
+                         std::size_t first_channel,
+                         std::size_t frames,
+                         float* out_first,
+                         float* out_second) {
+  const std::size_t sample_bytes = bytes_per_sample(format);
+  const std::size_t stride = channels * sample_bytes;
+  src += first_channel * sample_bytes;
+  switch (format) {
+    case SampleFormat::kPcm16:
+      run_pair<pcm16_sample>(pair_pcm16, src, stride, sample_bytes, frames, out_first, out_second);
+      break;
+    case SampleFormat::kPcm24:
+      run_pair<pcm24_sample>(pair_pcm24, src, stride, sample_bytes, frames, out_first, out_second);
+      break;
+    case SampleFormat::kPcm32:
+      run_pair<pcm32_sample>(pair_pcm32, src, stride, sample_bytes, frames, out_first, out_second);
+      break;
+    case SampleFormat::kFloat32:
+      run_pair<float32_sample>(pair_float32, src, stride, sample_bytes, frames, out_first, out_second);
+      break;
+    case SampleFormat::kFloat64:
+      run_pair<float64_sample>(pair_float64, src, stride, sample_bytes, frames, out_first, out_second);
+      break;
+  }
+}
+
+void decode_channel(SampleFormat format,
+                    const unsigned char* src,
+                    std::size_t channels,
+                    std::size_t channel,
+                    std::size_t frames,
+                    float* out) {
+  const std::size_t sample_bytes = bytes_per_sample(format);
+  src += channel * sample_bytes;
+  const std::size_t stride = channels * sample_bytes;
+  switch (format) {
+    case SampleFormat::kPcm16:
+      channel_scalar<pcm16_sample>(src, stride, frames, out);
+      break;
+    case SampleFormat::kPcm24:
+      channel_scalar<pcm24_sample>(src, stride, frames, out);
+      break;
+    case SampleFormat::kPcm32:
+      channel_scalar<pcm32_sample>(src, stride, frames, out);
+      break;
+    case SampleFormat::kFloat32:
+      channel_scalar<float32_sample>(src, stride, frames, out);
+      break;
+    case SampleFormat::kFloat64:
+      channel_scalar<float64_sample>(src, stride, frames, out);
+      break;
+  }
+}
+
+}  // namespace aifr3d::io
@@ -0,0 +1,449 @@
+#include "aifr3d/io/read_ahead.hpp"
+
+#include "aifr3d/io/pcm_decode.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(AIFR3D_IO_HAVE_URING)
+#include <liburing.h>
+#endif
+
+namespace aifr3d::io {
+
+namespace {
+
+// Read-only file with positional reads, safe to call from several threads.
+class PositionalFile {
+ public:
+#if defined(_WIN32)
+  explicit PositionalFile(const std::string& path)
+      : handle_(CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr)) {
+    if (handle_ == INVALID_HANDLE_VALUE) {
+      throw std::invalid_argument("cannot open file: " + path);
+    }
+    LARGE_INTEGER size{};
+    if (GetFileSizeEx(handle_, &size) == 0) {
+      CloseHandle(handle_);
+      throw std::invalid_argument("cannot stat file: " + path);
+    }
+    size_ = static_cast<std::uint64_t>(size.QuadPart);
+  }
+  ~PositionalFile() { CloseHandle(handle_); }
+#else
+  explicit PositionalFile(const std::string& path) : fd_(::open(path.c_str(), O_RDONLY | O_CLOEXEC)) {
+    if (fd_ < 0) {
+      throw std::invalid_argument("cannot open file: " + path);
+    }
+    struct stat st {};
+    if (::fstat(fd_, &st) != 0) {
+      ::close(fd_);
+      throw std::invalid_argument("cannot stat file: " + path);
+    }
+    size_ = static_cast<std::uint64_t>(st.st_size);
+#if defined(POSIX_FADV_SEQUENTIAL)
+    ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+  }
+  ~PositionalFile() { ::close(fd_); }
+  int fd() const { return fd_; }
+#endif
+  PositionalFile(const PositionalFile&) = delete;
+  PositionalFile& operator=(const PositionalFile&) = delete;
+
+  std::uint64_t size() const { return size_; }
+
+  // Reads up to `bytes` at `offset`, retrying short reads; returns fewer only
+  // at end of file. Throws std::runtime_error when the read fails.
+  std::size_t readAt(unsigned char* dst, std::size_t bytes, std::uint64_t offset) const {
+    std::size_t done = 0;
+    while (done < bytes) {
+#if defined(_WIN32)
+      const auto chunk = static_cast<DWORD>(std::min<std::size_t>(bytes - done, 1U << 30U));
+      const std::uint64_t at = offset + done;
+      OVERLAPPED position{};
+      position.Offset = static_cast<DWORD>(at);
+      position.OffsetHigh = static_cast<DWORD>(at >> 32U);
+      DWORD n = 0;
+      if (ReadFile(handle_, dst + done, chunk, &n, &position) == 0) {
+        if (GetLastError() == ERROR_HANDLE_EOF) {
+          break;
+        }
+        throw std::runtime_error("file read failed");
+      }
+#else
+      const ssize_t n = ::pread(fd_, dst + done, bytes - done, static_cast<off_t>(offset + done));
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        throw std::runtime_error("file read failed");
+      }
+#endif
+      if (n == 0) {
+        break;
+      }
+      done += static_cast<std::size_t>(n);
+    }
+    return done;
+  }
+
+ private:
+#if defined(_WIN32)
+  HANDLE handle_;
+#else
+  int fd_;
+#endif
+  std::uint64_t size_{0};
+};
+
+enum class SlotState { kFree, kReading, kRead, kDecoded };
+
+// One ring entry. Block k always lives in slot k % queue_depth; `block` is the
+// block the slot holds, or the next one it will take once free.
+struct Slot {
+  SlotState state{SlotState::kFree};
+  std::size_t block{0};
+  std::uint64_t offset{0};
+  std::size_t bytes{0};
+  std::size_t frames{0};
+  std::vector<unsigned char> raw;
+  std::vector<float> left;
+  std::vector<float> right;
+};
+
+}  // namespace
+
+struct ReadAheadWavReader::State {
+  explicit State(const std::string& path) : file(path) {}
+
+  PositionalFile file;
+  WavLayout layout;
+  std::size_t frame_count{0};
+  std::size_t block_bytes{0};
+  std::uint64_t data_bytes{0};
+  std::size_t block_count{0};
+  std::vector<Slot> slots;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::size_t next_read{0};
+  std::size_t next_consume{0};
+  bool holding{false};
+  bool stopping{false};
+  std::exception_ptr error;
+  std::vector<std::thread> threads;
+
+#if defined(AIFR3D_IO_HAVE_URING)
+  io_uring ring{};
+#endif
+  bool uring{false};
+
+  Slot& slotFor(std::size_t block) { return slots[block % slots.size()]; }
+
+  bool readable(std::size_t block) {
+    const Slot& slot = slotFor(block);
+    return slot.state == SlotState::kFree && slot.block == block;
+  }
+
+  // Claims the next block for reading. Caller holds `mutex`.
+  Slot& claimRead() {
+    const std::size_t block = next_read++;
+    Slot& slot = slotFor(block);
+    slot.state = SlotState::kReading;
+    slot.offset = static_cast<std::uint64_t>(block) * block_bytes;
+    slot.bytes = static_cast<std::size_t>(std::min<std::uint64_t>(block_bytes, data_bytes - slot.offset));
+    return slot;
+  }
+
+  void fail(std::exception_ptr e) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    if (!error) {
+      error = e;
+    }
+    stopping = true;
+    cv.notify_all();
+  }
+
+  // Stops every stage, joins the threads started so far and releases the
+  // ring. Safe on a partially started pipeline.
+  void shutdown() {
+    {
+      const std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    cv.notify_all();
+    for (std::thread& t : threads) {
+      if (t.joinable()) {
+        t.join();
+      }
+    }
+    threads.clear();
+#if defined(AIFR3D_IO_HAVE_URING)
+    if (uring) {
+      io_uring_queue_exit(&ring);
+      uring = false;
+    }
+#endif
+  }
+
+  void preadLoop();
+  void uringLoop();
+  void decodeLoop();
+};
+
+void ReadAheadWavReader::State::preadLoop() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    cv.wait(lock, [&] { return stopping || next_read >= block_count || readable(next_read); });
+    if (stopping || next_read >= block_count) {
+      return;
+    }
+    Slot& slot = claimRead();
+    lock.unlock();
+    std::size_t got = 0;
+    try {
+      got = file.readAt(slot.raw.data(), slot.bytes, layout.data_offset + slot.offset);
+    } catch (...) {
+      fail(std::current_exception());
+      return;
+    }
+    lock.lock();
+    slot.bytes = got;
+    slot.state = SlotState::kRead;
+    cv.notify_all();
+  }
+}
+
+#if defined(AIFR3D_IO_HAVE_URING)
+
+void ReadAheadWavReader::State::uringLoop() {
+  // Reads the kernel has accepted, and reads prepared but not yet submitted.
+  std::size_t in_flight = 0;
+  std::size_t unsubmitted = 0;
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    while (!stopping && next_read < block_count && readable(next_read)) {
+      io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+      if (sqe == nullptr) {
+        break;
+      }
+      Slot& slot = claimRead();
+      io_uring_prep_read(sqe, file.fd(), slot.raw.data(), static_cast<unsigned>(slot.bytes),
+                         layout.data_offset + slot.offset);
+      io_uring_sqe_set_data(sqe, &slot);
+      ++unsubmitted;
+    }
+    if (unsubmitted > 0U) {
+      lock.unlock();
+      const int submitted = io_uring_submit(&ring);
+      if (submitted > 0) {
+        in_flight += static_cast<std::size_t>(submitted);
+        unsubmitted -= static_cast<std::size_t>(submitted);
+      }
+      // A short or refused (-EAGAIN, -EBUSY) submit is retried after a
+      // completion is reaped, which frees what the kernel ran short of. With
+      // nothing in flight there is nothing to reap, so that is an error.
+      const bool refused = submitted < 0 && submitted != -EINTR && submitted != -EAGAIN && submitted != -EBUSY;
+      const bool stalled = unsubmitted > 0U && in_flight == 0U && submitted != -EINTR;
+      if (refused || stalled) {
+        fail(std::make_exception_ptr(std::runtime_error("io_uring submit failed")));
+        // Prepared reads are never submitted; submitted ones are reaped below.
+        unsubmitted = 0;
+      }
+      lock.lock();
+      if (unsubmitted > 0U && in_flight == 0U) {
+        continue;  // interrupted before anything was submitted
+      }
+    }
+    // Once stopping, keep reaping: a submitted read may still write into its
+    // slot, so the loop only exits with nothing in flight.
+    if (in_flight == 0U) {
+      if (stopping || next_read >= block_count) {
+        return;
+      }
+      cv.wait(lock, [&] { return stopping || readable(next_read); });
+      continue;
+    }
+
+    lock.unlock();
+    io_uring_cqe* cqe = nullptr;
+    const int rc = io_uring_wait_cqe(&ring, &cqe);
+    if (rc == -EINTR) {
+      lock.lock();
+      continue;
+    }
+    if (rc < 0) {
+      fail(std::make_exception_ptr(std::runtime_error("io_uring wait failed")));
+      return;
+    }
+    Slot& slot = *static_cast<Slot*>(io_uring_cqe_get_data(cqe));
+    const int res = cqe->res;
+    io_uring_cqe_seen(&ring, cqe);
+    std::size_t got = 0;
+    try {
+      if (res < 0) {
+        throw std::runtime_error("file read failed");
+      }
+      got = static_cast<std::size_t>(res);
+      if (got > 0U && got < slot.bytes) {
+        // Short reads are rare on regular files; finish them synchronously.
+        got += file.readAt(slot.raw.data() + got, slot.bytes - got, layout.data_offset + slot.offset + got);
+      }
+    } catch (...) {
+      fail(std::current_exception());
+    }
+    lock.lock();
+    --in_flight;
+    slot.bytes = got;
+    slot.state = SlotState::kRead;
+    cv.notify_all();
+  }
+}
+
+#else
+
+void ReadAheadWavReader::State::uringLoop() {}
+
+#endif
+
+void ReadAheadWavReader::State::decodeLoop() {
+  const WavFormat& format = layout.format;
+  for (std::size_t block = 0; block < block_count; ++block) {
+    Slot& slot = slotFor(block);
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait(lock, [&] { return stopping || (slot.block == block && slot.state == SlotState::kRead); });
+      if (stopping) {
+        return;
+      }
+    }
+    // The slot belongs to this stage until it is marked decoded.
+    const std::size_t frames = slot.bytes / format.block_align;
+    if (format.channels == 1U) {
+      decode_channel(format.sample_format, slot.raw.data(), 1, 0, frames, slot.left.data());
+      std::memcpy(slot.right.data(), slot.left.data(), frames * sizeof(float));
+    } else {
+      decode_channel_pair(format.sample_format, slot.raw.data(), format.channels, 0, frames, slot.left.data(),
+                          slot.right.data());
+    }
+    const std::lock_guard<std::mutex> lock(mutex);
+    slot.frames = frames;
+    slot.state = SlotState::kDecoded;
+    cv.notify_all();
+  }
+}
+
+ReadAheadWavReader::ReadAheadWavReader(const std::string& path, const ReadAheadOptions& options)
+    : state_(std::make_unique<State>(path)) {
+  if (options.block_frames == 0U || options.queue_depth == 0U || options.io_threads == 0U) {
+    throw std::invalid_argument("ReadAheadOptions sizes must be positive");
+  }
+  State& s = *state_;
+  std::uint64_t pos = 0;
+  s.layout = parse_wav_header([&](unsigned char* dst, std::size_t bytes) {
+    if (bytes > s.file.size() - std::min(pos, s.file.size())) {
+      return false;
+    }
+    if (dst != nullptr && s.file.readAt(dst, bytes, pos) != bytes) {
+      return false;
+    }
+    pos += bytes;
+    return true;
+  });
+  const std::uint64_t available = s.file.size() - s.layout.data_offset;
+  s.data_bytes = s.layout.data_bytes_known ? s.layout.data_bytes : available;
+  if (s.data_bytes > available) {
+    throw std::invalid_argument("wav data chunk runs past the end of " + path);
+  }
+  const std::size_t block_align = s.layout.format.block_align;
+  s.frame_count = static_cast<std::size_t>(s.data_bytes / block_align);
+  s.data_bytes = static_cast<std::uint64_t>(s.frame_count) * block_align;
+  s.block_bytes = options.block_frames * block_align;
+  s.block_count = (s.frame_count + options.block_frames - 1U) / options.block_frames;
+
+  s.slots.resize(std::min(options.queue_depth, std::max<std::size_t>(s.block_count, 1U)));
+  for (std::size_t i = 0; i < s.slots.size(); ++i) {
+    Slot& slot = s.slots[i];
+    slot.block = i;
+    slot.raw.resize(s.block_bytes);
+    slot.left.resize(options.block_frames);
+    slot.right.resize(options.block_frames);
+  }
+
+#if defined(AIFR3D_IO_HAVE_URING)
+  s.uring = options.use_io_uring && io_uring_queue_init(static_cast<unsigned>(s.slots.size()), &s.ring, 0) == 0;
+#endif
+  // A thread that fails to start must not leave the others running against
+  // a State that is about to be destroyed.
+  try {
+    if (s.uring) {
+      s.threads.emplace_back([&s] { s.uringLoop(); });
+    } else {
+      for (std::size_t i = 0; i < options.io_threads; ++i) {
+        s.threads.emplace_back([&s] { s.preadLoop(); });
+      }
+    }
+    s.threads.emplace_back([&s] { s.decodeLoop(); });
+  } catch (...) {
+    s.shutdown();
+    throw;
+  }
+}
+
+ReadAheadWavReader::~ReadAheadWavReader() { state_->shutdown(); }
+
+const WavFormat& ReadAheadWavReader::format() const { return state_->layout.format; }
+
+std::size_t ReadAheadWavReader::frameCount() const { return state_->frame_count; }
+
+const char* ReadAheadWavReader::backend() const { return state_->uring ? "io_uring" : "pread"; }
+
+PlanarBlockView ReadAheadWavReader::next() {
+  State& s = *state_;
+  std::unique_lock<std::mutex> lock(s.mutex);
+  if (s.holding) {
+    Slot& done = s.slotFor(s.next_consume - 1U);
+    done.state = SlotState::kFree;
+    done.block += s.slots.size();
+    s.holding = false;
+    s.cv.notify_all();
+  }
+  if (s.error) {
+    std::rethrow_exception(s.error);
+  }
+  if (s.next_consume >= s.block_count) {
+    return {};
+  }
+  const std::size_t block = s.next_consume;
+  Slot& slot = s.slotFor(block);
+  s.cv.wait(lock, [&] { return s.error || (slot.block == block && slot.state == SlotState::kDecoded); });
+  if (s.error) {
+    std::rethrow_exception(s.error);
+  }
+  ++s.next_consume;
+  s.holding = true;
+  return {slot.left.data(), slot.right.data(), slot.frames};
+}
+
+}  // namespace aifr3d::io
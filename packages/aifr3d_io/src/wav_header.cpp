@@ -0,0 +1,148 @@
+#include "aifr3d/io/wav_header.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+namespace aifr3d::io {
+
+namespace {
+
+constexpr std::uint16_t kFormatPcm = 0x0001;
+constexpr std::uint16_t kFormatFloat = 0x0003;
+constexpr std::uint16_t kFormatExtensible = 0xFFFE;
+// 32-bit size fields holding this value defer to the ds64 chunk (RF64/BW64)
+// or are unknown (plain RIFF written to a pipe).
+constexpr std::uint32_t kSizeDeferred = 0xFFFFFFFFU;
+
+std::uint16_t read_u16_le(const unsigned char* p) {
+  return static_cast<std::uint16_t>(p[0] | (p[1] << 8U));
+}
+
+std::uint32_t read_u32_le(const unsigned char* p) {
+  return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8U) |
+         (static_cast<std::uint32_t>(p[2]) << 16U) | (static_cast<std::uint32_t>(p[3]) << 24U);
+}
+
+std::uint64_t read_u64_le(const unsigned char* p) {
+  return static_cast<std::uint64_t>(read_u32_le(p)) | (static_cast<std::uint64_t>(read_u32_le(p + 4)) << 32U);
+}
+
+bool chunk_is(const unsigned char* p, const char* id) { return std::memcmp(p, id, 4) == 0; }
+
+SampleFormat sample_format_for(std::uint16_t format_tag, std::uint16_t bits_per_sample) {
+  if (format_tag == kFormatPcm) {
+    switch (bits_per_sample) {
+      case 16:
+        return SampleFormat::kPcm16;
+      case 24:
+        return SampleFormat::kPcm24;
+      case 32:
+        return SampleFormat::kPcm32;
+      default:
+        break;
+    }
+    throw std::invalid_argument("unsupported wav PCM bit depth");
+  }
+  if (format_tag == kFormatFloat) {
+    if (bits_per_sample == 32) {
+      return SampleFormat::kFloat32;
+    }
+    if (bits_per_sample == 64) {
+      return SampleFormat::kFloat64;
+    }
+    throw std::invalid_argument("unsupported wav float bit depth");
+  }
+  throw std::invalid_argument("unsupported wav encoding (only PCM/float)");
+}
+
+// Reads the first min(size, N) bytes of a chunk body into `body` and skips
+// the rest, including the pad byte of odd-sized chunks.
+template <std::size_t N>
+void read_chunk_body(const WavHeaderReader& read, std::uint64_t size, std::array<unsigned char, N>& body) {
+  const std::size_t head = static_cast<std::size_t>(std::min<std::uint64_t>(size, N));
+  if (!read(body.data(), head) || !read(nullptr, static_cast<std::size_t>(size - head + size % 2U))) {
+    throw std::invalid_argument("invalid wav chunk bounds");
+  }
+}
+
+}  // namespace
+
+WavLayout parse_wav_header(const WavHeaderReader& read) {
+  std::array<unsigned char, 12> riff{};
+  if (!read(riff.data(), riff.size()) || !chunk_is(riff.data() + 8, "WAVE") ||
+      !(chunk_is(riff.data(), "RIFF") || chunk_is(riff.data(), "RF64") || chunk_is(riff.data(), "BW64"))) {
+    throw std::invalid_argument("not a RIFF/RF64/BW64 WAVE file");
+  }
+  const bool wide = !chunk_is(riff.data(), "RIFF");
+
+  WavLayout layout;
+  bool have_fmt = false;
+  bool have_ds64 = false;
+  std::uint64_t ds64_data_bytes = 0;
+  std::uint16_t format_tag = 0;
+  std::uint16_t bits_per_sample = 0;
+  std::uint64_t offset = riff.size();
+  std::array<unsigned char, 8> header{};
+  while (read(header.data(), header.size())) {
+    const std::uint32_t size = read_u32_le(header.data() + 4);
+    offset += header.size();
+    if (chunk_is(header.data(), "data")) {
+      layout.data_offset = offset;
+      if (size != kSizeDeferred) {
+        layout.data_bytes = size;
+      } else if (have_ds64) {
+        layout.data_bytes = ds64_data_bytes;
+      } else if (wide) {
+        throw std::invalid_argument("RF64 data chunk without a ds64 size");
+      } else {
+        layout.data_bytes_known = false;
+      }
+      if (!have_fmt || layout.format.sample_rate_hz == 0 || layout.format.channels == 0) {
+        break;
+      }
+      layout.format.sample_format = sample_format_for(format_tag, bits_per_sample);
+      const std::size_t frame_bytes = static_cast<std::size_t>(bits_per_sample / 8U) * layout.format.channels;
+      if (layout.format.block_align != frame_bytes) {
+        throw std::invalid_argument("invalid wav format geometry");
+      }
+      return layout;
+    }
+    if (chunk_is(header.data(), "ds64")) {
+      if (size < 28U) {
+        throw std::invalid_argument("invalid ds64 chunk");
+      }
+      // RIFF size, data size, sample count, then an optional chunk-size table.
+      std::array<unsigned char, 24> body{};
+      read_chunk_body(read, size, body);
+      ds64_data_bytes = read_u64_le(body.data() + 8);
+      have_ds64 = true;
+    } else if (chunk_is(header.data(), "fmt ")) {
+      if (size < 16U) {
+        throw std::invalid_argument("invalid fmt chunk");
+      }
+      std::array<unsigned char, 40> body{};
+      read_chunk_body(read, size, body);
+      format_tag = read_u16_le(body.data());
+      layout.format.channels = read_u16_le(body.data() + 2);
+      layout.format.sample_rate_hz = read_u32_le(body.data() + 4);
+      layout.format.block_align = read_u16_le(body.data() + 12);
+      bits_per_sample = read_u16_le(body.data() + 14);
+      if (format_tag == kFormatExtensible) {
+        if (size < 40U) {
+          throw std::invalid_argument("invalid extensible fmt chunk");
+        }
+        // The sub-format GUID starts with the plain format tag.
+        format_tag = read_u16_le(body.data() + 24);
+      }
+      have_fmt = true;
+    } else if (!read(nullptr, static_cast<std::size_t>(size) + size % 2U)) {
+      throw std::invalid_argument("invalid wav chunk bounds");
+    }
+    offset += static_cast<std::uint64_t>(size) + size % 2U;
+  }
+  throw std::invalid_argument("wav missing required fmt/data fields");
+}
+
+}  // namespace aifr3d::io
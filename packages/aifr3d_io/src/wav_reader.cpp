@@ -0,0 +1,63 @@
+#include "aifr3d/io/wav_reader.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace aifr3d::io {
+
+WavReader::WavReader(const std::string& path) : file_(path) {
+  std::size_t pos = 0;
+  const WavLayout layout = parse_wav_header([&](unsigned char* dst, std::size_t bytes) {
+    if (bytes > file_.size() - pos) {
+      return false;
+    }
+    if (dst != nullptr) {
+      std::memcpy(dst, file_.data() + pos, bytes);
+    }
+    pos += bytes;
+    return true;
+  });
+  const std::uint64_t available = file_.size() - layout.data_offset;
+  const std::uint64_t data_bytes = layout.data_bytes_known ? layout.data_bytes : available;
+  if (data_bytes > available) {
+    throw std::invalid_argument("wav data chunk runs past the end of " + path);
+  }
+  format_ = layout.format;
+  data_offset_ = static_cast<std::size_t>(layout.data_offset);
+  frame_count_ = static_cast<std::size_t>(data_bytes / format_.block_align);
+}
+
+void WavReader::readStereo(std::size_t first_frame, std::size_t frames, float* left, float* right) const {
+  if (format_.channels == 1U) {
+    checkRange(first_frame, frames);
+    decode_channel(format_.sample_format, dataBytes() + first_frame * format_.block_align, 1, 0, frames, left);
+    std::memcpy(right, left, frames * sizeof(float));
+    return;
+  }
+  readChannelPair(first_frame, frames, 0, left, right);
+}
+
+void WavReader::readChannelPair(std::size_t first_frame,
+                                std::size_t frames,
+                                std::size_t first_channel,
+                                float* left,
+                                float* right) const {
+  checkRange(first_frame, frames);
+  if (first_channel + 1U >= format_.channels) {
+    throw std::out_of_range("wav channel pair out of range");
+  }
+  decode_channel_pair(format_.sample_format, dataBytes() + first_frame * format_.block_align, format_.channels,
+                      first_channel, frames, left, right);
+}
+
+void WavReader::checkRange(std::size_t first_frame, std::size_t frames) const {
+  if (first_frame > frame_count_ || frames > frame_count_ - first_frame) {
+    throw std::out_of_range("wav frame range out of bounds");
+  }
+}
+
+void WavReader::releaseFrames(std::size_t first_frame, std::size_t frames) const {
+  file_.release(data_offset_ + first_frame * format_.block_align, frames * format_.block_align);
+}
+
+}  // namespace aifr3d::io
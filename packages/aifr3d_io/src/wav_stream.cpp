@@ -0,0 +1,64 @@
+#include "aifr3d/io/wav_stream.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace aifr3d::io {
+
+WavStream::WavStream(const std::string& path, std::size_t block_frames)
+    : file_(std::make_unique<std::ifstream>(path, std::ios::binary)), in_(file_.get()) {
+  if (!*file_) {
+    throw std::invalid_argument("cannot open file: " + path);
+  }
+  open(block_frames);
+}
+
+WavStream::WavStream(std::istream& in, std::size_t block_frames) : in_(&in) { open(block_frames); }
+
+void WavStream::open(std::size_t block_frames) {
+  if (block_frames == 0U) {
+    throw std::invalid_argument("WavStream block_frames must be positive");
+  }
+  layout_ = parse_wav_header([this](unsigned char* dst, std::size_t bytes) {
+    const auto n = static_cast<std::streamsize>(bytes);
+    if (dst == nullptr) {
+      in_->ignore(n);
+    } else {
+      in_->read(reinterpret_cast<char*>(dst), n);
+    }
+    return in_->gcount() == n;
+  });
+  block_frames_ = block_frames;
+  remaining_bytes_ =
+      layout_.data_bytes_known ? layout_.data_bytes : std::numeric_limits<std::uint64_t>::max();
+  raw_.resize(block_frames * layout_.format.block_align);
+}
+
+std::optional<std::uint64_t> WavStream::frameCount() const {
+  if (!layout_.data_bytes_known) {
+    return std::nullopt;
+  }
+  return layout_.data_bytes / layout_.format.block_align;
+}
+
+std::size_t WavStream::next(float* left, float* right) {
+  const std::size_t block_align = layout_.format.block_align;
+  const std::size_t want = static_cast<std::size_t>(std::min<std::uint64_t>(raw_.size(), remaining_bytes_));
+  in_->read(reinterpret_cast<char*>(raw_.data()), static_cast<std::streamsize>(want));
+  // A truncated final frame is dropped.
+  const std::size_t frames = static_cast<std::size_t>(in_->gcount()) / block_align;
+  remaining_bytes_ = frames * block_align < want ? 0U : remaining_bytes_ - want;
+
+  const SampleFormat format = layout_.format.sample_format;
+  if (layout_.format.channels == 1U) {
+    decode_channel(format, raw_.data(), 1, 0, frames, left);
+    std::memcpy(right, left, frames * sizeof(float));
+  } else {
+    decode_channel_pair(format, raw_.data(), layout_.format.channels, 0, frames, left, right);
+  }
+  return frames;
+}
+
+}  // namespace aifr3d::io
@@ -0,0 +1,559 @@
+#include "aifr3d/io/flac_reader.hpp"
+
+#include "aifr3d/analyzer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+void require(bool cond, const std::string& msg) {
+  if (!cond) {
+    throw std::runtime_error(msg);
+  }
+}
+
+template <typename Fn>
+bool throws(Fn&& fn) {
+  try {
+    fn();
+  } catch (const std::invalid_argument&) {
+    return true;
+  }
+  return false;
+}
+
+class BitWriter {
+ public:
+  void put(std::uint64_t value, unsigned n) {
+    for (unsigned i = n; i > 0; --i) {
+      bit(((value >> (i - 1U)) & 1U) != 0U);
+    }
+  }
+  void putSigned(std::int64_t value, unsigned n) { put(static_cast<std::uint64_t>(value), n); }
+  void putUnary(std::uint64_t zeros) {
+    for (std::uint64_t i = 0; i < zeros; ++i) {
+      bit(false);
+    }
+    bit(true);
+  }
+  void putRice(std::int64_t value, unsigned parameter) {
+    const auto folded = static_cast<std::uint64_t>(value < 0 ? -2 * value - 1 : 2 * value);
+    putUnary(folded >> parameter);
+    put(folded, parameter);
+  }
+  void align() {
+    while (used_ != 0U) {
+      bit(false);
+    }
+  }
+  std::string& bytes() { return bytes_; }
+
+ private:
+  void bit(bool b) {
+    if (used_ == 0U) {
+      bytes_.push_back('\0');
+    }
+    if (b) {
+      bytes_.back() = static_cast<char>(static_cast<unsigned char>(bytes_.back()) | (0x80U >> used_));
+    }
+    used_ = (used_ + 1U) % 8U;
+  }
+
+  std::string bytes_;
+  unsigned used_{0};
+};
+
+std::uint8_t crc8(const std::string& b) {
+  unsigned crc = 0;
+  for (const char c : b) {
+    crc ^= static_cast<unsigned char>(c);
+    for (int i = 0; i < 8; ++i) {
+      crc = (crc & 0x80U) != 0U ? ((crc << 1U) ^ 0x07U) & 0xFFU : (crc << 1U) & 0xFFU;
+    }
+  }
+  return static_cast<std::uint8_t>(crc);
+}
+
+std::uint16_t crc16(const std::string& b) {
+  unsigned crc = 0;
+  for (const char c : b) {
+    crc ^= static_cast<unsigned>(static_cast<unsigned char>(c)) << 8U;
+    for (int i = 0; i < 8; ++i) {
+      crc = (crc & 0x8000U) != 0U ? ((crc << 1U) ^ 0x8005U) & 0xFFFFU : (crc << 1U) & 0xFFFFU;
+    }
+  }
+  return static_cast<std::uint16_t>(crc);
+}
+
+void put_coded_number(BitWriter& w, std::uint64_t v) {
+  if (v < 0x80U) {
+    w.put(v, 8);
+    return;
+  }
+  unsigned extra = 1;
+  while (v >> (6U * extra + 6U - extra) != 0U) {
+    ++extra;
+  }
+  w.put((1U << (extra + 1U)) - 1U, extra + 1U);
+  w.put(0, 1);
+  w.put(v >> (6U * extra), 6U - extra);
+  for (unsigned i = extra; i > 0; --i) {
+    w.put(0x80U | ((v >> (6U * (i - 1U))) & 0x3FU), 8);
+  }
+}
+
+struct Stream {
+  unsigned bits{16};
+  std::uint32_t sample_rate{44100};
+  bool variable_block_size{false};
+  std::vector<std::uint32_t> block_sizes;
+  std::vector<std::vector<std::int32_t>> channels;
+};
+
+std::int64_t fixed_prediction(const std::int32_t* s, std::size_t i, unsigned order) {
+  const std::int64_t a = order > 0U ? s[i - 1] : 0;
+  const std::int64_t b = order > 1U ? s[i - 2] : 0;
+  const std::int64_t c = order > 2U ? s[i - 3] : 0;
+  const std::int64_t d = order > 3U ? s[i - 4] : 0;
+  switch (order) {
+    case 1:
+      return a;
+    case 2:
+      return 2 * a - b;
+    case 3:
+      return 3 * a - 3 * b + c;
+    case 4:
+      return 4 * a - 6 * b + 4 * c - d;
+    default:
+      return 0;
+  }
+}
+
+// Rice-codes `residual` (which starts after `order` warm-up samples) with the
+// given partition order, escaping the first partition when asked.
+void put_residual(BitWriter& w, const std::vector<std::int64_t>& residual, std::size_t block_size, unsigned order,
+                  unsigned partition_order, bool escape_first) {
+  std::vector<std::uint64_t> folded;
+  for (const std::int64_t r : residual) {
+    folded.push_back(static_cast<std::uint64_t>(r < 0 ? -2 * r - 1 : 2 * r));
+  }
+  const auto max_folded = folded.empty() ? 0U : *std::max_element(folded.begin(), folded.end());
+  const bool wide = std::bit_width(max_folded) > 14;
+  w.put(wide ? 1U : 0U, 2);
+  w.put(partition_order, 4);
+  const std::size_t partition_size = block_size >> partition_order;
+  std::size_t i = 0;
+  for (std::size_t p = 0; p < (std::size_t{1} << partition_order); ++p) {
+    const std::size_t n = p == 0 ? partition_size - order : partition_size;
+    if (p == 0 && escape_first) {
+      unsigned raw_bits = 0;
+      for (std::size_t j = i; j < i + n; ++j) {
+        const std::int64_t r = residual[j];
+        raw_bits = std::max(raw_bits, static_cast<unsigned>(std::bit_width(static_cast<std::uint64_t>(r < 0 ? ~r : r))) + 1U);
+      }
+      w.put(wide ? 31U : 15U, wide ? 5U : 4U);
+      w.put(raw_bits, 5);
+      for (std::size_t j = i; j < i + n; ++j) {
+        w.putSigned(residual[j], raw_bits);
+      }
+    } else {
+      std::uint64_t sum = 0;
+      for (std::size_t j = i; j < i + n; ++j) {
+        sum += folded[j];
+      }
+      const auto mean = n > 0 ? sum / n : 0U;
+      const unsigned parameter = std::min(static_cast<unsigned>(std::bit_width(mean)), wide ? 30U : 14U);
+      w.put(parameter, wide ? 5U : 4U);
+      for (std::size_t j = i; j < i + n; ++j) {
+        w.putRice(residual[j], parameter);
+      }
+    }
+    i += n;
+  }
+}
+
+// Codes one subframe, rotating through every subframe type by `variant`.
+void put_subframe(BitWriter& w, std::vector<std::int32_t> s, unsigned bits, unsigned variant) {
+  const std::size_t n = s.size();
+  unsigned wasted = 0;
+  std::uint32_t all = 0;
+  for (const std::int32_t v : s) {
+    all |= static_cast<std::uint32_t>(v);
+  }
+  if (all != 0U) {
+    wasted = static_cast<unsigned>(std::countr_zero(all));
+    for (std::int32_t& v : s) {
+      v >>= wasted;
+    }
+    bits -= wasted;
+  }
+  const bool constant = std::all_of(s.begin(), s.end(), [&](std::int32_t v) { return v == s[0]; });
+  const unsigned kind = constant ? 0U : 1U + variant % 5U;
+  const auto fixed_order = static_cast<unsigned>(std::min<std::size_t>(kind == 2U ? (variant / 5U) % 5U : 2U, n));
+  const auto lpc_order = static_cast<unsigned>(std::min<std::size_t>(kind == 4U ? 1U + variant % 32U : 8U, n));
+  const std::array<std::int32_t, 8> base_coefs{1946, -973, 40, -25, 12, -6, 3, -1};
+  const unsigned type = kind == 0U ? 0U : kind == 1U ? 1U : (kind == 2U || kind == 5U) ? 8U + fixed_order : 31U + lpc_order;
+
+  w.put(0, 1);
+  w.put(type, 6);
+  w.put(wasted > 0U ? 1U : 0U, 1);
+  if (wasted > 0U) {
+    w.putUnary(wasted - 1U);
+  }
+  if (type == 0U) {
+    w.putSigned(s[0], bits);
+    return;
+  }
+  if (type == 1U) {
+    for (const std::int32_t v : s) {
+      w.putSigned(v, bits);
+    }
+    return;
+  }
+  const unsigned order = type < 32U ? type - 8U : type - 31U;
+  for (std::size_t i = 0; i < order; ++i) {
+    w.putSigned(s[i], bits);
+  }
+  std::vector<std::int64_t> residual;
+  if (type < 32U) {
+    for (std::size_t i = order; i < n; ++i) {
+      residual.push_back(s[i] - fixed_prediction(s.data(), i, order));
+    }
+  } else {
+    constexpr unsigned kPrecision = 12;
+    constexpr unsigned kShift = 10;
+    std::vector<std::int32_t> coefs(order);
+    for (std::size_t j = 0; j < order; ++j) {
+      coefs[j] = j < base_coefs.size() ? base_coefs[j] : static_cast<std::int32_t>(j % 3U) - 1;
+    }
+    w.put(kPrecision - 1U, 4);
+    w.put(kShift, 5);
+    for (const std::int32_t c : coefs) {
+      w.putSigned(c, kPrecision);
+    }
+    for (std::size_t i = order; i < n; ++i) {
+      std::int64_t sum = 0;
+      for (std::size_t j = 0; j < order; ++j) {
+        sum += std::int64_t{coefs[j]} * s[i - 1 - j];
+      }
+      residual.push_back(s[i] - (sum >> kShift));
+    }
+  }
+  unsigned partition_order = 0;
+  while (partition_order < variant % 4U && n % (std::size_t{2} << partition_order) == 0 &&
+         (n >> (partition_order + 1U)) >= order) {
+    ++partition_order;
+  }
+  put_residual(w, residual, n, order, partition_order, kind == 5U);
+}
+
+// Minimal FLAC encoder covering the coding paths the reader must handle.
+std::string encode_flac(const Stream& stream, const std::string& prefix = "") {
+  const auto channels = static_cast<unsigned>(stream.channels.size());
+  std::size_t total = 0;
+  for (const std::uint32_t b : stream.block_sizes) {
+    total += b;
+  }
+  std::string out = prefix + "fLaC";
+  BitWriter info;
+  info.put(0, 1);
+  info.put(0, 7);
+  info.put(34, 24);
+  info.put(*std::min_element(stream.block_sizes.begin(), stream.block_sizes.end()), 16);
+  info.put(*std::max_element(stream.block_sizes.begin(), stream.block_sizes.end()), 16);
+  info.put(0, 24);
+  info.put(0, 24);
+  info.put(stream.sample_rate, 20);
+  info.put(channels - 1U, 3);
+  info.put(stream.bits - 1U, 5);
+  info.put(total, 36);
+  info.put(0, 64);
+  info.put(0, 64);
+  // Padding holding a fake sync code, which the frame scan must not see.
+  info.put(1, 1);
+  info.put(1, 7);
+  info.put(8, 24);
+  info.put(0xFFF8000000000000ULL, 64);
+  out += info.bytes();
+
+  std::size_t start = 0;
+  for (std::size_t f = 0; f < stream.block_sizes.size(); ++f) {
+    const std::uint32_t n = stream.block_sizes[f];
+    const auto variant = static_cast<unsigned>(f);
+    unsigned assignment = channels - 1U;
+    if (channels == 2U) {
+      assignment = f % 4U == 0U ? 1U : 7U + f % 4U;
+    }
+    BitWriter w;
+    w.put(0x3FFEU, 14);
+    w.put(0, 1);
+    w.put(stream.variable_block_size ? 1U : 0U, 1);
+    const unsigned block_code = n == 4096U ? 12U : n == 192U ? 1U : n == 1152U ? 3U : n <= 256U ? 6U : 7U;
+    const unsigned rate_code = stream.sample_rate == 44100U ? 9U : stream.sample_rate == 48000U ? 10U : 13U;
+    const unsigned size_code = stream.bits == 16U ? 4U : stream.bits == 24U ? 6U : stream.bits == 12U ? 2U : 0U;
+    w.put(block_code, 4);
+    w.put(rate_code, 4);
+    w.put(assignment, 4);
+    w.put(size_code, 3);
+    w.put(0, 1);
+    put_coded_number(w, stream.variable_block_size ? start : f);
+    if (block_code == 6U) {
+      w.put(n - 1U, 8);
+    } else if (block_code == 7U) {
+      w.put(n - 1U, 16);
+    }
+    if (rate_code == 13U) {
+      w.put(stream.sample_rate, 16);
+    }
+    w.put(crc8(w.bytes()), 8);
+
+    std::vector<std::vector<std::int32_t>> blocks;
+    for (const auto& channel : stream.channels) {
+      blocks.emplace_back(channel.begin() + static_cast<std::ptrdiff_t>(start),
+                          channel.begin() + static_cast<std::ptrdiff_t>(start + n));
+    }
+    std::vector<std::int32_t> side(n);
+    std::vector<std::int32_t> mid(n);
+    for (std::size_t i = 0; i < n && channels == 2U; ++i) {
+      side[i] = blocks[0][i] - blocks[1][i];
+      mid[i] = (blocks[0][i] + blocks[1][i]) >> 1;
+    }
+    if (assignment == 8U) {
+      put_subframe(w, blocks[0], stream.bits, variant);
+      put_subframe(w, side, stream.bits + 1U, variant + 1U);
+    } else if (assignment == 9U) {
+      put_subframe(w, side, stream.bits + 1U, variant);
+      put_subframe(w, blocks[1], stream.bits, variant + 1U);
+    } else if (assignment == 10U) {
+      put_subframe(w, mid, stream.bits, variant);
+      put_subframe(w, side, stream.bits + 1U, variant + 1U);
+    } else {
+      for (unsigned c = 0; c < channels; ++c) {
+        put_subframe(w, blocks[c], stream.bits, variant + c);
+      }
+    }
+    w.align();
+    w.put(crc16(w.bytes()), 16);
+    out += w.bytes();
+    start += n;
+  }
+  return out;
+}
+
+std::vector<std::int32_t> test_channel(std::size_t frames, unsigned bits, double freq, unsigned seed) {
+  std::vector<std::int32_t> s(frames);
+  const double peak = std::ldexp(0.45, static_cast<int>(bits) - 1);
+  std::uint32_t noise = seed;
+  for (std::size_t i = 0; i < frames; ++i) {
+    noise = noise * 1664525U + 1013904223U;
+    const double x = std::sin(freq * static_cast<double>(i)) + 0.05 * (static_cast<double>(noise >> 8U) / 16777216.0);
+    s[i] = static_cast<std::int32_t>(std::lround(peak * x));
+  }
+  // A silent stretch (CONSTANT subframes) and a quiet one with wasted bits.
+  std::fill(s.begin() + static_cast<std::ptrdiff_t>(frames / 5), s.begin() + static_cast<std::ptrdiff_t>(frames / 4), 0);
+  for (std::size_t i = frames / 3; i < frames / 2; ++i) {
+    s[i] &= ~std::int32_t{7};
+  }
+  return s;
+}
+
+std::filesystem::path write_file(const std::string& name, const std::string& bytes) {
+  const auto path = std::filesystem::temp_directory_path() / ("aifr3d_io_" + name + ".flac");
+  std::ofstream out(path, std::ios::binary);
+  out << bytes;
+  return path;
+}
+
+void check_decode(const Stream& stream, const std::string& name, const std::string& prefix = "") {
+  const auto path = write_file(name, encode_flac(stream, prefix));
+  require(aifr3d::io::is_flac_file(path.string()), name + ": magic");
+  const aifr3d::io::FlacReader reader(path.string());
+  const std::size_t frames = stream.channels[0].size();
+  require(reader.frameCount() == frames, name + ": frame count");
+  require(reader.blockCount() == stream.block_sizes.size(), name + ": every block indexed");
+  require(reader.sampleRateHz() == static_cast<double>(stream.sample_rate), name + ": rate");
+  require(reader.channels() == stream.channels.size() && reader.bitsPerSample() == stream.bits, name + ": format");
+
+  const float scale = 1.0F / static_cast<float>(1U << (stream.bits - 1U));
+  const auto& second = stream.channels.size() > 1U ? stream.channels[1] : stream.channels[0];
+  std::vector<float> left(frames);
+  std::vector<float> right(frames);
+  // Odd-sized reads straddle block boundaries and reuse the cached block.
+  for (std::size_t first = 0; first < frames; first += 777) {
+    const std::size_t n = std::min<std::size_t>(777, frames - first);
+    reader.readStereo(first, n, left.data() + first, right.data() + first);
+  }
+  for (std::size_t i = 0; i < frames; ++i) {
+    require(left[i] == static_cast<float>(stream.channels[0][i]) * scale, name + ": left sample");
+    require(right[i] == static_cast<float>(second[i]) * scale, name + ": right sample");
+  }
+  float l = 0.0F;
+  float r = 0.0F;
+  reader.readStereo(frames - 1U, 1, &l, &r);
+  require(l == left.back() && r == right.back(), name + ": random access to the last frame");
+  bool out_of_range = false;
+  try {
+    reader.readStereo(frames, 1, &l, &r);
+  } catch (const std::out_of_range&) {
+    out_of_range = true;
+  }
+  require(out_of_range, name + ": reads past the end must throw std::out_of_range");
+  std::filesystem::remove(path);
+}
+
+void testDecodesEveryCodingPath() {
+  {
+    Stream stream;
+    const std::size_t frames = 4096 * 11 + 1234;
+    stream.block_sizes.assign(11, 4096);
+    stream.block_sizes.push_back(1234);
+    stream.channels = {test_channel(frames, 16, 0.031, 1), test_channel(frames, 16, 0.0071, 2)};
+    check_decode(stream, "stereo16");
+  }
+  {
+    Stream stream;
+    stream.bits = 24;
+    stream.sample_rate = 12345;
+    stream.variable_block_size = true;
+    stream.block_sizes = {192, 1152, 17, 4096, 256, 3000, 4096, 4096, 1, 2048, 4096, 500};
+    std::size_t frames = 0;
+    for (const std::uint32_t b : stream.block_sizes) {
+      frames += b;
+    }
+    stream.channels = {test_channel(frames, 24, 0.05, 3), test_channel(frames, 24, 0.3, 4)};
+    // An ID3v2 tag before the stream marker is skipped.
+    check_decode(stream, "variable24", std::string("ID3\x03\x00\x00\x00\x00\x00\x04xxxx", 14));
+  }
+  {
+    Stream stream;
+    stream.bits = 12;
+    stream.sample_rate = 48000;
+    stream.block_sizes.assign(40, 1152);
+    stream.channels = {test_channel(1152 * 40, 12, 0.01, 5)};
+    check_decode(stream, "mono12");
+  }
+  {
+    Stream stream;
+    stream.block_sizes.assign(6, 4096);
+    stream.channels = {test_channel(4096 * 6, 16, 0.02, 6), test_channel(4096 * 6, 16, 0.04, 7),
+                       test_channel(4096 * 6, 16, 0.08, 8)};
+    check_decode(stream, "three_channels");
+  }
+}
+
+// Block 0 stores its left channel verbatim, so samples can spell out a valid
+// header for frame 1 inside it. Only the CRC-16 of block 0 tells that sync
+// from the real one.
+void testSkipsFalseSyncInsideBlock() {
+  Stream stream;
+  stream.block_sizes.assign(8, 4096);
+  stream.channels = {test_channel(4096 * 8, 16, 0.031, 13), test_channel(4096 * 8, 16, 0.0071, 14)};
+  // Sync, 4096-sample blocks at 44.1 kHz, left/side at 16 bits, frame 1.
+  std::string header("\xFF\xF8\xC9\x88\x01", 5);
+  header.push_back(static_cast<char>(crc8(header)));
+  for (std::size_t i = 0; i < 3U; ++i) {
+    const auto hi = static_cast<unsigned char>(header[2U * i]);
+    const auto lo = static_cast<unsigned char>(header[2U * i + 1U]);
+    stream.channels[0][100U + i] = static_cast<std::int16_t>((hi << 8U) | lo);
+  }
+  stream.channels[0][103] |= 1;  // no wasted bits, so the samples stay byte-aligned
+  const std::string bytes = encode_flac(stream);
+  const std::size_t false_sync = bytes.find(header);
+  require(false_sync != std::string::npos && bytes.find(header, false_sync + 1U) != std::string::npos,
+          "the false sync must sit in block 0, before frame 1");
+  check_decode(stream, "false_sync");
+}
+
+void testRejectsCorruptAndUnsupportedStreams() {
+  Stream stream;
+  stream.block_sizes.assign(8, 4096);
+  stream.channels = {test_channel(4096 * 8, 16, 0.031, 9), test_channel(4096 * 8, 16, 0.0071, 10)};
+  std::string bytes = encode_flac(stream);
+  // Flip a bit in the middle of the stream; its block fails the CRC-16 while
+  // the others still decode.
+  const std::size_t hit = bytes.size() / 2U;
+  bytes[hit] = static_cast<char>(bytes[hit] ^ 0x10);
+  const auto path = write_file("corrupt", bytes);
+  const aifr3d::io::FlacReader reader(path.string());
+  std::vector<float> left(4096 * 8);
+  std::vector<float> right(4096 * 8);
+  require(throws([&] { reader.readStereo(0, 4096 * 8, left.data(), right.data()); }), "corrupt block must throw");
+  reader.readStereo(0, 4096, left.data(), right.data());
+  require(left[100] == static_cast<float>(stream.channels[0][100]) / 32768.0F, "blocks before the damage decode");
+  std::filesystem::remove(path);
+
+  std::string wide = encode_flac(stream);
+  wide[4 + 4 + 12] = static_cast<char>((wide[4 + 4 + 12] & 0xF0) | 0x03);  // channels-1 / bits-1: 32-bit
+  wide[4 + 4 + 13] = static_cast<char>(wide[4 + 4 + 13] | 0xF0);
+  const auto wide_path = write_file("wide", wide);
+  require(throws([&] { aifr3d::io::FlacReader r(wide_path.string()); }), "32-bit FLAC is unsupported");
+  std::filesystem::remove(wide_path);
+
+  const auto truncated = write_file("truncated", encode_flac(stream).substr(0, 20));
+  require(throws([&] { aifr3d::io::FlacReader r(truncated.string()); }), "truncated metadata must throw");
+  std::filesystem::remove(truncated);
+
+  const std::string whole = encode_flac(stream);
+  const auto cut = write_file("cut", whole.substr(0, whole.size() * 3U / 5U));
+  require(throws([&] { aifr3d::io::FlacReader r(cut.string()); }), "audio short of STREAMINFO must throw");
+  std::filesystem::remove(cut);
+
+  const auto riff = write_file("riff", "RIFF....WAVEfmt ");
+  require(!aifr3d::io::is_flac_file(riff.string()), "RIFF is not FLAC");
+  require(throws([&] { aifr3d::io::FlacReader r(riff.string()); }), "non-FLAC must throw");
+  std::filesystem::remove(riff);
+  require(throws([] { aifr3d::io::FlacReader r("/nonexistent/aifr3d.flac"); }), "missing file must throw");
+}
+
+void testAnalysesInParallelLikeMemory() {
+  Stream stream;
+  const std::size_t frames = 4096 * 70;
+  stream.block_sizes.assign(70, 4096);
+  stream.channels = {test_channel(frames, 16, 0.031, 11), test_channel(frames, 16, 0.0071, 12)};
+  const auto path = write_file("analysis", encode_flac(stream));
+  const aifr3d::io::FlacReader reader(path.string());
+
+  std::vector<float> interleaved;
+  for (std::size_t i = 0; i < frames; ++i) {
+    interleaved.push_back(static_cast<float>(stream.channels[0][i]) / 32768.0F);
+    interleaved.push_back(static_cast<float>(stream.channels[1][i]) / 32768.0F);
+  }
+  const aifr3d::Analyzer analyzer(3);
+  const auto from_file = analyzer.analyzeBlocks(
+      [&](std::size_t first, std::size_t n, float* l, float* r) { reader.readStereo(first, n, l, r); },
+      reader.frameCount(), reader.sampleRateHz());
+  const auto from_memory = analyzer.analyzeInterleavedStereo(interleaved.data(), frames, 44100.0);
+  require(*from_file.loudness.integrated_lufs == *from_memory.loudness.integrated_lufs, "flac loudness");
+  require(*from_file.spectral.low == *from_memory.spectral.low, "flac spectral");
+  require(*from_file.true_peak.true_peak_dbfs == *from_memory.true_peak.true_peak_dbfs, "flac true peak");
+  require(*from_file.stereo.correlation == *from_memory.stereo.correlation, "flac stereo");
+  std::filesystem::remove(path);
+}
+
+}  // namespace
+
+int main() {
+  try {
+    testDecodesEveryCodingPath();
+    testSkipsFalseSyncInsideBlock();
+    testRejectsCorruptAndUnsupportedStreams();
+    testAnalysesInParallelLikeMemory();
+  } catch (const std::exception& ex) {
+    std::cerr << "[FAIL] " << ex.what() << '\n';
+    return 1;
+  }
+
+  std::cout << "[PASS] test_flac_reader\n";
+  return 0;
+}
@@ -0,0 +1,138 @@
+#include "aifr3d/io/pcm_decode.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using aifr3d::io::SampleFormat;
+
+void require(bool cond, const std::string& msg) {
+  if (!cond) {
+    throw std::runtime_error(msg);
+  }
+}
+
+// Straightforward per-sample reference, independent of the library code.
+float reference_sample(SampleFormat format, const unsigned char* p) {
+  switch (format) {
+    case SampleFormat::kPcm16: {
+      const auto v = static_cast<std::int16_t>(static_cast<std::uint16_t>(p[0] | (p[1] << 8U)));
+      return static_cast<float>(static_cast<double>(v) / 32768.0);
+    }
+    case SampleFormat::kPcm24: {
+      std::int32_t v = p[0] | (p[1] << 8) | (p[2] << 16);
+      if ((v & 0x800000) != 0) {
+        v -= 0x1000000;
+      }
+      return static_cast<float>(static_cast<double>(v) / 8388608.0);
+    }
+    case SampleFormat::kPcm32: {
+      std::int32_t v = 0;
+      std::memcpy(&v, p, sizeof(v));
+      // Round once, as a float conversion of the integer does.
+      return static_cast<float>(v) / 2147483648.0F;
+    }
+    case SampleFormat::kFloat32: {
+      float v = 0.0F;
+      std::memcpy(&v, p, sizeof(v));
+      return v;
+    }
+    case SampleFormat::kFloat64:
+      break;
+  }
+  double v = 0.0;
+  std::memcpy(&v, p, sizeof(v));
+  return static_cast<float>(v);
+}
+
+// Random frames; float formats get finite values spanning the full range.
+std::vector<unsigned char> random_frames(SampleFormat format, std::size_t samples, std::mt19937& rng) {
+  const std::size_t bytes = aifr3d::io::bytes_per_sample(format);
+  std::vector<unsigned char> data(samples * bytes);
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::uniform_real_distribution<double> value(-1.5, 1.5);
+  for (std::size_t s = 0; s < samples; ++s) {
+    unsigned char* p = data.data() + s * bytes;
+    if (format == SampleFormat::kFloat32) {
+      const float v = static_cast<float>(value(rng));
+      std::memcpy(p, &v, sizeof(v));
+    } else if (format == SampleFormat::kFloat64) {
+      const double v = value(rng);
+      std::memcpy(p, &v, sizeof(v));
+    } else {
+      for (std::size_t b = 0; b < bytes; ++b) {
+        p[b] = static_cast<unsigned char>(byte(rng));
+      }
+    }
+  }
+  // Pin the integer extremes into the first two frames.
+  if (format != SampleFormat::kFloat32 && format != SampleFormat::kFloat64 && samples >= 2U) {
+    std::memset(data.data(), 0, bytes);
+    data[bytes - 1U] = 0x80;
+    std::memset(data.data() + bytes, 0xFF, bytes);
+    data[2U * bytes - 1U] = 0x7F;
+  }
+  return data;
+}
+
+void testPairsMatchReference() {
+  const SampleFormat formats[] = {SampleFormat::kPcm16, SampleFormat::kPcm24, SampleFormat::kPcm32,
+                                  SampleFormat::kFloat32, SampleFormat::kFloat64};
+  std::mt19937 rng(7);
+  for (const SampleFormat format : formats) {
+    const std::size_t bytes = aifr3d::io::bytes_per_sample(format);
+    for (std::size_t channels = 2; channels <= 6U; ++channels) {
+      for (const std::size_t frames : {0U, 1U, 3U, 4U, 5U, 8U, 67U, 1000U}) {
+        const auto data = random_frames(format, channels * frames, rng);
+        for (std::size_t first = 0; first + 1U < channels; ++first) {
+          std::vector<float> a(frames + 1U, -7.0F);
+          std::vector<float> b(frames + 1U, -7.0F);
+          aifr3d::io::decode_channel_pair(format, data.data(), channels, first, frames, a.data(), b.data());
+          for (std::size_t i = 0; i < frames; ++i) {
+            const unsigned char* frame = data.data() + i * channels * bytes;
+            require(a[i] == reference_sample(format, frame + first * bytes), "first channel of the pair");
+            require(b[i] == reference_sample(format, frame + (first + 1U) * bytes), "second channel of the pair");
+          }
+          require(a[frames] == -7.0F && b[frames] == -7.0F, "decode must not write past `frames`");
+        }
+        std::vector<float> mono(frames);
+        aifr3d::io::decode_channel(format, data.data(), channels, channels - 1U, frames, mono.data());
+        for (std::size_t i = 0; i < frames; ++i) {
+          const unsigned char* frame = data.data() + i * channels * bytes;
+          require(mono[i] == reference_sample(format, frame + (channels - 1U) * bytes), "single channel");
+        }
+      }
+    }
+  }
+}
+
+void testIntegerExtremes() {
+  std::mt19937 rng(1);
+  const auto data = random_frames(SampleFormat::kPcm24, 8, rng);
+  std::vector<float> a(4);
+  std::vector<float> b(4);
+  aifr3d::io::decode_channel_pair(SampleFormat::kPcm24, data.data(), 2, 0, 4, a.data(), b.data());
+  require(a[0] == -1.0F, "24-bit minimum decodes to -1");
+  require(b[0] == 8388607.0F / 8388608.0F, "24-bit maximum decodes below 1");
+}
+
+}  // namespace
+
+int main() {
+  try {
+    testPairsMatchReference();
+    testIntegerExtremes();
+  } catch (const std::exception& ex) {
+    std::cerr << "[FAIL] " << ex.what() << '\n';
+    return 1;
+  }
+
+  std::cout << "[PASS] test_pcm_decode\n";
+  return 0;
+}
@@ -0,0 +1,137 @@
+#include "aifr3d/io/read_ahead.hpp"
+#include "aifr3d/io/wav_reader.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+void require(bool cond, const std::string& msg) {
+  if (!cond) {
+    throw std::runtime_error(msg);
+  }
+}
+
+template <typename Fn>
+bool throws(Fn&& fn) {
+  try {
+    fn();
+  } catch (const std::invalid_argument&) {
+    return true;
+  }
+  return false;
+}
+
+void put_u16(std::string& b, std::uint32_t v) {
+  b.push_back(static_cast<char>(v & 0xFFU));
+  b.push_back(static_cast<char>((v >> 8U) & 0xFFU));
+}
+
+void put_u32(std::string& b, std::uint32_t v) {
+  put_u16(b, v & 0xFFFFU);
+  put_u16(b, v >> 16U);
+}
+
+// 24-bit PCM WAV of `frames` frames with a counting pattern in every channel.
+std::filesystem::path write_wav(const std::string& name, std::uint16_t channels, std::size_t frames) {
+  const std::uint32_t block_align = channels * 3U;
+  const auto data_bytes = static_cast<std::uint32_t>(frames * block_align);
+  std::string b = "RIFF";
+  put_u32(b, 36U + data_bytes);
+  b += "WAVEfmt ";
+  put_u32(b, 16);
+  put_u16(b, 1);
+  put_u16(b, channels);
+  put_u32(b, 44100);
+  put_u32(b, 44100U * block_align);
+  put_u16(b, block_align);
+  put_u16(b, 24);
+  b += "data";
+  put_u32(b, data_bytes);
+  for (std::size_t i = 0; i < frames; ++i) {
+    for (std::uint16_t c = 0; c < channels; ++c) {
+      const auto v = static_cast<std::uint32_t>((i * 7919U + c * 104729U) & 0xFFFFFFU);
+      b.push_back(static_cast<char>(v & 0xFFU));
+      b.push_back(static_cast<char>((v >> 8U) & 0xFFU));
+      b.push_back(static_cast<char>((v >> 16U) & 0xFFU));
+    }
+  }
+  const auto path = std::filesystem::temp_directory_path() / ("aifr3d_io_readahead_" + name + ".wav");
+  std::ofstream out(path, std::ios::binary);
+  out << b;
+  return path;
+}
+
+void testBlocksMatchTheMappedReader() {
+  for (const std::uint16_t channels : {std::uint16_t{1}, std::uint16_t{2}, std::uint16_t{5}}) {
+    const std::size_t frames = 10007;
+    const auto path = write_wav("match", channels, frames);
+    const aifr3d::io::WavReader mapped(path.string());
+    std::vector<float> left(frames);
+    std::vector<float> right(frames);
+    mapped.readStereo(0, frames, left.data(), right.data());
+
+    for (const std::size_t depth : {1U, 2U, 5U}) {
+      for (const std::size_t io_threads : {1U, 3U}) {
+        aifr3d::io::ReadAheadOptions options;
+        options.block_frames = 1000;
+        options.queue_depth = depth;
+        options.io_threads = io_threads;
+        aifr3d::io::ReadAheadWavReader reader(path.string(), options);
+        require(reader.frameCount() == frames, "read-ahead frame count");
+        require(reader.sampleRateHz() == 44100.0, "read-ahead rate");
+        std::size_t total = 0;
+        for (auto block = reader.next(); block.frames > 0; block = reader.next()) {
+          require(block.frames == 1000U || total + block.frames == frames, "blocks are full until the last");
+          require(std::memcmp(block.left, left.data() + total, block.frames * sizeof(float)) == 0,
+                  "read-ahead left block");
+          require(std::memcmp(block.right, right.data() + total, block.frames * sizeof(float)) == 0,
+                  "read-ahead right block");
+          total += block.frames;
+        }
+        require(total == frames, "read-ahead frame total");
+        require(reader.next().frames == 0U, "exhausted reader stays exhausted");
+      }
+    }
+    std::filesystem::remove(path);
+  }
+}
+
+void testStopsEarlyAndRejectsBadInput() {
+  const auto path = write_wav("early", 2, 50000);
+  {
+    aifr3d::io::ReadAheadOptions options;
+    options.block_frames = 512;
+    options.queue_depth = 3;
+    aifr3d::io::ReadAheadWavReader reader(path.string(), options);
+    require(reader.next().frames == 512U, "first block");
+    // Destroying with the ring full must not hang.
+  }
+  aifr3d::io::ReadAheadOptions zero;
+  zero.queue_depth = 0;
+  require(throws([&] { aifr3d::io::ReadAheadWavReader reader(path.string(), zero); }), "zero depth must throw");
+  std::filesystem::remove(path);
+  require(throws([] { aifr3d::io::ReadAheadWavReader reader("/nonexistent/aifr3d.wav"); }),
+          "missing file must throw");
+}
+
+}  // namespace
+
+int main() {
+  try {
+    testBlocksMatchTheMappedReader();
+    testStopsEarlyAndRejectsBadInput();
+  } catch (const std::exception& ex) {
+    std::cerr << "[FAIL] " << ex.what() << '\n';
+    return 1;
+  }
+
+  std::cout << "[PASS] test_read_ahead\n";
+  return 0;
+}
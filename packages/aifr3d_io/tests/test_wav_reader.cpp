@@ -0,0 +1,266 @@
+#include "aifr3d/io/wav_reader.hpp"
+
+#include "aifr3d/analyzer.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+void require(bool cond, const std::string& msg) {
+  if (!cond) {
+    throw std::runtime_error(msg);
+  }
+}
+
+template <typename Fn>
+bool throws(Fn&& fn) {
+  try {
+    fn();
+  } catch (const std::invalid_argument&) {
+    return true;
+  } catch (const std::out_of_range&) {
+    return true;
+  }
+  return false;
+}
+
+void put_u16(std::vector<unsigned char>& b, std::uint32_t v) {
+  b.push_back(static_cast<unsigned char>(v & 0xFFU));
+  b.push_back(static_cast<unsigned char>((v >> 8U) & 0xFFU));
+}
+
+void put_u32(std::vector<unsigned char>& b, std::uint32_t v) {
+  put_u16(b, v & 0xFFFFU);
+  put_u16(b, v >> 16U);
+}
+
+void put_id(std::vector<unsigned char>& b, const char* id) { b.insert(b.end(), id, id + 4); }
+
+struct WavSpec {
+  std::uint16_t format_tag{1};
+  std::uint16_t channels{2};
+  std::uint32_t sample_rate{48000};
+  std::uint16_t bits{16};
+  bool extensible{false};
+  // Odd-sized chunk before the data, to exercise padding.
+  bool list_chunk{false};
+};
+
+// Writes a WAV whose data chunk holds `data` verbatim.
+std::filesystem::path write_wav(const std::string& name, const WavSpec& spec, const std::vector<unsigned char>& data) {
+  std::vector<unsigned char> b;
+  put_id(b, "RIFF");
+  put_u32(b, 0);
+  put_id(b, "WAVE");
+  put_id(b, "fmt ");
+  put_u32(b, spec.extensible ? 40U : 16U);
+  put_u16(b, spec.extensible ? 0xFFFEU : spec.format_tag);
+  put_u16(b, spec.channels);
+  put_u32(b, spec.sample_rate);
+  const std::uint32_t block_align = spec.channels * (spec.bits / 8U);
+  put_u32(b, spec.sample_rate * block_align);
+  put_u16(b, block_align);
+  put_u16(b, spec.bits);
+  if (spec.extensible) {
+    put_u16(b, 22);
+    put_u16(b, spec.bits);
+    put_u32(b, 0);
+    // KSDATAFORMAT_SUBTYPE_* GUID: format tag, then a fixed tail.
+    put_u16(b, spec.format_tag);
+    const unsigned char tail[14] = {0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00,
+                                    0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71};
+    b.insert(b.end(), tail, tail + 14);
+  }
+  if (spec.list_chunk) {
+    put_id(b, "LIST");
+    put_u32(b, 3);
+    b.insert(b.end(), {'a', 'b', 'c', 0});
+  }
+  put_id(b, "data");
+  put_u32(b, static_cast<std::uint32_t>(data.size()));
+  b.insert(b.end(), data.begin(), data.end());
+  const auto riff_size = static_cast<std::uint32_t>(b.size() - 8U);
+  std::memcpy(b.data() + 4, &riff_size, 4);
+
+  const auto path = std::filesystem::temp_directory_path() / ("aifr3d_io_" + name + ".wav");
+  std::ofstream out(path, std::ios::binary);
+  out.write(reinterpret_cast<const char*>(b.data()), static_cast<std::streamsize>(b.size()));
+  return path;
+}
+
+void testPcm16Stereo() {
+  std::vector<unsigned char> data;
+  for (const int v : {0, -32768, 32767, 16384, -1, 100}) {
+    put_u16(data, static_cast<std::uint16_t>(v));
+  }
+  const auto path = write_wav("pcm16", WavSpec{}, data);
+  const aifr3d::io::WavReader reader(path.string());
+  require(reader.frameCount() == 3U, "pcm16 frame count");
+  require(reader.sampleRateHz() == 48000.0, "pcm16 rate");
+  require(reader.format().sample_format == aifr3d::io::SampleFormat::kPcm16, "pcm16 format");
+
+  float l[3];
+  float r[3];
+  reader.readStereo(0, 3, l, r);
+  require(l[0] == 0.0F && r[0] == -1.0F, "pcm16 frame 0");
+  require(l[1] == 32767.0F / 32768.0F && r[1] == 0.5F, "pcm16 frame 1");
+  require(l[2] == -1.0F / 32768.0F && r[2] == 100.0F / 32768.0F, "pcm16 frame 2");
+
+  reader.readStereo(2, 1, l, r);
+  require(l[0] == -1.0F / 32768.0F, "pcm16 offset read");
+  require(throws([&] { reader.readStereo(2, 2, l, r); }), "read past the end must throw");
+  std::filesystem::remove(path);
+}
+
+void testPcm24MonoExtensibleWithList() {
+  std::vector<unsigned char> data;
+  for (const std::int32_t v : {-8388608, 8388607, 1, -2}) {
+    const auto u = static_cast<std::uint32_t>(v);
+    data.push_back(static_cast<unsigned char>(u & 0xFFU));
+    data.push_back(static_cast<unsigned char>((u >> 8U) & 0xFFU));
+    data.push_back(static_cast<unsigned char>((u >> 16U) & 0xFFU));
+  }
+  WavSpec spec;
+  spec.channels = 1;
+  spec.bits = 24;
+  spec.extensible = true;
+  spec.list_chunk = true;
+  const auto path = write_wav("pcm24", spec, data);
+  const aifr3d::io::WavReader reader(path.string());
+  require(reader.frameCount() == 4U, "pcm24 frame count");
+  float l[4];
+  float r[4];
+  reader.readStereo(0, 4, l, r);
+  require(l[0] == -1.0F && l[1] == 8388607.0F / 8388608.0F, "pcm24 extremes");
+  require(l[2] == 1.0F / 8388608.0F && l[3] == -2.0F / 8388608.0F, "pcm24 small values");
+  require(std::memcmp(l, r, sizeof(l)) == 0, "mono must be copied to both channels");
+  std::filesystem::remove(path);
+}
+
+void testWideFormatsAndExtraChannels() {
+  // Three channels: the third must be ignored.
+  {
+    std::vector<unsigned char> data;
+    for (const std::int32_t v : {INT32_MIN, 1 << 30, 12345}) {
+      put_u32(data, static_cast<std::uint32_t>(v));
+    }
+    WavSpec spec;
+    spec.channels = 3;
+    spec.bits = 32;
+    const auto path = write_wav("pcm32", spec, data);
+    const aifr3d::io::WavReader reader(path.string());
+    float l = 0.0F;
+    float r = 0.0F;
+    reader.readStereo(0, 1, &l, &r);
+    require(l == -1.0F && r == 0.5F, "pcm32 values");
+    reader.readChannelPair(0, 1, 1, &l, &r);
+    require(l == 0.5F && r == 12345.0F / 2147483648.0F, "pcm32 second channel pair");
+    require(throws([&] { reader.readChannelPair(0, 1, 2, &l, &r); }), "pair past the last channel must throw");
+    std::filesystem::remove(path);
+  }
+  {
+    std::vector<unsigned char> data(8);
+    const float v[2] = {0.25F, -0.75F};
+    std::memcpy(data.data(), v, sizeof(v));
+    WavSpec spec;
+    spec.format_tag = 3;
+    spec.bits = 32;
+    const auto path = write_wav("f32", spec, data);
+    const aifr3d::io::WavReader reader(path.string());
+    float l = 0.0F;
+    float r = 0.0F;
+    reader.readStereo(0, 1, &l, &r);
+    require(l == 0.25F && r == -0.75F, "float32 values");
+    std::filesystem::remove(path);
+  }
+  {
+    std::vector<unsigned char> data(16);
+    const double v[2] = {0.1, -1.5};
+    std::memcpy(data.data(), v, sizeof(v));
+    WavSpec spec;
+    spec.format_tag = 3;
+    spec.bits = 64;
+    spec.extensible = true;
+    const auto path = write_wav("f64", spec, data);
+    const aifr3d::io::WavReader reader(path.string());
+    require(reader.format().sample_format == aifr3d::io::SampleFormat::kFloat64, "float64 format");
+    float l = 0.0F;
+    float r = 0.0F;
+    reader.readStereo(0, 1, &l, &r);
+    require(l == 0.1F && r == -1.5F, "float64 values");
+    std::filesystem::remove(path);
+  }
+}
+
+void testRejectsMalformedFiles() {
+  require(throws([] { aifr3d::io::WavReader("/nonexistent/aifr3d.wav"); }), "missing file must throw");
+
+  WavSpec spec;
+  spec.bits = 8;
+  const auto eight = write_wav("pcm8", spec, std::vector<unsigned char>(4, 0x80));
+  require(throws([&] { aifr3d::io::WavReader(eight.string()); }), "8-bit PCM is unsupported");
+  std::filesystem::remove(eight);
+
+  const auto garbage = std::filesystem::temp_directory_path() / "aifr3d_io_garbage.wav";
+  {
+    std::ofstream out(garbage, std::ios::binary);
+    out << "not a wave file at all";
+  }
+  require(throws([&] { aifr3d::io::WavReader(garbage.string()); }), "non-RIFF must throw");
+  std::filesystem::remove(garbage);
+}
+
+void testAnalyzesStraightFromTheMapping() {
+  constexpr std::size_t frames = 300000;
+  std::vector<unsigned char> data;
+  std::vector<float> interleaved;
+  for (std::size_t i = 0; i < frames; ++i) {
+    const double t = static_cast<double>(i) / 44100.0;
+    for (const double x : {0.5 * std::sin(2.0 * 3.14159265358979 * 220.0 * t), 0.3 * std::sin(t * 9000.0)}) {
+      const auto v = static_cast<std::int16_t>(std::lround(x * 32767.0));
+      put_u16(data, static_cast<std::uint16_t>(v));
+      interleaved.push_back(static_cast<float>(v) / 32768.0F);
+    }
+  }
+  WavSpec spec;
+  spec.sample_rate = 44100;
+  const auto path = write_wav("analysis", spec, data);
+  const aifr3d::io::WavReader reader(path.string());
+
+  const aifr3d::Analyzer analyzer(3);
+  const auto from_file = analyzer.analyzeBlocks(
+      [&](std::size_t first, std::size_t n, float* l, float* r) { reader.readStereo(first, n, l, r); },
+      reader.frameCount(), reader.sampleRateHz());
+  const auto from_memory = analyzer.analyzeInterleavedStereo(interleaved.data(), frames, 44100.0);
+  require(*from_file.loudness.integrated_lufs == *from_memory.loudness.integrated_lufs, "file loudness");
+  require(*from_file.spectral.low == *from_memory.spectral.low, "file spectral");
+  require(*from_file.true_peak.true_peak_dbfs == *from_memory.true_peak.true_peak_dbfs, "file true peak");
+  require(*from_file.stereo.correlation == *from_memory.stereo.correlation, "file stereo");
+  std::filesystem::remove(path);
+}
+
+}  // namespace
+
+int main() {
+  try {
+    testPcm16Stereo();
+    testPcm24MonoExtensibleWithList();
+    testWideFormatsAndExtraChannels();
+    testRejectsMalformedFiles();
+    testAnalyzesStraightFromTheMapping();
+  } catch (const std::exception& ex) {
+    std::cerr << "[FAIL] " << ex.what() << '\n';
+    return 1;
+  }
+
+  std::cout << "[PASS] test_wav_reader\n";
+  return 0;
+}
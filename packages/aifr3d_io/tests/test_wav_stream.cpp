@@ -0,0 +1,206 @@
+#include "aifr3d/io/wav_reader.hpp"
+#include "aifr3d/io/wav_stream.hpp"
+
+#include "aifr3d/analyzer.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+void require(bool cond, const std::string& msg) {
+  if (!cond) {
+    throw std::runtime_error(msg);
+  }
+}
+
+template <typename Fn>
+bool throws(Fn&& fn) {
+  try {
+    fn();
+  } catch (const std::invalid_argument&) {
+    return true;
+  }
+  return false;
+}
+
+void put_u16(std::string& b, std::uint32_t v) {
+  b.push_back(static_cast<char>(v & 0xFFU));
+  b.push_back(static_cast<char>((v >> 8U) & 0xFFU));
+}
+
+void put_u32(std::string& b, std::uint32_t v) {
+  put_u16(b, v & 0xFFFFU);
+  put_u16(b, v >> 16U);
+}
+
+void put_u64(std::string& b, std::uint64_t v) {
+  put_u32(b, static_cast<std::uint32_t>(v));
+  put_u32(b, static_cast<std::uint32_t>(v >> 32U));
+}
+
+enum class Container { kRiff, kRiffUnknownSize, kRf64, kBw64 };
+
+// 16-bit stereo WAV holding `samples` (interleaved) in the given container.
+std::string make_wav(Container container, const std::vector<std::int16_t>& samples) {
+  const auto data_bytes = static_cast<std::uint32_t>(samples.size() * 2U);
+  const bool wide = container == Container::kRf64 || container == Container::kBw64;
+  std::string b;
+  b += container == Container::kRf64 ? "RF64" : container == Container::kBw64 ? "BW64" : "RIFF";
+  put_u32(b, container == Container::kRiff ? 36U + data_bytes : 0xFFFFFFFFU);
+  b += "WAVE";
+  if (wide) {
+    b += "ds64";
+    put_u32(b, 28);
+    put_u64(b, 36U + 36U + data_bytes);
+    put_u64(b, data_bytes);
+    put_u64(b, samples.size() / 2U);
+    put_u32(b, 0);
+  }
+  b += "fmt ";
+  put_u32(b, 16);
+  put_u16(b, 1);
+  put_u16(b, 2);
+  put_u32(b, 48000);
+  put_u32(b, 48000U * 4U);
+  put_u16(b, 4);
+  put_u16(b, 16);
+  b += "data";
+  put_u32(b, container == Container::kRiff ? data_bytes : 0xFFFFFFFFU);
+  for (const std::int16_t s : samples) {
+    put_u16(b, static_cast<std::uint16_t>(s));
+  }
+  return b;
+}
+
+std::vector<std::int16_t> test_signal(std::size_t frames) {
+  std::vector<std::int16_t> samples;
+  for (std::size_t i = 0; i < frames; ++i) {
+    const double t = static_cast<double>(i) / 48000.0;
+    samples.push_back(static_cast<std::int16_t>(std::lround(16000.0 * std::sin(2.0 * 3.14159265358979 * 440.0 * t))));
+    samples.push_back(static_cast<std::int16_t>(std::lround(9000.0 * std::sin(t * 7000.0))));
+  }
+  return samples;
+}
+
+void testContainersDecodeAlike() {
+  const auto samples = test_signal(1000);
+  for (const Container container : {Container::kRiff, Container::kRiffUnknownSize, Container::kRf64, Container::kBw64}) {
+    std::istringstream in(make_wav(container, samples));
+    aifr3d::io::WavStream wav(in, 256);
+    require(wav.sampleRateHz() == 48000.0, "stream rate");
+    require(wav.frameCount().has_value() == (container != Container::kRiffUnknownSize), "declared frame count");
+    std::vector<float> left(256);
+    std::vector<float> right(256);
+    std::size_t total = 0;
+    for (std::size_t n = wav.next(left.data(), right.data()); n > 0; n = wav.next(left.data(), right.data())) {
+      require(n == 256U || total + n == 1000U, "blocks are full-sized until the last");
+      for (std::size_t i = 0; i < n; ++i) {
+        require(left[i] == static_cast<float>(samples[2U * (total + i)]) / 32768.0F, "stream left sample");
+        require(right[i] == static_cast<float>(samples[2U * (total + i) + 1U]) / 32768.0F, "stream right sample");
+      }
+      total += n;
+    }
+    require(total == 1000U, "stream frame total");
+  }
+}
+
+void testMappedReaderTakesRf64Sizes() {
+  const auto samples = test_signal(777);
+  const auto path = std::filesystem::temp_directory_path() / "aifr3d_io_rf64.wav";
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << make_wav(Container::kRf64, samples) << "JUNK";
+  }
+  const aifr3d::io::WavReader reader(path.string());
+  require(reader.frameCount() == 777U, "ds64 data size must bound the data chunk");
+  float l = 0.0F;
+  float r = 0.0F;
+  reader.readStereo(776, 1, &l, &r);
+  require(r == static_cast<float>(samples.back()) / 32768.0F, "rf64 last frame");
+  std::filesystem::remove(path);
+}
+
+// Only the header of a 5 GiB BW64 file: the 64-bit ds64 data size must reach
+// frameCount() without being cut to 32 bits.
+void testStreamTakesDs64SizesPast4GiB() {
+  constexpr std::uint64_t data_bytes = (std::uint64_t{5} << 30U) + 8U;
+  std::string header = make_wav(Container::kBw64, {});
+  std::string ds64;
+  put_u64(ds64, 36U + 36U + data_bytes);
+  put_u64(ds64, data_bytes);
+  put_u64(ds64, data_bytes / 4U);
+  header.replace(20, ds64.size(), ds64);
+  std::istringstream in(header);
+  aifr3d::io::WavStream wav(in);
+  require(wav.frameCount().has_value() && *wav.frameCount() == data_bytes / 4U,
+          "ds64 data size past 4 GiB must give a 64-bit frame count");
+}
+
+void testRejectsBrokenHeaders() {
+  std::string no_ds64 = make_wav(Container::kRiffUnknownSize, test_signal(4));
+  no_ds64.replace(0, 4, "RF64");
+  require(throws([&] {
+            std::istringstream in(no_ds64);
+            aifr3d::io::WavStream wav(in);
+          }),
+          "RF64 without ds64 must throw");
+  require(throws([] {
+            std::istringstream in("RIFF....WAVEfmt ");
+            aifr3d::io::WavStream wav(in);
+          }),
+          "truncated header must throw");
+  require(throws([] { aifr3d::io::WavStream wav("/nonexistent/aifr3d.wav"); }), "missing file must throw");
+}
+
+void testStreamsIntoAnalysis() {
+  const auto samples = test_signal(200000);
+  std::istringstream in(make_wav(Container::kRiffUnknownSize, samples));
+  aifr3d::io::WavStream wav(in, 5000);
+  std::vector<float> left(wav.blockFrames());
+  std::vector<float> right(wav.blockFrames());
+  aifr3d::StreamingAnalyzer streamed;
+  streamed.reset(wav.sampleRateHz());
+  for (std::size_t n = wav.next(left.data(), right.data()); n > 0; n = wav.next(left.data(), right.data())) {
+    streamed.pushPlanar(left.data(), right.data(), n);
+  }
+  const auto from_stream = streamed.finalize();
+
+  std::vector<float> interleaved;
+  for (const std::int16_t s : samples) {
+    interleaved.push_back(static_cast<float>(s) / 32768.0F);
+  }
+  aifr3d::StreamingAnalyzer whole;
+  whole.reset(48000.0);
+  whole.push(interleaved.data(), interleaved.size() / 2U);
+  const auto from_memory = whole.finalize();
+  require(from_stream.frame_count == 200000U, "streamed frame count");
+  require(*from_stream.loudness.integrated_lufs == *from_memory.loudness.integrated_lufs, "streamed loudness");
+  require(*from_stream.spectral.mid == *from_memory.spectral.mid, "streamed spectral");
+  require(*from_stream.true_peak.true_peak_dbfs == *from_memory.true_peak.true_peak_dbfs, "streamed true peak");
+}
+
+}  // namespace
+
+int main() {
+  try {
+    testContainersDecodeAlike();
+    testMappedReaderTakesRf64Sizes();
+    testStreamTakesDs64SizesPast4GiB();
+    testRejectsBrokenHeaders();
+    testStreamsIntoAnalysis();
+  } catch (const std::exception& ex) {
+    std::cerr << "[FAIL] " << ex.what() << '\n';
+    return 1;
+  }
+
+  std::cout << "[PASS] test_wav_stream\n";
+  return 0;
+}
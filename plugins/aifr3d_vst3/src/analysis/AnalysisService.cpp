@@ -3,11 +3,17 @@
 #include "aifr3d/analyzer.hpp"
 #include "aifr3d/benchmark_profile.hpp"
 #include "aifr3d/compare.hpp"
+#include "aifr3d/io/wav_reader.hpp"
 #include "aifr3d/issues.hpp"
 #include "aifr3d/reference_compare.hpp"
 #include "aifr3d/scoring.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
 #include <utility>
 
 namespace aifr3d::plugin {
@@ -20,6 +26,18 @@ namespace {
 
 using Clock = std::chrono::steady_clock;
 
+// Thrown from file block readers to stop an analysis that a newer request
+// superseded or that ran past the timeout.
+class AnalysisAborted : public std::runtime_error {
+ public:
+  explicit AnalysisAborted(bool timedOut)
+      : std::runtime_error(timedOut ? "analysis timed out" : "analysis canceled"), timedOut_(timedOut) {}
+  bool timedOut() const { return timedOut_; }
+
+ private:
+  bool timedOut_;
+};
+
 }  // namespace
 
 AnalysisService::AnalysisService() : juce::Thread("AIFR3DAnalysisWorker") {}
@@ -163,55 +181,47 @@ AnalysisSnapshot AnalysisService::runJob(const AnalysisJob& job) {
   }
 
   try {
-    juce::AudioBuffer<float> stereo;
-    double sampleRate = job.sampleRateHz;
+    // Captured buffers are analyzed in place; the core reads JUCE's planar
+    // channels directly.
+    const juce::AudioBuffer<float>& stereo = job.stereoBuffer;
+    if (job.sourceKind == AnalysisSourceKind::CapturedBuffer &&
+        (stereo.getNumChannels() < 2 || stereo.getNumSamples() <= 0)) {
+      out.valid = false;
+      out.errorMessage = "No valid stereo samples available for analysis.";
+      return out;
+    }
+
+    // File analyses poll this before every block read, so a newer request
+    // or the timeout stops even a multi-hour file promptly.
+    const auto checkAbort = [&] {
+      if (job.generation < latestRequestedGeneration_.load()) {
+        throw AnalysisAborted(false);
+      }
+      if (Clock::now() - start > std::chrono::milliseconds(config_.timeoutMs)) {
+        throw AnalysisAborted(true);
+      }
+    };
 
+    aifr3d::Analyzer analyzer;
+    aifr3d::AnalysisResult analysis;
     if (job.sourceKind == AnalysisSourceKind::OfflineWav) {
       juce::String err;
-      if (!loadWavToStereoBuffer(job.offlineFile, stereo, sampleRate, err)) {
+      if (!analyzeAudioFile(job.offlineFile, analyzer, checkAbort, analysis, err)) {
         out.valid = false;
         out.errorMessage = err;
         return out;
       }
     } else {
-      stereo.makeCopyOf(job.stereoBuffer);
+      analysis = analyzer.analyzePlanarStereo(stereo.getReadPointer(0), stereo.getReadPointer(1),
+                                              static_cast<std::size_t>(stereo.getNumSamples()), job.sampleRateHz,
+                                              workspace_);
     }
-
-    if (job.generation < latestRequestedGeneration_.load()) {
-      out.valid = false;
-      out.canceled = true;
-      out.errorMessage = "Analysis canceled during data prep.";
-      const std::scoped_lock perfLock(perfMutex_);
-      ++perf_.canceledJobs;
-      return out;
-    }
-
-    if (stereo.getNumChannels() < 2 || stereo.getNumSamples() <= 0) {
-      out.valid = false;
-      out.errorMessage = "No valid stereo samples available for analysis.";
-      return out;
-    }
-
-    const auto interleaved = interleaveStereo(stereo);
-    const std::size_t frameCount = static_cast<std::size_t>(stereo.getNumSamples());
-
-    const auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
-    if (nowMs > config_.timeoutMs) {
-      out.valid = false;
-      out.timedOut = true;
-      out.errorMessage = "Analysis timed out before core analysis.";
-      const std::scoped_lock perfLock(perfMutex_);
-      ++perf_.timedOutJobs;
-      return out;
-    }
-
-    aifr3d::Analyzer analyzer;
-    auto analysis = analyzer.analyzeInterleavedStereo(interleaved.data(), frameCount, sampleRate);
     analysis.generated_at_utc = out.completedAt.toISO8601(true).toStdString();
 
     out.analysis = analysis;
-    out.sampleRateHz = sampleRate;
-    out.durationSeconds = sampleRate > 0.0 ? static_cast<double>(stereo.getNumSamples()) / sampleRate : 0.0;
+    out.sampleRateHz = analysis.sample_rate_hz;
+    out.durationSeconds =
+        analysis.sample_rate_hz > 0.0 ? static_cast<double>(analysis.frame_count) / analysis.sample_rate_hz : 0.0;
 
     std::optional<aifr3d::BenchmarkProfile> benchmarkProfile;
     if (job.benchmarkProfilePath.isNotEmpty()) {
@@ -230,14 +240,8 @@ AnalysisSnapshot AnalysisService::runJob(const AnalysisJob& job) {
 
     if (job.referenceWavPath.isNotEmpty()) {
       juce::String refErr;
-      juce::AudioBuffer<float> refBuf;
-      double refRate = 0.0;
-      if (loadWavToStereoBuffer(juce::File(job.referenceWavPath), refBuf, refRate, refErr) &&
-          refBuf.getNumSamples() > 0 && refRate > 0.0) {
-        const auto refInterleaved = interleaveStereo(refBuf);
-        auto refAnalysis = analyzer.analyzeInterleavedStereo(refInterleaved.data(),
-                                                             static_cast<std::size_t>(refBuf.getNumSamples()),
-                                                             refRate);
+      aifr3d::AnalysisResult refAnalysis;
+      if (analyzeAudioFile(juce::File(job.referenceWavPath), analyzer, checkAbort, refAnalysis, refErr)) {
         refAnalysis.schema_version = analysis.schema_version;
         std::vector<aifr3d::AnalysisResult> refs{refAnalysis};
         out.referenceCompare = aifr3d::compareToReferences(analysis, refs);
@@ -260,6 +264,21 @@ AnalysisSnapshot AnalysisService::runJob(const AnalysisJob& job) {
     out.issues = aifr3d::generateIssues(analysis, benchPtr, refPtr);
 
     out.valid = true;
+  } catch (const AnalysisAborted& aborted) {
+    out.valid = false;
+    out.processingMs =
+        static_cast<double>(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count());
+    const std::scoped_lock perfLock(perfMutex_);
+    if (aborted.timedOut()) {
+      out.timedOut = true;
+      out.errorMessage = "Analysis timed out.";
+      ++perf_.timedOutJobs;
+    } else {
+      out.canceled = true;
+      out.errorMessage = "Analysis canceled by newer request.";
+      ++perf_.canceledJobs;
+    }
+    return out;
   } catch (const std::exception& e) {
     out.valid = false;
     out.errorMessage = e.what();
@@ -296,15 +315,37 @@ AnalysisSnapshot AnalysisService::runJob(const AnalysisJob& job) {
   return out;
 }
 
-bool AnalysisService::loadWavToStereoBuffer(const juce::File& file,
-                                            juce::AudioBuffer<float>& out,
-                                            double& sampleRateHz,
-                                            juce::String& err) const {
+bool AnalysisService::analyzeAudioFile(const juce::File& file,
+                                       const aifr3d::Analyzer& analyzer,
+                                       const std::function<void()>& checkAbort,
+                                       aifr3d::AnalysisResult& out,
+                                       juce::String& err) {
   if (!file.existsAsFile()) {
     err = "File does not exist: " + file.getFullPathName();
     return false;
   }
 
+  // WAV, RF64 and BW64 decode block by block straight from a memory mapping,
+  // so even multi-hour files never need a full-length buffer.
+  if (file.hasFileExtension("wav;wave;rf64;bw64")) {
+    try {
+      const aifr3d::io::WavReader wav(file.getFullPathName().toStdString());
+      if (wav.frameCount() == 0) {
+        err = "Audio file is empty: " + file.getFullPathName();
+        return false;
+      }
+      out = analyzer.analyzeBlocks(
+          [&](std::size_t first, std::size_t frames, float* left, float* right) {
+            checkAbort();
+            wav.readStereo(first, frames, left, right);
+          },
+          wav.frameCount(), wav.sampleRateHz(), workspace_);
+      return true;
+    } catch (const std::invalid_argument&) {
+      // Not a layout the core reader handles (8-bit, ADPCM, ...): let JUCE try.
+    }
+  }
+
   juce::AudioFormatManager fm;
   fm.registerBasicFormats();
   std::unique_ptr<juce::AudioFormatReader> reader(fm.createReaderFor(file));
@@ -312,36 +353,34 @@ bool AnalysisService::loadWavToStereoBuffer(const juce::File& file,
     err = "Unsupported audio file format: " + file.getFullPathName();
     return false;
   }
-
-  const int numSamples = static_cast<int>(reader->lengthInSamples);
-  if (numSamples <= 0) {
+  if (reader->lengthInSamples <= 0 || reader->numChannels == 0) {
     err = "Audio file is empty: " + file.getFullPathName();
     return false;
   }
 
-  juce::AudioBuffer<float> temp(static_cast<int>(juce::jmax(2u, reader->numChannels)), numSamples);
-  if (!reader->read(&temp, 0, numSamples, 0, true, true)) {
+  // JUCE readers are not thread-safe; blocks are small, so serialising the
+  // reads costs little next to the analysis.
+  std::mutex readMutex;
+  bool readFailed = false;
+  const bool mono = reader->numChannels == 1;
+  out = analyzer.analyzeBlocks(
+      [&](std::size_t first, std::size_t frames, float* left, float* right) {
+        checkAbort();
+        float* channels[2] = {left, right};
+        const std::scoped_lock lock(readMutex);
+        if (!reader->read(channels, mono ? 1 : 2, static_cast<juce::int64>(first), static_cast<int>(frames))) {
+          readFailed = true;
+        }
+        if (mono) {
+          std::copy(left, left + frames, right);
+        }
+      },
+      static_cast<std::size_t>(reader->lengthInSamples), reader->sampleRate, workspace_);
+  if (readFailed) {
     err = "Failed to read audio data: " + file.getFullPathName();
     return false;
   }
-
-  out.setSize(2, numSamples, false, false, true);
-  out.copyFrom(0, 0, temp, 0, 0, numSamples);
-  out.copyFrom(1, 0, temp, temp.getNumChannels() > 1 ? 1 : 0, 0, numSamples);
-  sampleRateHz = reader->sampleRate;
   return true;
 }
 
-std::vector<float> AnalysisService::interleaveStereo(const juce::AudioBuffer<float>& buf) {
-  const int n = buf.getNumSamples();
-  std::vector<float> out(static_cast<std::size_t>(n) * 2U, 0.0f);
-  const float* l = buf.getReadPointer(0);
-  const float* r = buf.getReadPointer(buf.getNumChannels() > 1 ? 1 : 0);
-  for (int i = 0; i < n; ++i) {
-    out[static_cast<std::size_t>(i) * 2U] = l[i];
-    out[static_cast<std::size_t>(i) * 2U + 1U] = r[i];
-  }
-  return out;
-}
-
 }  // namespace aifr3d::plugin
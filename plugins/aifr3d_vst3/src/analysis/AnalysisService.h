@@ -3,12 +3,15 @@
 #include "AnalysisJob.h"
 #include "AnalysisTypes.h"
 
+#include "aifr3d/analyzer.hpp"
+
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
 #include <juce_gui_extra/juce_gui_extra.h>
 
 #include <atomic>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -47,12 +50,14 @@ class AnalysisService final : private juce::Thread {
   void run() override;
 
   AnalysisSnapshot runJob(const AnalysisJob& job);
-  bool loadWavToStereoBuffer(const juce::File& file,
-                             juce::AudioBuffer<float>& out,
-                             double& sampleRateHz,
-                             juce::String& err) const;
-
-  static std::vector<float> interleaveStereo(const juce::AudioBuffer<float>& buf);
+  // Streams `file` through the analyzer in blocks; never holds the whole
+  // decoded file. `checkAbort` runs before every block read and may throw to
+  // stop the analysis. Returns false with `err` set when it cannot be read.
+  bool analyzeAudioFile(const juce::File& file,
+                        const aifr3d::Analyzer& analyzer,
+                        const std::function<void()>& checkAbort,
+                        aifr3d::AnalysisResult& out,
+                        juce::String& err);
 
   Config config_;
   mutable std::mutex jobMutex_;
@@ -65,6 +70,9 @@ class AnalysisService final : private juce::Thread {
   mutable std::mutex perfMutex_;
   AnalysisPerfCounters perf_;
 
+  // Only touched from the worker thread; keeps core scratch warm across jobs.
+  aifr3d::AnalyzerWorkspace workspace_;
+
   std::shared_ptr<AnalysisSnapshot> latestSnapshot_;
   mutable std::mutex latestMutex_;
 };
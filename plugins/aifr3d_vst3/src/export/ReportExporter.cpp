@@ -64,6 +64,8 @@ juce::var makeAnalysisJson(const AnalysisSnapshot& s) {
   dynamics->setProperty("rms_dbfs", ReportExporter::optionalNumber(s.analysis.dynamics.rms_dbfs));
   dynamics->setProperty("crest_db", ReportExporter::optionalNumber(s.analysis.dynamics.crest_db));
   dynamics->setProperty("dr_proxy_db", ReportExporter::optionalNumber(s.analysis.dynamics.dr_proxy_db));
+  dynamics->setProperty("dr_db", ReportExporter::optionalNumber(s.analysis.dynamics.dr_db));
+  dynamics->setProperty("plr_db", ReportExporter::optionalNumber(s.analysis.dynamics.plr_db));
   rootObj->setProperty("dynamics", juce::var(dynamics));
 
   return juce::var(rootObj);